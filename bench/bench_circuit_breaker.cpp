@@ -0,0 +1,77 @@
+// Contention benchmark for CircuitBreaker: every upstream call does a
+// checkAllowed and a recordSuccess/recordFailure, so the breaker sits on
+// the hot path of every worker. The lock-free breaker is compared with
+// the simplest correct alternative, the old consecutive-failure map
+// behind one mutex.
+#include "circuit_breaker.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr int opsPerThread = 200000;
+const std::string services[] = {"weather", "gemini", "amadeus"};
+
+// The previous breaker's bookkeeping, made safe with a global lock.
+class LockedBreaker {
+public:
+    int checkAllowed(const std::string& service) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (states_[service].open) throw std::runtime_error("open");
+        return 0;
+    }
+    void recordSuccess(const std::string& service, int, std::chrono::steady_clock::duration) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& state = states_[service];
+        state.consecutiveFailures = 0;
+        state.open = false;
+    }
+
+private:
+    struct State {
+        int consecutiveFailures = 0;
+        bool open = false;
+    };
+    std::mutex mutex_;
+    std::unordered_map<std::string, State> states_;
+};
+
+template <typename Breaker>
+double run(Breaker& breaker, int threads) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < opsPerThread; ++i) {
+                const std::string& service = services[(i + t) % 3];
+                auto ticket = breaker.checkAllowed(service);
+                breaker.recordSuccess(service, ticket, std::chrono::milliseconds(40));
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (static_cast<double>(opsPerThread) * threads) / seconds;
+}
+
+} // namespace
+
+int main() {
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%-8s %18s %18s\n", "threads", "mutex calls/sec", "lock-free calls/sec");
+    for (int threads : {1, 2, 4, 8, static_cast<int>(hw) * 2}) {
+        LockedBreaker locked;
+        CircuitBreaker lockFree;
+        for (const auto& service : services) lockFree.configure(service, {});
+        double lockedRate = run(locked, threads);
+        double lockFreeRate = run(lockFree, threads);
+        std::printf("%-8d %18.0f %18.0f\n", threads, lockedRate, lockFreeRate);
+    }
+    return 0;
+}
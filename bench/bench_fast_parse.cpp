@@ -0,0 +1,74 @@
+// FastParse against the stream/stod code it replaced, on the inputs the
+// hot paths actually see: Amadeus segment timestamps, travel dates and
+// price strings.
+#include "fast_parse.hpp"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int rounds = 200000;
+
+template <typename Parse>
+double nsPerCall(const std::vector<std::string>& inputs, Parse parse) {
+    long sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) sink += parse(inputs[i % inputs.size()]);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 42) std::puts(""); // keep the loop observable
+    return ns / rounds;
+}
+
+void report(const char* what, double before, double after) {
+    std::printf("%-10s %12.1f %12.1f %8.1fx\n", what, before, after, before / after);
+}
+
+} // namespace
+
+int main() {
+    std::vector<std::string> stamps, dates, prices;
+    for (int i = 0; i < 64; ++i) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "2026-%02d-%02dT%02d:%02d:00", i % 12 + 1, i % 28 + 1, i % 24, i % 60);
+        stamps.push_back(buf);
+        dates.push_back(std::string(buf, 10));
+        prices.push_back(std::to_string(1500 + i * 37) + ".50");
+    }
+
+    std::printf("%-10s %12s %12s %9s\n", "input", "old ns/call", "new ns/call", "speedup");
+    report("datetime",
+           nsPerCall(stamps, [](const std::string& s) {
+               std::tm t = {};
+               std::istringstream(s) >> std::get_time(&t, "%Y-%m-%dT%H:%M:%S");
+               return t.tm_min;
+           }),
+           nsPerCall(stamps, [](const std::string& s) {
+               std::tm t = {};
+               FastParse::parseDateTime(s, t);
+               return t.tm_min;
+           }));
+    report("date",
+           nsPerCall(dates, [](const std::string& s) {
+               std::tm t = {};
+               std::istringstream(s) >> std::get_time(&t, "%Y-%m-%d");
+               return t.tm_mday;
+           }),
+           nsPerCall(dates, [](const std::string& s) {
+               std::tm t = {};
+               FastParse::parseDate(s, t);
+               return t.tm_mday;
+           }));
+    report("price",
+           nsPerCall(prices, [](const std::string& s) { return static_cast<long>(std::stod(s)); }),
+           nsPerCall(prices, [](const std::string& s) {
+               double price = 0;
+               FastParse::parseDouble(s, price);
+               return static_cast<long>(price);
+           }));
+    return 0;
+}
@@ -0,0 +1,168 @@
+// Amadeus flight-offer parsing: the SAX parser in FlightParser against the
+// previous DOM approach (parse everything, copy `data`, sort the JSON
+// objects with a stod per comparison), on a synthetic payload shaped like a
+// real response - per-offer travelerPricings and a large dictionaries block
+// that the parser never needs. Heap allocations are counted by replacing
+// the global operator new.
+#include "flight_parser.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using json = nlohmann::json;
+
+std::string syntheticResponse(int offerCount, int travelers) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> price(2500, 25000);
+    const char* carriers[] = {"AI", "6E", "UK", "SG", "QP"};
+    const char* airports[] = {"DEL", "BOM", "BLR", "GOI", "MAA", "HYD", "CCU"};
+
+    json data = json::array();
+    for (int i = 0; i < offerCount; ++i) {
+        json segments = json::array();
+        int legs = 1 + i % 2;
+        for (int s = 0; s < legs; ++s) {
+            segments.push_back({
+                {"departure", {{"iataCode", airports[(i + s) % 7]}, {"terminal", "3"}, {"at", "2026-09-10T06:25:00"}}},
+                {"arrival", {{"iataCode", airports[(i + s + 1) % 7]}, {"terminal", "1"}, {"at", "2026-09-10T09:25:00"}}},
+                {"carrierCode", carriers[i % 5]},
+                {"number", std::to_string(100 + i)},
+                {"aircraft", {{"code", "32N"}}},
+                {"operating", {{"carrierCode", carriers[i % 5]}}},
+                {"duration", "PT3H"},
+                {"id", std::to_string(i * 10 + s)},
+                {"numberOfStops", 0},
+                {"blacklistedInEU", false},
+            });
+        }
+        json pricings = json::array();
+        for (int t = 1; t <= travelers; ++t) {
+            json fareDetails = json::array();
+            for (int s = 0; s < legs; ++s) {
+                fareDetails.push_back({{"segmentId", std::to_string(i * 10 + s)},
+                                       {"cabin", "ECONOMY"},
+                                       {"fareBasis", "TIP"},
+                                       {"class", "T"},
+                                       {"includedCheckedBags", {{"weight", 15}, {"weightUnit", "KG"}}}});
+            }
+            pricings.push_back({{"travelerId", std::to_string(t)},
+                                {"fareOption", "STANDARD"},
+                                {"travelerType", "ADULT"},
+                                {"price", {{"currency", "INR"}, {"total", "4200.00"}, {"base", "3500.00"}}},
+                                {"fareDetailsBySegment", fareDetails}});
+        }
+        std::string total = std::to_string(price(rng)) + ".00";
+        data.push_back({
+            {"type", "flight-offer"},
+            {"id", std::to_string(i + 1)},
+            {"source", "GDS"},
+            {"instantTicketingRequired", false},
+            {"lastTicketingDate", "2026-09-01"},
+            {"numberOfBookableSeats", 1 + i % 9},
+            {"itineraries", {{{"duration", "PT3H"}, {"segments", segments}}}},
+            {"price", {{"currency", "INR"}, {"total", total}, {"base", total}, {"grandTotal", total},
+                       {"fees", {{{"amount", "0.00"}, {"type", "SUPPLIER"}}, {{"amount", "0.00"}, {"type", "TICKETING"}}}}}},
+            {"pricingOptions", {{"fareType", {"PUBLISHED"}}, {"includedCheckedBagsOnly", true}}},
+            {"validatingAirlineCodes", {carriers[i % 5]}},
+            {"travelerPricings", pricings},
+        });
+    }
+
+    json locations = json::object();
+    for (int i = 0; i < 200; ++i) {
+        locations["X" + std::to_string(i)] = {{"cityCode", "XXX"}, {"countryCode", "IN"}};
+    }
+    json response = {
+        {"meta", {{"count", offerCount}, {"links", {{"self", "https://test.api.amadeus.com/v2/shopping/flight-offers"}}}}},
+        {"data", data},
+        {"dictionaries", {{"locations", locations},
+                          {"aircraft", {{"32N", "AIRBUS A320NEO"}, {"321", "AIRBUS A321"}}},
+                          {"currencies", {{"INR", "INDIAN RUPEE"}}},
+                          {"carriers", {{"AI", "AIR INDIA"}, {"6E", "INDIGO"}, {"UK", "VISTARA"}}}}},
+    };
+    return response.dump();
+}
+
+// The pre-SAX implementation, kept here as the baseline.
+std::vector<Flight> parseWithDom(const std::string& response, const std::string& currency) {
+    std::vector<Flight> flights;
+    json responseJson = json::parse(response);
+    auto offers = responseJson["data"];
+    std::sort(offers.begin(), offers.end(), [](const json& a, const json& b) {
+        return std::stod(a["price"]["total"].get<std::string>()) <
+               std::stod(b["price"]["total"].get<std::string>());
+    });
+    size_t numOffers = std::min(size_t(10), offers.size());
+    for (size_t i = 0; i < numOffers; ++i) {
+        const auto& offer = offers[i];
+        for (const auto& segment : offer.at("itineraries").at(0).at("segments")) {
+            tm departure = {}, arrival = {};
+            std::istringstream(segment.at("departure").at("at").get<std::string>()) >>
+                std::get_time(&departure, "%Y-%m-%dT%H:%M:%S");
+            std::istringstream(segment.at("arrival").at("at").get<std::string>()) >>
+                std::get_time(&arrival, "%Y-%m-%dT%H:%M:%S");
+            flights.emplace_back(segment.at("carrierCode").get<std::string>(),
+                                 segment.at("number").get<std::string>(),
+                                 segment.at("departure").at("iataCode").get<std::string>(),
+                                 segment.at("arrival").at("iataCode").get<std::string>(), departure, arrival,
+                                 std::stod(offer.at("price").at("total").get<std::string>()),
+                                 offer.value("numberOfBookableSeats", 1), currency);
+        }
+    }
+    return flights;
+}
+
+template <typename Parse>
+void measure(const char* label, const std::string& payload, Parse parse) {
+    constexpr int rounds = 50;
+    size_t flights = parse(payload).size(); // warm-up
+    uint64_t before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) flights = parse(payload).size();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double allocs = static_cast<double>(allocations.load() - before) / rounds;
+    std::printf("%-6s %10.3f %14.0f %10zu\n", label, ms / rounds, allocs, flights);
+}
+
+} // namespace
+
+int main() {
+    for (int offers : {50, 250}) {
+        std::string payload = syntheticResponse(offers, 2);
+        std::printf("\n%d offers, %zu KiB payload\n", offers, payload.size() / 1024);
+        std::printf("%-6s %10s %14s %10s\n", "parser", "ms/parse", "allocs/parse", "flights");
+        measure("dom", payload, [](const std::string& p) { return parseWithDom(p, "INR"); });
+        measure("sax", payload,
+                [](const std::string& p) { return FlightParser::parseAmadeusFlightOffers(p, "INR"); });
+        measure("sax50", payload,
+                [](const std::string& p) { return FlightParser::parseAmadeusFlightOffers(p, "INR", 50); });
+        measure("saxall", payload,
+                [](const std::string& p) { return FlightParser::parseAmadeusFlightOffers(p, "INR", SIZE_MAX); });
+    }
+    return 0;
+}
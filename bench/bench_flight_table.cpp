@@ -0,0 +1,80 @@
+// Result-set passes over vector<Flight> versus FlightTable: a stable sort
+// by price, a seats filter, and a read of every field the /flights
+// response serializes.
+#include "flight_table.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int rounds = 50;
+
+const char* carriers[] = {"AI", "6E", "UK", "SG", "QP"};
+const char* airports[] = {"DEL", "BOM", "BLR", "GOI", "MAA", "CCU", "HYD", "COK"};
+
+FlightTable makeTable(size_t rows) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> price(2000, 20000), seats(1, 9), pick(0, 7);
+    FlightTable table;
+    table.reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        int64_t departs = 1788000000 + static_cast<int64_t>(i) * 600;
+        table.add(carriers[i % 5], std::to_string(100 + i % 9000), airports[pick(rng)], airports[pick(rng)],
+                  departs, departs + 7200, static_cast<int64_t>(price(rng)) * 100, seats(rng));
+    }
+    return table;
+}
+
+// Stand-in for the serializer: touches every output field.
+template <typename Row>
+size_t readFields(const Row& f) {
+    return f.getAirline().size() + f.getFlightNumber().size() + f.getDepartureAirport().size() +
+           f.getArrivalAirport().size() + static_cast<size_t>(f.getPrice()) + f.getCurrency().size() +
+           static_cast<size_t>(f.getAvailableSeats()) + f.getSource().size();
+}
+
+template <typename Pass>
+double msPerRound(Pass pass) {
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) sink += pass();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 42) std::puts("");
+    return ms / rounds;
+}
+
+} // namespace
+
+int main() {
+    std::printf("%8s %14s %14s\n", "rows", "vector<Flight>", "FlightTable");
+    for (size_t rows : {250, 10000, 100000}) {
+        FlightTable table = makeTable(rows);
+        std::vector<Flight> flights = table.toFlights();
+
+        double objects = msPerRound([&] {
+            std::vector<Flight> copy = flights;
+            std::stable_sort(copy.begin(), copy.end(),
+                             [](const Flight& a, const Flight& b) { return a.getPrice() < b.getPrice(); });
+            copy.erase(std::remove_if(copy.begin(), copy.end(),
+                                      [](const Flight& f) { return f.getAvailableSeats() < 2; }),
+                       copy.end());
+            size_t bytes = 0;
+            for (const Flight& f : copy) bytes += readFields(f);
+            return bytes;
+        });
+        double columns = msPerRound([&] {
+            FlightTable copy = table;
+            copy.sortByPrice();
+            copy.retainIf([](FlightTable::Row f) { return f.getAvailableSeats() >= 2; });
+            size_t bytes = 0;
+            for (FlightTable::Row f : copy) bytes += readFields(f);
+            return bytes;
+        });
+        std::printf("%8zu %11.3f ms %11.3f ms\n", rows, objects, columns);
+    }
+    return 0;
+}
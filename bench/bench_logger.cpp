@@ -0,0 +1,39 @@
+// Cost of a log line that nobody wants. With the threshold at WARN, an
+// INFO line built eagerly (string concatenation before the call, the old
+// call-site style) is compared with the same line through LOG_INFO, which
+// checks the level before formatting anything.
+#include "logger.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+constexpr int iterations = 5000000;
+
+template <typename Fn>
+double nsPerCall(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn(i);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+} // namespace
+
+int main() {
+    Logger::setLevel(Logger::Level::Warn);
+    std::string city = "new delhi";
+
+    double eager = nsPerCall([&](int i) {
+        Logger::info("IATA cache hit for " + city + " (lookup " + std::to_string(i) + ")");
+    });
+    double lazy = nsPerCall([&](int i) { LOG_INFO("IATA cache hit for ", city, " (lookup ", i, ")"); });
+    double debug = nsPerCall([&](int i) { LOG_DEBUG("IATA cache hit for ", city, " (lookup ", i, ")"); });
+
+    std::printf("%-34s %10s\n", "suppressed INFO line", "ns/call");
+    std::printf("%-34s %10.2f\n", "Logger::info(eager concat)", eager);
+    std::printf("%-34s %10.2f\n", "LOG_INFO (lazy)", lazy);
+    std::printf("%-34s %10.2f\n", "LOG_DEBUG (lazy)", debug);
+    return 0;
+}
@@ -0,0 +1,163 @@
+// Heap allocations per request-shaped unit of work, with results built on
+// the default resource versus in a per-request monotonic arena (what the
+// server's completeAsync hands each route). "before" is the previous
+// itinerary path: a DOM for the Gemini envelope and string temporaries for
+// every item. Heap allocations are counted by replacing the global
+// operator new; allocations served from the arena's stack buffer never
+// reach it.
+#include "flight_table.hpp"
+#include "gemini_parser.hpp"
+#include "json.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// new_delete_resource, behind every default-resource pmr container, asks
+// for the aligned form.
+void* operator new(std::size_t size, std::align_val_t align) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t alignment = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+using json = nlohmann::json;
+
+std::string envelope(const std::string& text) {
+    return json{{"candidates", {{{"content", {{"parts", {{{"text", text}}}}, {"role", "model"}}},
+                                 {"finishReason", "STOP"}}}},
+                {"usageMetadata", {{"promptTokenCount", 120}, {"totalTokenCount", 900}}}}
+        .dump();
+}
+
+std::string itineraryReply(int days) {
+    json list = json::array();
+    for (int d = 0; d < days; ++d) {
+        list.push_back({{"date", "2026-09-1" + std::to_string(d % 10)},
+                        {"place", "Fort Aguada and the lighthouse above Sinquerim beach"},
+                        {"famous_for", "A 17th-century Portuguese fort with sweeping views over the Mandovi estuary."},
+                        {"how_to_go", "Taxi or scooter from Candolim, about 15 minutes along the coast road"}});
+    }
+    return envelope(json{{"itinerary", list}}.dump());
+}
+
+std::string hotelReply(int hotels) {
+    json list = json::array();
+    for (int h = 0; h < hotels; ++h) {
+        list.push_back({{"hotel_name", "Seaside Heritage Resort and Spa " + std::to_string(h)},
+                        {"star_rating", 4.5},
+                        {"total_stay_cost", 18500.0 + h},
+                        {"address", "Near Calangute Beach, Saunta Vaddo, Calangute, Goa 403516"}});
+    }
+    return envelope(list.dump());
+}
+
+// The previous generateItinerary parse, on the default heap.
+size_t itineraryBefore(const std::string& response) {
+    json responseJson = json::parse(response);
+    std::string text = responseJson["candidates"][0]["content"]["parts"][0]["text"];
+    json itineraryJson = json::parse(text);
+    std::vector<ItineraryItem> itinerary;
+    std::string hotel = "Seaside Heritage Resort and Spa";
+    itinerary.emplace_back("Check-in at " + hotel, "2026-09-10", "14:00", "Accommodation");
+    for (const auto& day : itineraryJson["itinerary"]) {
+        std::string date = day.value("date", "");
+        std::string place = day.value("place", "");
+        std::string description = day.value("famous_for", "");
+        std::string transport = day.value("how_to_go", "");
+        if (!place.empty()) itinerary.emplace_back("Visit " + place, date, "10:00", "Sightseeing");
+        if (!description.empty()) itinerary.emplace_back(description, date, "10:30", "Information");
+        if (!transport.empty()) itinerary.emplace_back("Transportation: " + transport, date, "09:30", "Transport");
+    }
+    itinerary.emplace_back("Check-out from " + hotel, "2026-09-17", "11:00", "Accommodation");
+    return itinerary.size();
+}
+
+size_t itinerary(const std::string& response, std::pmr::memory_resource* resource) {
+    return GeminiParser::parseItinerary(GeminiParser::candidateText(response), "Seaside Heritage Resort and Spa",
+                                        "2026-09-10", "2026-09-17", resource)
+        .size();
+}
+
+size_t hotels(const std::string& response, std::pmr::memory_resource* resource) {
+    return GeminiParser::parseHotels(GeminiParser::candidateText(response), "Goa", "2026-09-10", "2026-09-17",
+                                     "INR", resource)
+        .size();
+}
+
+FlightTable cachedFlights(size_t rows) {
+    FlightTable table;
+    const char* carriers[] = {"AI", "6E", "UK", "SG", "QP"};
+    for (size_t i = 0; i < rows; ++i) {
+        table.add(carriers[i % 5], std::to_string(100 + i), "DEL", i % 2 ? "BOM" : "GOI", 1788000000,
+                  1788007200, 300000 + static_cast<int64_t>(i) * 100, 4);
+    }
+    return table;
+}
+
+// Runs `work` once per simulated request, optionally inside the same kind
+// of arena the server gives each route.
+template <typename Work>
+void measure(const char* label, bool useArena, Work work) {
+    constexpr int rounds = 2000;
+    uint64_t before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (int i = 0; i < rounds; ++i) {
+        if (useArena) {
+            alignas(std::max_align_t) std::byte buffer[16 << 10];
+            std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+            sink += work(&arena);
+        } else {
+            sink += work(std::pmr::get_default_resource());
+        }
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    double allocs = static_cast<double>(allocations.load() - before) / rounds;
+    std::printf("%-28s %12.1f %10.2f %8zu\n", label, allocs, us / rounds, sink / rounds);
+}
+
+} // namespace
+
+int main() {
+    std::string itineraryResponse = itineraryReply(7);
+    std::string hotelResponse = hotelReply(5);
+    const FlightTable cached = cachedFlights(20);
+
+    std::printf("%-28s %12s %10s %8s\n", "work", "allocs/req", "us/req", "results");
+    measure("itinerary, before", false, [&](std::pmr::memory_resource*) { return itineraryBefore(itineraryResponse); });
+    measure("itinerary, heap", false, [&](std::pmr::memory_resource* r) { return itinerary(itineraryResponse, r); });
+    measure("itinerary, arena", true, [&](std::pmr::memory_resource* r) { return itinerary(itineraryResponse, r); });
+    measure("hotels, heap", false, [&](std::pmr::memory_resource* r) { return hotels(hotelResponse, r); });
+    measure("hotels, arena", true, [&](std::pmr::memory_resource* r) { return hotels(hotelResponse, r); });
+    measure("flight cache hit, heap", false,
+            [&](std::pmr::memory_resource* r) { return FlightTable(cached, r).size(); });
+    measure("flight cache hit, arena", true,
+            [&](std::pmr::memory_resource* r) { return FlightTable(cached, r).size(); });
+    return 0;
+}
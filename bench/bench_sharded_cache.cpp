@@ -0,0 +1,54 @@
+// Contention benchmark for ShardedCache: the same read-mostly workload is
+// run against a single-shard cache (one global lock, equivalent to a
+// mutex-wrapped unordered_map) and against the default sharded layout.
+#include "sharded_cache.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int opsPerThread = 200000;
+constexpr int keySpace = 4096;
+
+double run(size_t shards, int threads) {
+    ShardedCache<std::string, std::string> cache(64 << 20, decltype(cache)::noExpiry, shards);
+    for (int k = 0; k < keySpace; ++k) cache.put("city-" + std::to_string(k), "XYZ");
+
+    std::vector<std::string> keys;
+    for (int k = 0; k < keySpace; ++k) keys.push_back("city-" + std::to_string(k));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            std::uniform_int_distribution<int> pick(0, keySpace - 1);
+            for (int i = 0; i < opsPerThread; ++i) {
+                const std::string& key = keys[pick(rng)];
+                // ~95% reads, like the IATA and weather caches.
+                if (i % 20 == 0) cache.put(key, "ABC");
+                else cache.get(key);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (static_cast<double>(opsPerThread) * threads) / seconds;
+}
+
+} // namespace
+
+int main() {
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%-8s %-8s %16s\n", "threads", "shards", "ops/sec");
+    for (int threads : {1, 2, 4, 8, static_cast<int>(hw) * 2}) {
+        for (size_t shards : {size_t(1), size_t(16), size_t(64)}) {
+            std::printf("%-8d %-8zu %16.0f\n", threads, shards, run(shards, threads));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef ADMISSION_HPP
+#define ADMISSION_HPP
+
+#include <exception>
+#include <functional>
+#include <string>
+#include "bulkhead.hpp"
+#include "circuit_breaker.hpp"
+
+// Admission of one upstream call: a bulkhead slot first, then the circuit
+// breaker, asked while the slot is held. The other way round, a half-open
+// circuit could hand its single probe to a caller that then timed out in
+// the bulkhead queue, and the circuit would wait out another cooldown for
+// a probe that never ran.
+struct Admission {
+    Bulkhead::Permit permit;
+    CircuitBreaker::Ticket ticket;
+};
+
+// Blocks for a slot; throws ServiceUnavailable if the bulkhead or the
+// circuit refuses, with the slot already given back.
+Admission admit(const std::string& service, Bulkhead& bulkhead = Bulkhead::instance(),
+                CircuitBreaker& breaker = CircuitBreaker::instance());
+
+// Hands `done` an Admission or a ServiceUnavailable error, under the same
+// rules as Bulkhead::acquireAsync: `done` must not throw, and may run on
+// another caller's thread.
+void admitAsync(const std::string& service, std::function<void(std::exception_ptr error, Admission admission)> done,
+                Bulkhead& bulkhead = Bulkhead::instance(), CircuitBreaker& breaker = CircuitBreaker::instance());
+
+#endif // ADMISSION_HPP
@@ -0,0 +1,26 @@
+#ifndef AIRPORT_TABLE_HPP
+#define AIRPORT_TABLE_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Compiled-in city -> IATA airport table. Resolving a city used to cost a
+// Gemini round-trip (hundreds of milliseconds to seconds) on the critical
+// path of every Amadeus search; common cities are now answered locally and
+// the LLM is only asked about names that are not in the table.
+namespace AirportTable {
+
+// Main airport for `city`. Matching ignores case, surrounding whitespace,
+// repeated spaces and a trailing ", Country" qualifier, and knows common
+// alternative names (Bombay, Bengaluru, Saigon, ...). A known 3-letter
+// airport code is accepted as-is. Returns nullopt for anything else.
+std::optional<std::string> lookup(std::string_view city);
+
+// Number of city names (including aliases) in the table.
+size_t size();
+
+} // namespace AirportTable
+
+#endif // AIRPORT_TABLE_HPP
@@ -1,16 +1,22 @@
 #ifndef API_HANDLER_HPP
 #define API_HANDLER_HPP
 
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <vector>
 #include "hotel.hpp"
-#include "flight.hpp"
+#include "flight_table.hpp"
 #include "itinerary_item.hpp"
 #include "json.hpp"
 
 using namespace std;
 
 class FlightProvider;
+struct RetryMetrics;
 
 class APIHandler {
 public:
@@ -25,6 +31,11 @@ public:
     static string WEATHER_API_URL;
     static string CURRENCY_CODE;    // e.g. "INR", "USD", "EUR"
     static string FLIGHT_PROVIDER;  // "amadeus", "gemini", "mock" or "auto"
+    static int FLIGHT_CACHE_TTL_SECONDS;    // flight results served as fresh
+    static int FLIGHT_CACHE_STALE_SECONDS;  // then served stale while refreshing
+    static int SLOW_CALL_THRESHOLD_MS;      // upstream calls slower than this are logged
+    static int AMADEUS_MAX_OFFERS;          // offers requested from Amadeus (1-250)
+    static int FLIGHT_RESULT_LIMIT;         // cheapest offers kept per search
 
     // Initialize API keys from environment variables (falls back to
     // config/api_keys.json if the env vars are not set).
@@ -33,29 +44,83 @@ public:
     // Public member functions
     static void getWeather(const string& city, int days);
     static nlohmann::json getWeatherJson(const string& city, int days);
-    static vector<Flight> searchFlights(const string& from, const string& to,
-                                      const string& date, int passengers);
-    static vector<Hotel> searchHotels(const string& city, const string& checkIn,
-                                    const string& checkOut, int guests);
-    static vector<ItineraryItem> generateItinerary(const string& destination,
-                                                 const string& startDate,
-                                                 const string& endDate,
-                                                 int peopleCount,
-                                                 double budget,
-                                                 const Hotel& selectedHotel);
+    // Blocking calls for the CLI: retries sleep on the calling thread.
+    // Results are built in `resource` (the server passes a per-request
+    // arena); anything cached is kept in the default resource and copied.
+    static FlightTable searchFlights(const string& from, const string& to,
+                                     const string& date, int passengers,
+                                     std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    static std::pmr::vector<Hotel> searchHotels(const string& city, const string& checkIn,
+                                                const string& checkOut, int guests,
+                                                std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    static std::pmr::vector<ItineraryItem> generateItinerary(const string& destination,
+                                                             const string& startDate,
+                                                             const string& endDate,
+                                                             int peopleCount,
+                                                             double budget,
+                                                             const Hotel& selectedHotel,
+                                                             std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Non-blocking variants for the server. `done` is called exactly once,
+    // from whichever thread finishes the work (the HTTP engine's, the
+    // timer's or the background executor's). A 503 is retried as in the
+    // blocking calls, but the backoff waits on the shared TimerQueue rather
+    // than on a thread. `resource` must outlive the call.
+    static void getWeatherJsonAsync(const string& city, int days,
+                                    function<void(exception_ptr, nlohmann::json)> done);
+    static void searchFlightsAsync(const string& from, const string& to, const string& date, int passengers,
+                                   std::pmr::memory_resource* resource,
+                                   function<void(exception_ptr, FlightTable)> done);
+    static void searchHotelsAsync(const string& city, const string& checkIn, const string& checkOut, int guests,
+                                  std::pmr::memory_resource* resource,
+                                  function<void(exception_ptr, std::pmr::vector<Hotel>)> done);
+    static void generateItineraryAsync(const string& destination, const string& startDate, const string& endDate,
+                                       const Hotel& selectedHotel,
+                                       std::pmr::memory_resource* resource,
+                                       function<void(exception_ptr, std::pmr::vector<ItineraryItem>)> done);
 
     // Identity of the configured flight backend, for surfacing to callers.
     static string activeFlightProviderName();
     static bool flightResultsAreBookable();
 
-    // Clears the in-memory IATA-code / weather caches (mainly for tests).
+    // Non-blocking twin of the internal HTTP helper: the request runs on the
+    // shared curl-multi event loop (see HttpEngine) and the future resolves
+    // with the body, or with the same errors the blocking path throws.
+    static future<string> httpRequestAsync(const string& url, const string& method = "GET",
+                                           const string& data = "", const string& token = "");
+    // Callback form. `done` runs on the background executor, under the
+    // caller's request cost and trace, so it may parse the body itself.
+    static void httpRequestAsync(const string& url, const string& method, const string& data,
+                                 const string& token, function<void(exception_ptr, string)> done);
+
+    // Clears the in-memory IATA-code / weather / flight caches (mainly for tests).
     static void clearCaches();
 
+    // Where background work (e.g. refreshing stale cached flights) runs.
+    // Defaults to a detached thread per task; the server points it at its
+    // upstream pool.
+    static void setBackgroundExecutor(function<void(function<void()>)> executor);
+
 private:
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
     static string makeHttpRequest(const string& url, const string& method = "GET",
                                 const string& data = "", const string& token = "");
     static string getIATACode(const string& city);
+    static void getIATACodeAsync(const string& city, function<void(exception_ptr, string)> done);
+    static string fetchIATACode(const string& city);
+    static nlohmann::json fetchWeatherJson(const string& city, int days);
+    static void fetchWeatherJsonAsync(const string& city, int days,
+                                      function<void(exception_ptr, nlohmann::json)> done);
+    static string forecastUrl(const string& city, int days);
+    static FlightTable fetchFlights(const string& from, const string& to,
+                                    const string& date, int passengers);
+    static void fetchFlightsAsync(const string& from, const string& to, const string& date, int passengers,
+                                  function<void(exception_ptr, shared_ptr<const FlightTable>)> done);
+    static void refreshFlightsInBackground(const string& key, const string& from, const string& to,
+                                           const string& date, int passengers);
+    template <typename T>
+    static void geminiRequestAsync(const char* errorPrefix, RetryMetrics& metrics, const string& body,
+                                   function<T(const string&)> parse, function<void(exception_ptr, T)> done);
+    static void runInBackground(function<void()> task);
     static string urlEncode(const string& str);
 
     // Lazily constructed from the current configuration, then reused.
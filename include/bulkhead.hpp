@@ -0,0 +1,99 @@
+#ifndef BULKHEAD_HPP
+#define BULKHEAD_HPP
+
+#include <chrono>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "metrics.hpp"
+#include "timer_queue.hpp"
+
+// Per-service concurrency limits. Each upstream gets at most
+// `maxConcurrent` calls in flight; further callers queue, first come first
+// served, for up to `maxQueueWait` and are then refused with
+// ServiceUnavailable (a 503 to the client). A slow upstream therefore
+// backs up only its own queue instead of every worker the others need.
+//
+// acquireAsync queues without holding a thread: its callback runs at once
+// if a slot is free, otherwise on the thread that frees one or, on
+// timeout, on the TimerQueue thread. acquire() is the blocking form.
+class Bulkhead {
+public:
+    struct Config {
+        size_t maxConcurrent = 16;
+        std::chrono::milliseconds maxQueueWait{250};
+    };
+
+    // One slot. Copies share it (so a permit can ride along in copyable
+    // callbacks); it is freed by the first release() on any copy, or when
+    // the last copy goes.
+    class Permit {
+    public:
+        Permit() = default;
+        explicit operator bool() const;
+        void release();
+
+    private:
+        friend class Bulkhead;
+        struct Slot;
+        std::shared_ptr<Slot> slot_;
+    };
+    using Callback = std::function<void(std::exception_ptr error, Permit permit)>;
+
+    static Bulkhead& instance();
+
+    explicit Bulkhead(TimerQueue& timers = TimerQueue::instance());
+    Bulkhead(const Bulkhead&) = delete;
+    Bulkhead& operator=(const Bulkhead&) = delete;
+
+    // Sets `service`'s limits; normally done at startup. Services first seen
+    // in acquire get the default Config.
+    void configure(const std::string& service, const Config& config);
+
+    // Blocks up to maxQueueWait for a slot; throws ServiceUnavailable.
+    Permit acquire(const std::string& service);
+    // Hands `done` a permit, or a ServiceUnavailable error. `done` must not
+    // throw and should only start work, since it may run on another
+    // caller's thread.
+    void acquireAsync(const std::string& service, Callback done);
+
+    size_t active(const std::string& service);
+    size_t queued(const std::string& service);
+
+private:
+    struct Waiter {
+        Callback done;
+        bool settled = false;
+    };
+    struct State {
+        State(const std::string& service, const Config& config);
+
+        const std::string service;
+        std::mutex mutex;
+        Config config;
+        size_t active = 0;
+        std::deque<std::shared_ptr<Waiter>> queue;
+        // Exported as travelplanner_bulkhead_* {service=...}.
+        Counter* rejections = nullptr;
+        Gauge* activeGauge = nullptr;
+        Gauge* queuedGauge = nullptr;
+    };
+
+    std::shared_ptr<State> stateFor(const std::string& service);
+    static Permit grant(const std::shared_ptr<State>& state);
+    static void release(const std::shared_ptr<State>& state);
+    static std::exception_ptr rejection(const State& state);
+
+    TimerQueue& timers_;
+    std::mutex mutex_;
+    // Shared with permits and pending timeouts, which may outlive us.
+    std::unordered_map<std::string, std::shared_ptr<State>> services_;
+};
+
+#endif // BULKHEAD_HPP
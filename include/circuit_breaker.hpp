@@ -1,34 +1,110 @@
 #ifndef CIRCUIT_BREAKER_HPP
 #define CIRCUIT_BREAKER_HPP
 
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include "metrics.hpp"
 
-// Per-service circuit breaker: after `failureThreshold` consecutive
-// failures, the circuit opens and rejects calls immediately (without
-// hitting the network) for `cooldown`, giving a struggling upstream API
-// time to recover instead of being hammered by retries.
+// Per-service circuit breaker. Each service keeps a sliding window of its
+// most recent call outcomes - the last `windowSize` calls, ignoring any
+// older than `windowDuration`. Once the window holds `minimumCalls`, the
+// circuit opens when the share of failures reaches `failureRateThreshold`
+// or the share of calls slower than `slowCallDuration` reaches
+// `slowCallRateThreshold`. An open circuit rejects calls immediately
+// (without hitting the network) for `cooldown`, shedding load from a
+// degraded upstream before it ties up worker threads. Once the cooldown
+// has passed the circuit is half-open: exactly one caller is let through
+// as a probe, and its outcome closes (with a fresh window) or re-opens
+// the circuit. Callers pass back the Ticket checkAllowed gave them, so
+// a late outcome from a call admitted before the trip can't be taken for
+// the probe's.
+//
+// Safe to call from every worker thread without locking. Each service's
+// mode is a single atomic word (mode plus the time it was entered) moved
+// between modes by compare-and-swap, so only one caller wins each
+// transition; the window is a ring of atomic outcome slots. Services live
+// in a copy-on-write map: lookups read the current snapshot through one
+// atomic load, and only registering a service - normally done up front -
+// takes a lock.
 class CircuitBreaker {
 public:
+    enum class Mode : uint8_t { Closed, Open, HalfOpen };
+
+    struct Config {
+        size_t windowSize = 50;
+        std::chrono::milliseconds windowDuration{60000};
+        size_t minimumCalls = 10;
+        double failureRateThreshold = 0.5;
+        double slowCallRateThreshold = 0.8;
+        std::chrono::milliseconds slowCallDuration{10000};
+        std::chrono::milliseconds cooldown{30000};
+    };
+
     static CircuitBreaker& instance();
 
-    // Throws runtime_error if the circuit for `service` is open.
-    void checkAllowed(const std::string& service);
-    void recordSuccess(const std::string& service);
-    void recordFailure(const std::string& service);
+    CircuitBreaker();
+    ~CircuitBreaker();
+    CircuitBreaker(const CircuitBreaker&) = delete;
+    CircuitBreaker& operator=(const CircuitBreaker&) = delete;
+
+    // Handed out by checkAllowed and passed back to record*. The default
+    // ticket stands for a call admitted while the circuit was closed.
+    struct Ticket {
+        uint64_t word = 0;
+    };
+
+    // Registers `service`, or retunes it with a fresh, closed window.
+    // Services first seen in checkAllowed/record* get the default Config.
+    void configure(const std::string& service, const Config& config);
+
+    // Throws ServiceUnavailable if the circuit for `service` is open, or
+    // is half-open with its probe already handed out.
+    Ticket checkAllowed(const std::string& service);
+    // Outcome of a call checkAllowed admitted under `ticket`, and how long
+    // it took. While half-open only the probe's ticket counts.
+    void recordSuccess(const std::string& service, Ticket ticket, std::chrono::steady_clock::duration elapsed);
+    void recordFailure(const std::string& service, Ticket ticket, std::chrono::steady_clock::duration elapsed);
+
+    Mode mode(const std::string& service);
 
 private:
     struct State {
-        int consecutiveFailures = 0;
-        std::chrono::steady_clock::time_point openedAt{};
-        bool open = false;
+        State(const Config& config, const std::string& service);
+
+        const Config config;
+        // Mode in the low two bits, steady_clock nanoseconds at which it
+        // was entered above them.
+        std::atomic<uint64_t> word{0};
+        // The window: one outcome per slot (see circuit_breaker.cpp),
+        // written round-robin; 0 is an empty slot.
+        std::unique_ptr<std::atomic<uint64_t>[]> outcomes;
+        std::atomic<uint64_t> cursor{0};
+        // Exported as travelplanner_circuit_breaker_* {service=...}.
+        Counter* rejections = nullptr;
+        Counter* trips = nullptr;
+        Gauge* openGauge = nullptr;
     };
+    using Map = std::unordered_map<std::string, State*>;
 
-    static constexpr int failureThreshold = 5;
-    static constexpr std::chrono::seconds cooldown{30};
+    State& stateFor(const std::string& service);
+    State& publish(const std::string& service, const Config* config);
+    void record(const std::string& service, Ticket ticket, bool failed,
+                std::chrono::steady_clock::duration elapsed);
 
-    std::unordered_map<std::string, State> states;
+    std::atomic<const Map*> services_;
+    // Writers only: owns every State and every map snapshot ever published,
+    // so a reader holding an old snapshot never sees it freed. The service
+    // set is a handful of upstreams, so keeping old snapshots is cheap.
+    std::mutex registerMutex_;
+    std::vector<std::unique_ptr<State>> states_;
+    std::vector<std::unique_ptr<const Map>> snapshots_;
 };
 
 #endif // CIRCUIT_BREAKER_HPP
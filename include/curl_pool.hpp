@@ -0,0 +1,91 @@
+#ifndef CURL_POOL_HPP
+#define CURL_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <curl/curl.h>
+
+// Reusable libcurl easy handles. Creating a handle per request throws away
+// everything libcurl has learned about an upstream, so every call paid a
+// fresh DNS lookup, TCP connect and TLS handshake. Pooled handles are all
+// attached to one CURLSH share object, which makes the DNS cache, TLS
+// session cache and connection cache common to every Crow worker thread.
+class CurlHandlePool {
+public:
+    struct Stats {
+        uint64_t handlesCreated = 0;   // curl_easy_init calls
+        uint64_t handlesReused = 0;    // leases served from the idle list
+        uint64_t handlesDiscarded = 0; // returned while the idle list was full
+        uint64_t freshConnects = 0;    // transfers that opened a new connection
+        uint64_t reusedConnects = 0;   // transfers served on a warm connection
+        size_t idleHandles = 0;
+    };
+
+    // RAII lease: the handle goes back to the pool when the lease dies.
+    class Lease {
+    public:
+        Lease(CurlHandlePool& pool, CURL* handle) : pool_(&pool), handle_(handle) {}
+        ~Lease();
+        Lease(Lease&& other) noexcept : pool_(other.pool_), handle_(other.handle_) {
+            other.handle_ = nullptr;
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        CURL* get() const { return handle_; }
+
+    private:
+        CurlHandlePool* pool_;
+        CURL* handle_;
+    };
+
+    static CurlHandlePool& instance();
+
+    // Returns a handle with the pool's defaults (share object, keep-alive)
+    // applied. Throws runtime_error if libcurl cannot allocate one.
+    Lease acquire();
+
+    // Call after curl_easy_perform on a leased handle so connection reuse
+    // shows up in stats().
+    void recordTransfer(CURL* handle);
+
+    Stats stats() const;
+
+    // The share object, for handles driven outside the pool (e.g. by a
+    // multi handle) that should still see the shared caches.
+    CURLSH* share() const { return share_; }
+
+    // Upper bound on idle handles kept for reuse; extras are cleaned up.
+    static constexpr size_t maxIdleHandles = 32;
+
+    CurlHandlePool(const CurlHandlePool&) = delete;
+    CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+
+private:
+    CurlHandlePool();
+    ~CurlHandlePool();
+
+    void release(CURL* handle);
+    void applyDefaults(CURL* handle) const;
+
+    static void lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userptr);
+    static void unlockShare(CURL*, curl_lock_data data, void* userptr);
+
+    CURLSH* share_ = nullptr;
+    std::mutex shareLocks_[CURL_LOCK_DATA_LAST];
+
+    mutable std::mutex idleMutex_;
+    std::vector<CURL*> idle_;
+
+    std::atomic<uint64_t> handlesCreated_{0};
+    std::atomic<uint64_t> handlesReused_{0};
+    std::atomic<uint64_t> handlesDiscarded_{0};
+    std::atomic<uint64_t> freshConnects_{0};
+    std::atomic<uint64_t> reusedConnects_{0};
+};
+
+#endif // CURL_POOL_HPP
@@ -0,0 +1,41 @@
+#ifndef FAST_PARSE_HPP
+#define FAST_PARSE_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+
+// Locale-independent, allocation-free scanners for the fixed formats the
+// upstream APIs use. Each one accepts the whole input or nothing: on
+// failure it returns false and leaves `out` untouched, unlike
+// std::get_time, which can leave a half-filled tm behind.
+namespace FastParse {
+
+// Plain decimal integer, optional leading '-'; no whitespace, no '+'.
+bool parseInt(std::string_view text, int& out);
+
+// Decimal number such as "3085.00" or "-1e3"; always '.' as the
+// separator, whatever the global locale says.
+bool parseDouble(std::string_view text, double& out);
+
+// "YYYY-MM-DD". Checks digit positions and month/day ranges (like
+// get_time's %m/%d) but not per-month day counts - see DateUtils for that.
+bool parseDate(std::string_view text, std::tm& out);
+
+// "HH:MM", 00:00-23:59.
+bool parseTime(std::string_view text, int& hour, int& minute);
+
+// "YYYY-MM-DDTHH:MM" or "YYYY-MM-DDTHH:MM:SS" (Amadeus' local times).
+bool parseDateTime(std::string_view text, std::tm& out);
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar. Pure
+// arithmetic, so day differences don't shift with the local time zone's
+// DST rules the way mktime-based ones do.
+int64_t daysFromCivil(int year, int month, int day);
+
+// Inverse of daysFromCivil.
+void civilFromDays(int64_t days, int& year, int& month, int& day);
+
+} // namespace FastParse
+
+#endif // FAST_PARSE_HPP
@@ -1,21 +1,27 @@
 #pragma once
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <ctime>
 #include <vector>
 using namespace std;
 
+// Allocator-aware like Hotel and ItineraryItem.
 class Flight {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
 private:
-    string airline;
-    string flightNumber;
-    string departureAirport;
-    string arrivalAirport;
+    std::pmr::string airline;
+    std::pmr::string flightNumber;
+    std::pmr::string departureAirport;
+    std::pmr::string arrivalAirport;
     tm departureTime;
     tm arrivalTime;
     double price;
     int availableSeats;
-    string currency;
-    string source;  // "amadeus" = live inventory, "estimate"/"mock" = not bookable
+    std::pmr::string currency;
+    std::pmr::string source;  // "amadeus" = live inventory, "estimate"/"mock" = not bookable
 
 public:
     /**
@@ -31,11 +37,21 @@ public:
      * @param currency ISO currency code for price (default "INR")
      * @param source Origin of the data: "amadeus" for live bookable
      *        inventory, "estimate" or "mock" for representative data
+     * @param alloc Resource for the string members
      */
-    Flight(string airline, string flightNum, string depAirport,
-           string arrAirport, tm depTime, tm arrTime,
-           double price, int seats, string currency = "INR",
-           string source = "amadeus");
+    Flight(string_view airline, string_view flightNum, string_view depAirport,
+           string_view arrAirport, tm depTime, tm arrTime,
+           double price, int seats, string_view currency = "INR",
+           string_view source = "amadeus", allocator_type alloc = {});
+
+    Flight(const Flight& other) = default;
+    Flight(Flight&& other) = default;
+    Flight(const Flight& other, allocator_type alloc);
+    Flight(Flight&& other, allocator_type alloc);
+    Flight& operator=(const Flight& other) = default;
+    Flight& operator=(Flight&& other) = default;
+
+    allocator_type get_allocator() const { return airline.get_allocator(); }
 
     /**
      * @brief Display flight information
@@ -48,16 +64,16 @@ public:
     void displayPrice() const;
 
     // Getters
-    string getAirline() const;
-    string getFlightNumber() const;
-    string getDepartureAirport() const;
-    string getArrivalAirport() const;
+    string_view getAirline() const;
+    string_view getFlightNumber() const;
+    string_view getDepartureAirport() const;
+    string_view getArrivalAirport() const;
     tm getDepartureTime() const;
     tm getArrivalTime() const;
     double getPrice() const;
     int getAvailableSeats() const;
-    string getCurrency() const;
-    string getSource() const;
+    string_view getCurrency() const;
+    string_view getSource() const;
 
     // False when the data is an estimate rather than bookable inventory.
     bool isBookable() const;
@@ -1,11 +1,12 @@
 #ifndef FLIGHT_PROVIDER_HPP
 #define FLIGHT_PROVIDER_HPP
 
+#include <chrono>
+#include <exception>
 #include <functional>
 #include <memory>
 #include <string>
-#include <vector>
-#include "flight.hpp"
+#include "flight_table.hpp"
 
 // Flight inventory is the one part of this application with no stable free
 // data source: the Amadeus self-service tier is not always available to a
@@ -15,10 +16,22 @@ class FlightProvider {
 public:
     virtual ~FlightProvider() = default;
 
-    virtual std::vector<Flight> search(const std::string& from,
-                                       const std::string& to,
-                                       const std::string& date,
-                                       int passengers) = 0;
+    virtual FlightTable search(const std::string& from,
+                               const std::string& to,
+                               const std::string& date,
+                               int passengers) = 0;
+
+    using SearchCallback = std::function<void(std::exception_ptr error, FlightTable flights)>;
+
+    // search() for callers that must not block: `done` is called exactly
+    // once, with the results or the failure. The default runs search() on
+    // the calling thread; providers that can wait on callbacks instead
+    // override it.
+    virtual void searchAsync(const std::string& from,
+                             const std::string& to,
+                             const std::string& date,
+                             int passengers,
+                             SearchCallback done);
 
     // Short identifier, also used as the circuit-breaker service key.
     virtual std::string name() const = 0;
@@ -30,11 +43,29 @@ public:
 // Everything a provider needs from the outside world, injected rather than
 // reached for globally so providers stay unit-testable with fakes.
 struct FlightProviderConfig {
+    using Callback = std::function<void(std::exception_ptr error, std::string result)>;
+
+    // Failures are UpstreamErrors (see upstream_error.hpp), as from
+    // APIHandler's HTTP helpers; the Amadeus provider re-authenticates on
+    // an HttpError 401.
     std::function<std::string(const std::string& url,
                               const std::string& method,
                               const std::string& data,
                               const std::string& token)> httpRequest;
+    // Non-blocking twin of httpRequest, calling `done` with the same body
+    // or error. When set, searchAsync() holds no thread while Amadeus or
+    // Gemini answers; leave it unset where only a blocking client exists.
+    // `done` should not run on a network thread: the response is parsed
+    // in it.
+    std::function<void(const std::string& url,
+                       const std::string& method,
+                       const std::string& data,
+                       const std::string& token,
+                       Callback done)> httpRequestAsync;
     std::function<std::string(const std::string& city)> resolveIATA;
+    // Optional non-blocking twin of resolveIATA; searchAsync() falls back
+    // to calling resolveIATA inline.
+    std::function<void(const std::string& city, Callback done)> resolveIATAAsync;
 
     std::string currency = "INR";
 
@@ -42,6 +73,13 @@ struct FlightProviderConfig {
     std::string amadeusClientSecret;
     std::string amadeusTokenUrl;
     std::string amadeusFlightUrl;
+    // Start refreshing the cached OAuth token this long before it expires.
+    std::chrono::seconds amadeusTokenRefreshAhead{60};
+    // Offers Amadeus is asked for (its maxFlightOffers, at most 250), and
+    // how many of the cheapest are kept. Asking for more than are kept
+    // finds cheaper fares at the cost of a bigger response.
+    int amadeusMaxOffers = 10;
+    size_t flightResultLimit = 10;
 
     std::string geminiApiKey;
     std::string geminiApiUrl;
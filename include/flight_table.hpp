@@ -0,0 +1,154 @@
+#ifndef FLIGHT_TABLE_HPP
+#define FLIGHT_TABLE_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "flight.hpp"
+
+// Search results in columnar form. A result set is one currency and one
+// source, so those are stored once; carrier and airport codes are interned
+// into a small per-table dictionary and referenced by 16-bit id; flight
+// numbers share one character buffer; times are int64 local wall-clock
+// seconds since 1970-01-01 and prices int64 hundredths. Sorting, filtering
+// and serializing walk these contiguous columns instead of an array of
+// string-heavy Flight objects.
+//
+// Row is a two-word view with Flight's getter names, so code that reads
+// results doesn't care which representation it has.
+//
+// Every column draws on the table's memory resource. A plain copy (say,
+// out of the flight cache) uses the default resource; the allocator-
+// extended copy puts it in a request's arena instead.
+class FlightTable {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    class Row {
+    public:
+        std::string_view getAirline() const { return table_->codes_[table_->airline_[i_]]; }
+        std::string_view getFlightNumber() const { return table_->flightNumber(i_); }
+        std::string_view getDepartureAirport() const { return table_->codes_[table_->departureAirport_[i_]]; }
+        std::string_view getArrivalAirport() const { return table_->codes_[table_->arrivalAirport_[i_]]; }
+        int64_t departureEpoch() const { return table_->departureTime_[i_]; }
+        int64_t arrivalEpoch() const { return table_->arrivalTime_[i_]; }
+        std::tm getDepartureTime() const { return toTm(departureEpoch()); }
+        std::tm getArrivalTime() const { return toTm(arrivalEpoch()); }
+        int64_t priceMinor() const { return table_->priceMinor_[i_]; }
+        double getPrice() const { return static_cast<double>(priceMinor()) / 100.0; }
+        int getAvailableSeats() const { return table_->seats_[i_]; }
+        std::string_view getCurrency() const { return table_->currency_; }
+        std::string_view getSource() const { return table_->source_; }
+        bool isBookable() const { return table_->isBookable(); }
+        size_t index() const { return i_; }
+
+        Flight toFlight() const;
+
+    private:
+        friend class FlightTable;
+        Row(const FlightTable* table, size_t i) : table_(table), i_(i) {}
+
+        const FlightTable* table_;
+        size_t i_;
+    };
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Row;
+
+        Row operator*() const { return Row(table_, i_); }
+        const_iterator& operator++() { ++i_; return *this; }
+        bool operator==(const const_iterator& other) const { return i_ == other.i_; }
+        bool operator!=(const const_iterator& other) const { return i_ != other.i_; }
+
+    private:
+        friend class FlightTable;
+        const_iterator(const FlightTable* table, size_t i) : table_(table), i_(i) {}
+
+        const FlightTable* table_;
+        size_t i_;
+    };
+
+    explicit FlightTable(std::string_view currency = "INR", std::string_view source = "amadeus",
+                         allocator_type alloc = {});
+    FlightTable(const FlightTable& other) = default;
+    FlightTable(FlightTable&& other) = default;
+    FlightTable(const FlightTable& other, allocator_type alloc);
+    FlightTable& operator=(const FlightTable& other) = default;
+    FlightTable& operator=(FlightTable&& other) = default;
+
+    allocator_type get_allocator() const { return currency_.get_allocator(); }
+
+    void reserve(size_t rows);
+    void add(std::string_view airline, std::string_view flightNumber,
+             std::string_view departureAirport, std::string_view arrivalAirport,
+             int64_t departureEpoch, int64_t arrivalEpoch, int64_t priceMinor, int seats);
+
+    size_t size() const { return priceMinor_.size(); }
+    bool empty() const { return priceMinor_.empty(); }
+    Row operator[](size_t i) const { return Row(this, i); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    std::string_view currency() const { return currency_; }
+    std::string_view source() const { return source_; }
+    // False when the data is an estimate rather than bookable inventory.
+    bool isBookable() const { return source_ == "amadeus"; }
+
+    const std::pmr::vector<int64_t>& priceMinorColumn() const { return priceMinor_; }
+    const std::pmr::vector<int64_t>& departureColumn() const { return departureTime_; }
+    const std::pmr::vector<int32_t>& seatsColumn() const { return seats_; }
+
+    // Cheapest first; equal prices keep their relative order, so the legs
+    // of one offer stay adjacent.
+    void sortByPrice();
+    // Keeps the rows `keep(row)` accepts, in order.
+    template <typename Predicate>
+    void retainIf(Predicate keep) {
+        std::pmr::vector<uint32_t> kept(get_allocator());
+        kept.reserve(size());
+        for (size_t i = 0; i < size(); ++i) {
+            if (keep(Row(this, i))) kept.push_back(static_cast<uint32_t>(i));
+        }
+        if (kept.size() != size()) gather(kept);
+    }
+    void truncate(size_t rows);
+
+    // Materializes row objects, for callers that still hold Flights.
+    std::vector<Flight> toFlights() const;
+    // Approximate heap footprint, for cache weighers.
+    size_t memoryBytes() const;
+
+    static int64_t toEpoch(const std::tm& time);
+    static std::tm toTm(int64_t epoch);
+    static int64_t toMinorUnits(double amount);
+
+private:
+    uint16_t intern(std::string_view code);
+    std::string_view flightNumber(size_t i) const;
+    // Rebuilds every column from the rows listed in `order`.
+    void gather(const std::pmr::vector<uint32_t>& order);
+
+    std::pmr::string currency_;
+    std::pmr::string source_;
+    std::pmr::vector<std::pmr::string> codes_;
+    std::pmr::vector<uint16_t> airline_;
+    std::pmr::vector<uint16_t> departureAirport_;
+    std::pmr::vector<uint16_t> arrivalAirport_;
+    std::pmr::string flightNumbers_;
+    std::pmr::vector<uint32_t> flightNumberEnd_;
+    std::pmr::vector<int64_t> departureTime_;
+    std::pmr::vector<int64_t> arrivalTime_;
+    std::pmr::vector<int64_t> priceMinor_;
+    std::pmr::vector<int32_t> seats_;
+};
+
+#endif // FLIGHT_TABLE_HPP
@@ -0,0 +1,36 @@
+#ifndef GEMINI_PARSER_HPP
+#define GEMINI_PARSER_HPP
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "hotel.hpp"
+#include "itinerary_item.hpp"
+
+// Pure parsing of Gemini structured-output replies, kept out of the curl
+// layer like FlightParser so it can be tested against recorded payloads.
+// Results are built in the caller's memory resource.
+namespace GeminiParser {
+
+// The model's reply, candidates[0].content.parts[0].text, which with
+// structured output is itself a JSON document. Scans the envelope without
+// building a DOM. Throws if the envelope is malformed or has no text.
+std::string candidateText(const std::string& response);
+
+// Hotels from the hotel-suggestion schema (hotel_name, star_rating,
+// total_stay_cost, address); the query supplies everything else.
+std::pmr::vector<Hotel> parseHotels(const std::string& text, std::string_view city,
+                                    std::string_view checkIn, std::string_view checkOut,
+                                    std::string_view currency,
+                                    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+// Items for each day of the itinerary schema (date, place, famous_for,
+// how_to_go), between check-in and check-out at `hotelName`.
+std::pmr::vector<ItineraryItem> parseItinerary(const std::string& text, std::string_view hotelName,
+                                               std::string_view startDate, std::string_view endDate,
+                                               std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+} // namespace GeminiParser
+
+#endif // GEMINI_PARSER_HPP
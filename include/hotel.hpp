@@ -1,17 +1,25 @@
 #pragma once
+#include <memory_resource>
 #include <string>
+#include <string_view>
 using namespace std;
 
+// Allocator-aware: strings live in the memory resource the Hotel was built
+// with (see get_allocator), so a request can build its results in one
+// arena and drop them together. Plain copies use the default resource.
 class Hotel {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
 private:
-    string name;
-    string location;
+    std::pmr::string name;
+    std::pmr::string location;
     double pricePerNight;
     double rating;
-    string checkInDate;
-    string checkOutDate;
-    string address;
-    string currency;
+    std::pmr::string checkInDate;
+    std::pmr::string checkOutDate;
+    std::pmr::string address;
+    std::pmr::string currency;
 
 public:
     /**
@@ -24,9 +32,20 @@ public:
      * @param checkOut Check-out date
      * @param addr Address
      * @param currency ISO currency code for price (default "INR")
+     * @param alloc Resource for the string members
      */
-    Hotel(string n, string loc, double price, double rat,
-          string checkIn, string checkOut, string addr = "", string currency = "INR");
+    Hotel(string_view n, string_view loc, double price, double rat,
+          string_view checkIn, string_view checkOut, string_view addr = "",
+          string_view currency = "INR", allocator_type alloc = {});
+
+    Hotel(const Hotel& other) = default;
+    Hotel(Hotel&& other) = default;
+    Hotel(const Hotel& other, allocator_type alloc);
+    Hotel(Hotel&& other, allocator_type alloc);
+    Hotel& operator=(const Hotel& other) = default;
+    Hotel& operator=(Hotel&& other) = default;
+
+    allocator_type get_allocator() const { return name.get_allocator(); }
 
     /**
      * @brief Display hotel information
@@ -34,11 +53,11 @@ public:
     void displayInfo() const;
 
     // Getters
-    string getName() const;
-    string getLocation() const;
+    string_view getName() const;
+    string_view getLocation() const;
     double getPricePerNight() const;
     double getRating() const;
-    string getCheckInDate() const;
-    string getCheckOutDate() const;
-    string getAddress() const;
+    string_view getCheckInDate() const;
+    string_view getCheckOutDate() const;
+    string_view getAddress() const;
 };
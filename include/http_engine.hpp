@@ -0,0 +1,82 @@
+#ifndef HTTP_ENGINE_HPP
+#define HTTP_ENGINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+#include "http_transfer.hpp"
+
+// Event-loop HTTP client: one background thread drives every in-flight
+// upstream call through curl_multi_socket_action, so a hundred concurrent
+// requests cost a hundred sockets rather than a hundred blocked threads.
+// Transfers use pooled handles (see CurlHandlePool) and therefore share the
+// same DNS/TLS/connection caches as the blocking makeHttpRequest path.
+class HttpEngine {
+public:
+    // Exactly one of `error` / `body` is meaningful. Invoked on the engine
+    // thread - keep it short and hand heavy work (JSON parsing, further
+    // blocking calls) to another executor.
+    using Callback = std::function<void(std::exception_ptr error, std::string body)>;
+
+    static HttpEngine& instance();
+
+    void requestAsync(HttpRequest request, Callback done);
+    std::future<std::string> requestAsync(HttpRequest request);
+
+    // Transfers submitted but not yet completed.
+    size_t inFlight() const { return inFlight_.load(std::memory_order_relaxed); }
+
+    HttpEngine(const HttpEngine&) = delete;
+    HttpEngine& operator=(const HttpEngine&) = delete;
+
+private:
+    struct Pending {
+        std::unique_ptr<HttpTransfer> transfer;
+        Callback done;
+    };
+
+    HttpEngine();
+    ~HttpEngine();
+
+    void run();
+    void wake();
+    void startQueued();
+    void completeFinished();
+    void fail(Pending& pending, std::exception_ptr error);
+
+    static int onSocket(CURL* easy, curl_socket_t socket, int what, void* userp, void* socketp);
+    static int onTimer(CURLM* multi, long timeoutMs, void* userp);
+
+    CURLM* multi_ = nullptr;
+
+    // Submitted from any thread, started by the loop.
+    std::mutex queueMutex_;
+    std::vector<std::unique_ptr<Pending>> queued_;
+
+    // Loop-thread only: sockets libcurl asked us to watch (with the
+    // CURL_POLL_* interest for each), transfers owned by the multi handle
+    // and the timeout libcurl last requested.
+    std::map<curl_socket_t, int> sockets_;
+    std::set<Pending*> active_;
+    bool timerArmed_ = false;
+    std::chrono::steady_clock::time_point timerDeadline_{};
+
+    std::atomic<size_t> inFlight_{0};
+    std::atomic<bool> stopping_{false};
+#ifndef _WIN32
+    int wakePipe_[2] = {-1, -1};
+#endif
+    std::thread loop_;
+};
+
+#endif // HTTP_ENGINE_HPP
@@ -0,0 +1,60 @@
+#ifndef HTTP_TRANSFER_HPP
+#define HTTP_TRANSFER_HPP
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <curl/curl.h>
+#include "curl_pool.hpp"
+#include "request_cost.hpp"
+#include "tracing.hpp"
+
+// One upstream call, in the shape APIHandler::makeHttpRequest takes.
+struct HttpRequest {
+    std::string url;
+    std::string method = "GET";
+    std::string data;
+    std::string token;
+    // Parent for the call's span; captured where the request is built,
+    // since the transfer may run on the HttpEngine thread.
+    SpanContext trace = Tracer::current();
+    // Inbound request to charge the call to (Server-Timing), same reason.
+    std::shared_ptr<RequestCost> cost = RequestCost::current();
+};
+
+// Everything a single transfer needs to stay alive while libcurl runs it:
+// the pooled handle, the header list and the response buffer. Shared by the
+// blocking path (curl_easy_perform) and the multi-handle HttpEngine so both
+// send identical requests and fail the same way.
+class HttpTransfer {
+public:
+    explicit HttpTransfer(HttpRequest request);
+
+    HttpTransfer(const HttpTransfer&) = delete;
+    HttpTransfer& operator=(const HttpTransfer&) = delete;
+
+    CURL* handle() const { return lease_.get(); }
+    const HttpRequest& request() const { return request_; }
+
+    // Turns the transfer's outcome into the response body. Throws
+    // TransportError if there was no response and HttpError (with any
+    // Retry-After the upstream sent) for a 4xx/5xx status.
+    // Also records the per-phase timing metrics and logs the call if it took
+    // longer than the slow-call threshold.
+    std::string finish(CURLcode result);
+
+    // Process-wide; defaults to 2 s.
+    static void setSlowCallThreshold(std::chrono::milliseconds threshold);
+
+private:
+    static size_t writeCallback(void* contents, size_t size, size_t nmemb, void* userp);
+    static size_t headerCallback(char* buffer, size_t size, size_t nitems, void* userdata);
+
+    HttpRequest request_;
+    CurlHandlePool::Lease lease_;
+    std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> headers_;
+    std::string response_;
+    std::string retryAfter_; // raw header value, if the response had one
+};
+
+#endif // HTTP_TRANSFER_HPP
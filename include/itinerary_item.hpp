@@ -1,31 +1,49 @@
 #ifndef ITINERARY_ITEM_HPP
 #define ITINERARY_ITEM_HPP
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
 using namespace std;
 
+// Allocator-aware like Hotel: a std::pmr::vector<ItineraryItem> hands its
+// memory resource down to every item's strings.
 class ItineraryItem {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
 private:  // Changed to private for better encapsulation
-    string activity;
-    string date;
-    string time;
-    string category; // e.g., Landmark, Food, Shopping, etc.
+    std::pmr::string activity;
+    std::pmr::string date;
+    std::pmr::string time;
+    std::pmr::string category; // e.g., Landmark, Food, Shopping, etc.
 
 public:
     // Default constructor
     ItineraryItem() = default;
+    explicit ItineraryItem(allocator_type alloc);
 
     // Constructor with parameters
-    ItineraryItem(string act, string d, string t, string cat);
+    ItineraryItem(string_view act, string_view d, string_view t, string_view cat,
+                  allocator_type alloc = {});
+
+    ItineraryItem(const ItineraryItem& other) = default;
+    ItineraryItem(ItineraryItem&& other) = default;
+    ItineraryItem(const ItineraryItem& other, allocator_type alloc);
+    ItineraryItem(ItineraryItem&& other, allocator_type alloc);
+    ItineraryItem& operator=(const ItineraryItem& other) = default;
+    ItineraryItem& operator=(ItineraryItem&& other) = default;
+
+    allocator_type get_allocator() const { return activity.get_allocator(); }
 
     // Display function
     void displayDetails() const;
 
     // Getters
-    string getActivity() const;
-    string getDate() const;
-    string getTime() const;
-    string getCategory() const;
+    string_view getActivity() const;
+    string_view getDate() const;
+    string_view getTime() const;
+    string_view getCategory() const;
 };
 
 #endif // ITINERARY_ITEM_HPP
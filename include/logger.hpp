@@ -1,18 +1,114 @@
 #ifndef LOGGER_HPP
 #define LOGGER_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 // Minimal structured logger: timestamped "LEVEL message key=value key=value" lines.
-// INFO/WARN go to stdout, ERROR goes to stderr.
+// DEBUG/INFO go to stdout, WARN/ERROR go to stderr.
+//
+// Calls only enqueue the line on a lock-free ring; a background writer thread
+// timestamps and batches lines out to the terminal/pipe, so request threads
+// never block on I/O. Pending lines are flushed at exit or by flush().
+//
+// Prefer the LOG_* macros below over the string overloads on hot paths:
+// they test the level first and only build the message when it is wanted.
 class Logger {
 public:
+    enum class Level { Debug = 0, Info = 1, Warn = 2, Error = 3, Off = 4 };
+
+    // What to do when the ring is full (a stalled pipe, a log storm).
+    // ERROR lines always wait for space, whatever the policy.
+    enum class OverflowPolicy {
+        Drop,   // discard the line (default) and report the count later
+        Block,  // wait for the writer to make room
+        Sample  // keep one in `sampleEvery` overflowing lines, drop the rest
+    };
+
+    static void debug(const std::string& message);
     static void info(const std::string& message);
     static void warn(const std::string& message);
     static void error(const std::string& message);
 
+    // Runtime threshold; defaults to LOG_LEVEL=debug|info|warn|error|off,
+    // else info.
+    static void setLevel(Level level) { threshold_.store(static_cast<int>(level), std::memory_order_relaxed); }
+    static Level level() { return static_cast<Level>(threshold_.load(std::memory_order_relaxed)); }
+    static bool enabled(Level level) {
+        return static_cast<int>(level) >= threshold_.load(std::memory_order_relaxed);
+    }
+
+    // Also configurable via LOG_OVERFLOW=drop|block|sample.
+    static void setOverflowPolicy(OverflowPolicy policy, unsigned sampleEvery = 16);
+
+    // Write each line on the calling thread, after flushing std::cout, instead
+    // of queueing it. For interactive programs whose prompts go through
+    // std::cout and must not be reordered with log lines.
+    static void setSynchronous(bool on);
+
+    // Block until every line logged before this call has been written.
+    static void flush();
+
+    // Lines discarded by the overflow policy so far.
+    static uint64_t dropped();
+
+    // Concatenate strings, characters and numbers into one message.
+    template <typename... Args>
+    static std::string concat(const Args&... args) {
+        std::string out;
+        (append(out, args), ...);
+        return out;
+    }
+
+    // Backend for the LOG_* macros: level already checked, message built.
+    static void write(Level level, std::string message);
+
 private:
-    static void log(const std::string& level, const std::string& message, bool toStderr);
+    static void append(std::string& out, std::string_view s) { out.append(s.data(), s.size()); }
+    static void append(std::string& out, char c) { out.push_back(c); }
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    static void append(std::string& out, T value) { out += std::to_string(value); }
+
+    static inline std::atomic<int> threshold_{static_cast<int>(Level::Info)};
 };
 
+// Lines below this level are compiled out entirely (arguments are not even
+// evaluated): 0 = debug, 1 = info, 2 = warn, 3 = error.
+#ifndef TRAVELPLANNER_MIN_LOG_LEVEL
+#define TRAVELPLANNER_MIN_LOG_LEVEL 0
+#endif
+
+#define TRAVELPLANNER_LOG(level, ...)                                \
+    do {                                                             \
+        if (Logger::enabled(level))                                  \
+            Logger::write(level, Logger::concat(__VA_ARGS__));       \
+    } while (0)
+
+#if TRAVELPLANNER_MIN_LOG_LEVEL <= 0
+#define LOG_DEBUG(...) TRAVELPLANNER_LOG(Logger::Level::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if TRAVELPLANNER_MIN_LOG_LEVEL <= 1
+#define LOG_INFO(...) TRAVELPLANNER_LOG(Logger::Level::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if TRAVELPLANNER_MIN_LOG_LEVEL <= 2
+#define LOG_WARN(...) TRAVELPLANNER_LOG(Logger::Level::Warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if TRAVELPLANNER_MIN_LOG_LEVEL <= 3
+#define LOG_ERROR(...) TRAVELPLANNER_LOG(Logger::Level::Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
 #endif // LOGGER_HPP
@@ -0,0 +1,106 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// In-process metrics in the Prometheus data model. Updating a metric is a
+// relaxed atomic operation and never takes a lock; only registering (or
+// looking up) a series and rendering the scrape do. Hot paths should look a
+// series up once and keep the reference - references stay valid for the
+// life of the registry.
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+class Counter {
+public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// Fixed upper bounds chosen at registration; observe() is a short linear
+// scan plus two atomic adds.
+class Histogram {
+public:
+    explicit Histogram(std::vector<double> bounds);
+
+    void observe(double value);
+
+    const std::vector<double>& bounds() const { return bounds_; }
+    // Per-bucket (non-cumulative) counts; the last entry is the +Inf bucket.
+    std::vector<uint64_t> bucketCounts() const;
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    double sum() const { return sum_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<double> sum_{0.0};
+};
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    // Seconds, from 5 ms to 30 s: sized for upstream HTTP calls.
+    static std::vector<double> latencyBuckets();
+
+    // Returns the existing series when name + labels were registered before.
+    Counter& counter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Gauge& gauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Histogram& histogram(const std::string& name, const std::string& help, const MetricLabels& labels = {},
+                         const std::vector<double>& bounds = latencyBuckets());
+
+    // A series whose value lives elsewhere (cache stats, pool sizes) and is
+    // read only when scraped, so the owner pays nothing per operation.
+    void counterFn(const std::string& name, const std::string& help, const MetricLabels& labels,
+                   std::function<double()> read);
+    void gaugeFn(const std::string& name, const std::string& help, const MetricLabels& labels,
+                 std::function<double()> read);
+
+    // Prometheus text exposition format 0.0.4.
+    std::string renderPrometheus() const;
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Series {
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()> read;
+    };
+
+    struct Family {
+        Type type;
+        std::string help;
+        std::map<MetricLabels, Series> series;
+    };
+
+    Series& series(const std::string& name, const std::string& help, Type type, const MetricLabels& labels);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+};
+
+#endif // METRICS_HPP
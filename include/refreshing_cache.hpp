@@ -0,0 +1,92 @@
+#ifndef REFRESHING_CACHE_HPP
+#define REFRESHING_CACHE_HPP
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+#include "sharded_cache.hpp"
+
+// Stale-while-revalidate cache. An entry is fresh for `freshFor` after it
+// is stored; for a further `staleFor` it is still served, but the first
+// caller to see it stale is told to refresh it in the background while
+// everyone keeps getting the old value. After that it is gone and callers
+// must fetch synchronously again.
+//
+// The cache itself never spawns work - it only decides who refreshes, so
+// the caller stays in charge of threads and error handling.
+template <typename K, typename V,
+          typename Hash = std::hash<K>,
+          typename Clock = std::chrono::steady_clock>
+class RefreshingCache {
+public:
+    using Duration = typename Clock::duration;
+    using TimePoint = typename Clock::time_point;
+
+    struct Lookup {
+        std::optional<V> value;
+        bool stale = false;
+        // True for exactly one caller per stale entry, until put() or
+        // refreshFailed() settles that refresh.
+        bool shouldRefresh = false;
+    };
+
+    RefreshingCache(size_t byteBudget, Duration freshFor, Duration staleFor,
+                    typename ShardedCache<K, V>::Sizer sizer = ShardedCache<K, V>::defaultSizer)
+        : entries_(byteBudget, freshFor + staleFor, 16,
+                   [sizer](const K& key, const Stored& stored) { return sizer(key, stored.value); }),
+          freshFor_(freshFor) {}
+
+    Lookup get(const K& key) {
+        Lookup result;
+        auto stored = entries_.get(key);
+        if (!stored) return result;
+
+        result.value = std::move(stored->value);
+        if (Clock::now() - stored->storedAt < freshFor_) return result;
+
+        result.stale = true;
+        std::lock_guard<std::mutex> lock(refreshingMutex_);
+        result.shouldRefresh = refreshing_.insert(key).second;
+        return result;
+    }
+
+    void put(const K& key, V value) {
+        entries_.put(key, Stored{std::move(value), Clock::now()});
+        settle(key);
+    }
+
+    // The background refresh for `key` failed; the stale value stays in
+    // place and the next caller to see it gets to try again.
+    void refreshFailed(const K& key) { settle(key); }
+
+    void clear() {
+        entries_.clear();
+        std::lock_guard<std::mutex> lock(refreshingMutex_);
+        refreshing_.clear();
+    }
+
+    typename ShardedCache<K, V>::Stats stats() const {
+        auto s = entries_.stats();
+        return {s.hits, s.misses, s.evictions, s.expirations, s.entries, s.bytes};
+    }
+
+private:
+    struct Stored {
+        V value;
+        TimePoint storedAt;
+    };
+
+    void settle(const K& key) {
+        std::lock_guard<std::mutex> lock(refreshingMutex_);
+        refreshing_.erase(key);
+    }
+
+    ShardedCache<K, Stored, Hash, Clock> entries_;
+    Duration freshFor_;
+
+    std::mutex refreshingMutex_;
+    std::unordered_set<K, Hash> refreshing_;
+};
+
+#endif // REFRESHING_CACHE_HPP
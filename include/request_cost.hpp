@@ -0,0 +1,78 @@
+#ifndef REQUEST_COST_HPP
+#define REQUEST_COST_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// What one inbound request cost us: time per phase plus the upstream HTTP
+// calls it triggered. The server installs one per request and reports it
+// as a Server-Timing header.
+//
+// Like the tracing context, the current accumulator is thread-local and
+// must be carried across thread hops explicitly (RequestCostScope on the
+// other side). It is shared and updated with atomics because a request's
+// work can run on several threads at once (the IATA fan-out, the HTTP
+// engine).
+class RequestCost {
+public:
+    // Phases nest: `provider` includes the IATA lookups and parsing done
+    // inside the provider call. Time is summed across threads, so
+    // concurrent lookups can add up to more than wall-clock time.
+    enum class Phase { Cache, Iata, Provider, Parse, Serialize };
+    static constexpr size_t phaseCount = 5;
+
+    void add(Phase phase, std::chrono::nanoseconds elapsed);
+    void addUpstreamCall(size_t responseBytes, std::chrono::nanoseconds elapsed);
+
+    std::chrono::nanoseconds phaseTime(Phase phase) const;
+    uint64_t upstreamCalls() const { return upstreamCalls_.load(std::memory_order_relaxed); }
+    uint64_t upstreamBytes() const { return upstreamBytes_.load(std::memory_order_relaxed); }
+
+    // e.g. `cache;dur=0.02, iata;dur=180.4, ..., upstream;dur=912.3;desc="calls=3 bytes=48211", total;dur=1003.9`
+    // Phases that never ran are left out.
+    std::string serverTimingHeader(std::chrono::nanoseconds total) const;
+
+    // The calling thread's accumulator; null outside a request.
+    static std::shared_ptr<RequestCost> current();
+
+private:
+    std::array<std::atomic<int64_t>, phaseCount> phaseNanos_{};
+    std::atomic<uint64_t> upstreamCalls_{0};
+    std::atomic<uint64_t> upstreamBytes_{0};
+    std::atomic<int64_t> upstreamNanos_{0};
+};
+
+// Makes `cost` the calling thread's accumulator for a scope.
+class RequestCostScope {
+public:
+    explicit RequestCostScope(std::shared_ptr<RequestCost> cost);
+    ~RequestCostScope();
+
+    RequestCostScope(const RequestCostScope&) = delete;
+    RequestCostScope& operator=(const RequestCostScope&) = delete;
+
+private:
+    std::shared_ptr<RequestCost> previous_;
+};
+
+// Charges the scope's duration to `phase` of the current request, if any.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(RequestCost::Phase phase);
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    RequestCost* cost_;
+    RequestCost::Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#endif // REQUEST_COST_HPP
@@ -1,37 +1,253 @@
 #ifndef RETRY_HPP
 #define RETRY_HPP
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <random>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <utility>
 #include "logger.hpp"
+#include "metrics.hpp"
+#include "retry_budget.hpp"
+#include "timer_queue.hpp"
+#include "upstream_error.hpp"
 
-// Retries `fn` up to maxRetries times with exponential backoff whenever it
-// throws an exception whose message contains "HTTP error 503" (service
-// overloaded). Any other exception propagates immediately. After the last
-// attempt fails, the last exception is rethrown wrapped with `errorPrefix`.
+// The retry counters of one operation, resolved from the registry once:
+// keep one per call site (a function-local static), not one per call.
+struct RetryMetrics {
+    explicit RetryMetrics(const std::string& operation)
+        : retries(MetricsRegistry::instance().counter("travelplanner_retries_total", "Retried upstream calls",
+                                                      {{"operation", operation}})),
+          exhausted(MetricsRegistry::instance().counter("travelplanner_retries_exhausted_total",
+                                                        "Calls that failed after every retry",
+                                                        {{"operation", operation}})) {}
+
+    Counter& retries;
+    Counter& exhausted;
+};
+
+// How many tries in all, how to space them, and what they may cost the
+// service. Waits grow exponentially with full jitter: before try N+2 the
+// wait is uniform in [0, min(maxDelay, baseDelay * 2^N)], so callers that
+// failed together don't come back in lockstep. A Retry-After from the
+// upstream replaces the jittered wait; one longer than maxDelay ends the
+// retries instead.
+struct RetryPolicy {
+    int maxRetries = 3;
+    std::chrono::milliseconds baseDelay{1000};
+    std::chrono::milliseconds maxDelay{10000};
+    // Shared by every call to one service; null means retries are unbudgeted.
+    RetryBudget* budget = nullptr;
+    // Where retries are counted; null means they aren't.
+    RetryMetrics* metrics = nullptr;
+};
+
+// Result (or exception) of an asynchronous operation; exactly one of the
+// two is meaningful.
+template <typename T>
+using AsyncCompletion = std::function<void(std::exception_ptr error, T value)>;
+
+// Completes `done` with what `produce` returns or throws. The value is
+// constructed in place and moved on, never assigned, so a pmr container
+// keeps the memory resource `produce` built it with. `done` runs outside
+// the try: what it throws is not mistaken for a failed `produce`.
+template <typename T, typename Produce>
+void completeFrom(const AsyncCompletion<T>& done, Produce&& produce) {
+    std::optional<T> result;
+    std::exception_ptr error;
+    try {
+        result.emplace(produce());
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (error) return done(error, T{});
+    done(nullptr, std::move(*result));
+}
+
+namespace retry_detail {
+
+// What a failed try tells us about trying again.
+struct Failure {
+    std::string message;
+    std::string reason; // short form for logs, without the response body
+    bool retryable = false;
+    bool refused = false; // ServiceUnavailable: shed locally
+    std::optional<std::chrono::milliseconds> retryAfter;
+};
+
+// Only UpstreamErrors that say so are retried; parse errors, open circuits,
+// full bulkheads and anything untyped fail at once.
+inline Failure classify(std::exception_ptr error) {
+    Failure failure;
+    try {
+        std::rethrow_exception(error);
+    } catch (const HttpError& e) {
+        failure.message = e.what();
+        failure.reason = "HTTP " + std::to_string(e.status());
+        failure.retryable = e.retryable();
+        failure.retryAfter = e.retryAfter();
+    } catch (const UpstreamError& e) {
+        failure.message = e.what();
+        failure.reason = e.what();
+        failure.retryable = e.retryable();
+    } catch (const ServiceUnavailable& e) {
+        failure.message = e.what();
+        failure.reason = e.what();
+        failure.refused = true;
+    } catch (const std::exception& e) {
+        failure.message = e.what();
+        failure.reason = e.what();
+    } catch (...) {
+        failure.message = "unknown error";
+        failure.reason = failure.message;
+    }
+    return failure;
+}
+
+inline std::chrono::milliseconds backoffCeiling(const RetryPolicy& policy, int attempt) {
+    auto ceiling = policy.baseDelay;
+    for (int i = 0; i < attempt && ceiling < policy.maxDelay; ++i) ceiling *= 2;
+    return std::min(ceiling, policy.maxDelay);
+}
+
+inline std::chrono::milliseconds backoff(const RetryPolicy& policy, int attempt) {
+    thread_local std::mt19937_64 rng{std::random_device{}()};
+    std::uniform_int_distribution<int64_t> jitter(0, backoffCeiling(policy, attempt).count());
+    return std::chrono::milliseconds(jitter(rng));
+}
+
+inline void countRetry(const std::string& errorPrefix, const RetryPolicy& policy, int attempt,
+                       const Failure& failure, std::chrono::milliseconds delay) {
+    if (policy.metrics) policy.metrics->retries.inc();
+    LOG_WARN(errorPrefix, ": ", failure.reason, ", retrying in ", delay.count(), "ms (attempt ", attempt + 1, "/",
+             policy.maxRetries, ")");
+}
+
+inline void countExhausted(const RetryPolicy& policy) {
+    if (policy.metrics) policy.metrics->exhausted.inc();
+}
+
+// The error a caller finally sees: prefixed, and still a
+// ServiceUnavailable if that's what it was, so the server can answer 503.
+inline std::exception_ptr finalError(const std::string& errorPrefix, const Failure& failure) {
+    std::string message = errorPrefix + ": " + failure.message;
+    if (failure.refused) return std::make_exception_ptr(ServiceUnavailable(message));
+    return std::make_exception_ptr(std::runtime_error(message));
+}
+
+// The wait before retrying after try `attempt` (0-based) failed, or
+// nullopt to give up and report `failure`.
+inline std::optional<std::chrono::milliseconds> nextDelay(const std::string& errorPrefix, const RetryPolicy& policy,
+                                                          int attempt, const Failure& failure) {
+    if (!failure.retryable) return std::nullopt;
+    if (attempt + 1 >= policy.maxRetries) {
+        countExhausted(policy);
+        return std::nullopt;
+    }
+    auto delay = failure.retryAfter ? *failure.retryAfter : backoff(policy, attempt);
+    if (delay > policy.maxDelay) {
+        LOG_WARN(errorPrefix, ": ", failure.reason, ", upstream asked for ", delay.count(),
+                 "ms before retrying; over the ", policy.maxDelay.count(), "ms limit, giving up");
+        return std::nullopt;
+    }
+    if (policy.budget && !policy.budget->tryRetry()) {
+        LOG_WARN(errorPrefix, ": ", failure.reason, ", retry budget exhausted, giving up");
+        return std::nullopt;
+    }
+    countRetry(errorPrefix, policy, attempt, failure, delay);
+    return delay;
+}
+
+// One retryAsync call: tries, and the timer entries between them, each
+// hold a reference until the operation completes.
 template <typename T>
-T retryWithBackoff(const std::string& errorPrefix, std::function<T()> fn, int maxRetries = 3) {
-    for (int attempt = 0; attempt < maxRetries; ++attempt) {
+struct AsyncRetry : std::enable_shared_from_this<AsyncRetry<T>> {
+    std::string errorPrefix;
+    std::function<void(AsyncCompletion<T>)> attempt;
+    AsyncCompletion<T> done;
+    RetryPolicy policy;
+    TimerQueue* timers = nullptr;
+    int tries = 0;
+
+    void start() {
+        auto self = this->shared_from_this();
+        ++tries;
+        try {
+            attempt([self](std::exception_ptr error, T value) { self->finished(error, std::move(value)); });
+        } catch (...) {
+            finished(std::current_exception(), T{});
+        }
+    }
+
+    void finished(std::exception_ptr error, T value) {
+        if (!error) {
+            done(nullptr, std::move(value));
+            return;
+        }
+        Failure failure = classify(error);
+        if (auto delay = nextDelay(errorPrefix, policy, tries - 1, failure)) {
+            auto self = this->shared_from_this();
+            timers->schedule(*delay, [self] { self->start(); });
+            return;
+        }
+        done(finalError(errorPrefix, failure), T{});
+    }
+};
+
+} // namespace retry_detail
+
+// Calls `fn` up to policy.maxRetries times, retrying failures that
+// classify() deems retryable (typed UpstreamErrors: overload, rate limits,
+// gateway errors, timeouts, dropped connections) while the policy's budget
+// allows. Anything else propagates at once. The final error is rethrown
+// prefixed with `errorPrefix`, as a ServiceUnavailable if it was one and a
+// runtime_error otherwise.
+//
+// The calling thread sleeps through each backoff, so this is for the CLI
+// only; everything the server runs, background refreshes included, uses
+// retryAsync instead.
+template <typename T>
+T retryWithBackoff(const std::string& errorPrefix, std::function<T()> fn, const RetryPolicy& policy = {}) {
+    if (policy.budget) policy.budget->recordRequest();
+    for (int attempt = 0;; ++attempt) {
         try {
             return fn();
-        } catch (const std::exception& e) {
-            std::string msg = e.what();
-            bool retryable = msg.find("HTTP error 503") != std::string::npos;
-            if (retryable && attempt < maxRetries - 1) {
-                int delaySeconds = 2 * (attempt + 1);
-                Logger::warn(errorPrefix + ": service overloaded (503), retrying in " +
-                             std::to_string(delaySeconds) + "s (attempt " +
-                             std::to_string(attempt + 1) + "/" + std::to_string(maxRetries) + ")");
-                std::this_thread::sleep_for(std::chrono::seconds(delaySeconds));
-                continue;
-            }
-            throw std::runtime_error(errorPrefix + ": " + msg);
+        } catch (const std::exception&) {
+            auto failure = retry_detail::classify(std::current_exception());
+            auto delay = retry_detail::nextDelay(errorPrefix, policy, attempt, failure);
+            if (!delay) std::rethrow_exception(retry_detail::finalError(errorPrefix, failure));
+            std::this_thread::sleep_for(*delay);
         }
     }
-    throw std::runtime_error(errorPrefix + ": exhausted retries");
+}
+
+// Asynchronous twin of retryWithBackoff, with the same retry rules:
+// `attempt` starts one try and reports it through the completion it is
+// handed (throwing counts as a failed try); `done` receives the first
+// success or the final, prefixed error. Backoff waits are TimerQueue
+// entries, so no thread is held between tries.
+//
+// The first try starts on the calling thread, later ones on the timer
+// thread: `attempt` should only start work (an HttpEngine request, a post
+// to an executor), not do it.
+template <typename T>
+void retryAsync(std::string errorPrefix, std::function<void(AsyncCompletion<T>)> attempt, AsyncCompletion<T> done,
+                RetryPolicy policy = {}, TimerQueue& timers = TimerQueue::instance()) {
+    auto retry = std::make_shared<retry_detail::AsyncRetry<T>>();
+    retry->errorPrefix = std::move(errorPrefix);
+    retry->attempt = std::move(attempt);
+    retry->done = std::move(done);
+    retry->policy = policy;
+    retry->timers = &timers;
+    if (policy.budget) policy.budget->recordRequest();
+    retry->start();
 }
 
 #endif // RETRY_HPP
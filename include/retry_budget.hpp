@@ -0,0 +1,49 @@
+#ifndef RETRY_BUDGET_HPP
+#define RETRY_BUDGET_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "metrics.hpp"
+
+// Caps retries at a fraction of a service's traffic, so that when the
+// upstream is down retries add roughly `ratio` extra load instead of
+// multiplying it by maxRetries. A token bucket: every first try deposits
+// `ratio` of a token, every retry spends a whole one, and with the bucket
+// empty a failure is returned as-is. The bucket starts full, so a quiet
+// service can still retry a short burst of `capacity` calls.
+//
+// Lock-free: the balance is one atomic, in thousandths of a token.
+class RetryBudget {
+public:
+    struct Config {
+        double ratio = 0.1;
+        double capacity = 10;
+    };
+
+    explicit RetryBudget(const std::string& service);
+    RetryBudget(const std::string& service, const Config& config);
+
+    RetryBudget(const RetryBudget&) = delete;
+    RetryBudget& operator=(const RetryBudget&) = delete;
+
+    // The process-wide budget for `service`, created with the default
+    // Config on first use. The reference stays valid for the process.
+    static RetryBudget& forService(const std::string& service);
+
+    // A first try went out.
+    void recordRequest();
+    // Spends a token for one retry; false if the budget is exhausted.
+    bool tryRetry();
+
+    double tokens() const;
+
+private:
+    const int64_t deposit_;
+    const int64_t capacity_;
+    std::atomic<int64_t> balance_;
+    // travelplanner_retry_budget_exhausted_total{service=...}
+    Counter& exhausted_;
+};
+
+#endif // RETRY_BUDGET_HPP
@@ -0,0 +1,201 @@
+#ifndef SHARDED_CACHE_HPP
+#define SHARDED_CACHE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Thread-safe in-memory cache shared by Crow's worker threads.
+//
+// Keys are spread over independently locked shards so concurrent lookups
+// for different keys rarely contend. Each shard keeps its entries in LRU
+// order and evicts from the cold end once it exceeds its slice of the byte
+// budget, so memory stays bounded on a busy server. Entries carry their
+// own TTL; an expired entry is dropped the next time it is looked up.
+template <typename K, typename V,
+          typename Hash = std::hash<K>,
+          typename Clock = std::chrono::steady_clock>
+class ShardedCache {
+public:
+    using Duration = typename Clock::duration;
+    using TimePoint = typename Clock::time_point;
+
+    // Approximate heap footprint of one entry, used against the budget.
+    using Sizer = std::function<size_t(const K&, const V&)>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;   // dropped to stay within the byte budget
+        uint64_t expirations = 0; // dropped because their TTL had passed
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    // Pass Duration::max() as the TTL for entries that never expire.
+    static constexpr Duration noExpiry = Duration::max();
+
+    explicit ShardedCache(size_t byteBudget,
+                          Duration defaultTtl = noExpiry,
+                          size_t shardCount = 16,
+                          Sizer sizer = defaultSizer)
+        : shards_(shardCount == 0 ? 1 : shardCount),
+          shardBudget_(byteBudget / (shardCount == 0 ? 1 : shardCount)),
+          defaultTtl_(defaultTtl),
+          sizer_(std::move(sizer)) {}
+
+    ShardedCache(const ShardedCache&) = delete;
+    ShardedCache& operator=(const ShardedCache&) = delete;
+
+    // Returns a copy of the cached value, refreshing its LRU position.
+    std::optional<V> get(const K& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            ++shard.misses;
+            return std::nullopt;
+        }
+        if (Clock::now() >= it->second->expiresAt) {
+            shard.remove(it->second);
+            ++shard.expirations;
+            ++shard.misses;
+            return std::nullopt;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        ++shard.hits;
+        return it->second->value;
+    }
+
+    void put(const K& key, V value) { put(key, std::move(value), defaultTtl_); }
+
+    void put(const K& key, V value, Duration ttl) {
+        size_t bytes = sizer_(key, value);
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto existing = shard.index.find(key);
+        if (existing != shard.index.end()) shard.remove(existing->second);
+
+        // An entry bigger than the whole shard would only evict everything
+        // else and then itself; don't cache it at all.
+        if (bytes > shardBudget_) {
+            ++shard.evictions;
+            return;
+        }
+
+        shard.lru.push_front(Entry{key, std::move(value), expiryFor(ttl), bytes});
+        shard.index.emplace(key, shard.lru.begin());
+        shard.bytes += bytes;
+
+        while (shard.bytes > shardBudget_ && !shard.lru.empty()) {
+            shard.remove(std::prev(shard.lru.end()));
+            ++shard.evictions;
+        }
+    }
+
+    bool erase(const K& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) return false;
+        shard.remove(it->second);
+        return true;
+    }
+
+    void clear() {
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.lru.clear();
+            shard.index.clear();
+            shard.bytes = 0;
+        }
+    }
+
+    Stats stats() const {
+        Stats total;
+        for (const Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total.hits += shard.hits;
+            total.misses += shard.misses;
+            total.evictions += shard.evictions;
+            total.expirations += shard.expirations;
+            total.entries += shard.index.size();
+            total.bytes += shard.bytes;
+        }
+        return total;
+    }
+
+    // Strings count their capacity; anything else its object size. Types
+    // with significant heap state (e.g. JSON) should pass their own Sizer.
+    static size_t defaultSizer(const K& key, const V& value) {
+        return entryOverhead + footprint(key) + footprint(value);
+    }
+
+private:
+    // List node + hash node + index pointers, roughly.
+    static constexpr size_t entryOverhead = 64;
+
+    template <typename T>
+    static size_t footprint(const T& value) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return sizeof(T) + value.capacity();
+        } else {
+            return sizeof(T);
+        }
+    }
+
+    struct Entry {
+        K key;
+        V value;
+        TimePoint expiresAt;
+        size_t bytes;
+    };
+
+    // Own cache line per shard so one shard's lock traffic doesn't slow
+    // its neighbours.
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru; // most recently used first
+        std::unordered_map<K, typename std::list<Entry>::iterator, Hash> index;
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+
+        void remove(typename std::list<Entry>::iterator it) {
+            bytes -= it->bytes;
+            index.erase(it->key);
+            lru.erase(it);
+        }
+    };
+
+    Shard& shardFor(const K& key) {
+        size_t h = Hash{}(key);
+        // Fold high bits in: std::hash for integers is often the identity.
+        h ^= h >> 16;
+        return shards_[h % shards_.size()];
+    }
+
+    TimePoint expiryFor(Duration ttl) const {
+        TimePoint now = Clock::now();
+        if (ttl >= TimePoint::max() - now) return TimePoint::max();
+        return now + ttl;
+    }
+
+    std::vector<Shard> shards_;
+    size_t shardBudget_;
+    Duration defaultTtl_;
+    Sizer sizer_;
+};
+
+#endif // SHARDED_CACHE_HPP
@@ -0,0 +1,141 @@
+#ifndef SINGLE_FLIGHT_HPP
+#define SINGLE_FLIGHT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "tracing.hpp"
+
+// Request coalescing. When several threads ask for the same key at once -
+// a burst of identical /flights queries, say - only the first actually
+// runs the upstream call; the rest wait for and share its result (or its
+// exception). Nothing is cached: once the call completes, the next caller
+// for that key starts a fresh one.
+//
+// run() waits on the calling thread; runAsync() hands the result to a
+// callback instead, so joining a call in flight holds no thread. The two
+// coalesce with each other.
+//
+// Waiters in run() get a "single_flight.wait" span linking to the leader's
+// span, so a trace that coalesced can still be followed to the call that
+// served it.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class SingleFlight {
+public:
+    using Callback = std::function<void(std::exception_ptr error, V value)>;
+
+    V run(const K& key, const std::function<V()>& fn) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto existing = calls_.find(key);
+        if (existing != calls_.end()) {
+            std::shared_future<V> result = existing->second.result;
+            SpanContext leader = existing->second.leader;
+            lock.unlock();
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+            Span wait("single_flight.wait");
+            if (leader) {
+                wait.set("leader_trace_id", Tracer::toHex(leader.traceId));
+                wait.set("leader_span_id", Tracer::toHex(leader.spanId));
+            }
+            return result.get();
+        }
+
+        std::promise<V> promise;
+        uint64_t id = ++lastId_;
+        calls_.emplace(key, Call{id, promise.get_future().share(), Tracer::current(), {}});
+        lock.unlock();
+
+        // Settled outside the try: a joined callback that throws must not
+        // settle the call a second time.
+        std::optional<V> value;
+        std::exception_ptr error;
+        try {
+            value.emplace(fn());
+        } catch (...) {
+            error = std::current_exception();
+        }
+        if (error) {
+            settle(key, id, promise, error, V{});
+            std::rethrow_exception(error);
+        }
+        settle(key, id, promise, nullptr, *value);
+        return std::move(*value);
+    }
+
+    // `start` begins the call and reports through the callback it is
+    // handed (throwing counts as a failure); `done` receives the result.
+    // A caller that joins a call in flight returns at once and has `done`
+    // invoked wherever the leader completes. Only the first report counts;
+    // if `start` throws after reporting (or `done` throws from inside it),
+    // the exception propagates to the caller.
+    void runAsync(const K& key, const std::function<void(Callback)>& start, Callback done) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto existing = calls_.find(key);
+        if (existing != calls_.end()) {
+            existing->second.waiters.push_back(std::move(done));
+            lock.unlock();
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        auto promise = std::make_shared<std::promise<V>>();
+        uint64_t id = ++lastId_;
+        calls_.emplace(key, Call{id, promise->get_future().share(), Tracer::current(), {}});
+        lock.unlock();
+
+        auto reported = std::make_shared<std::atomic<bool>>(false);
+        Callback finish = [this, key, id, promise, reported, done = std::move(done)](std::exception_ptr error,
+                                                                                    V value) {
+            if (reported->exchange(true)) return;
+            settle(key, id, *promise, error, value);
+            done(error, std::move(value));
+        };
+        try {
+            start(finish);
+        } catch (...) {
+            if (reported->load()) throw;
+            finish(std::current_exception(), V{});
+        }
+    }
+
+    // Callers that piggybacked on another caller's in-flight call.
+    uint64_t coalesced() const { return coalesced_.load(std::memory_order_relaxed); }
+
+private:
+    struct Call {
+        uint64_t id; // tells this call from a later one for the same key
+        std::shared_future<V> result;
+        SpanContext leader;
+        std::vector<Callback> waiters; // runAsync callers that joined
+    };
+
+    // Forgets call `id`, then releases everyone waiting on it. The entry
+    // under `key` is only removed if it is still that call.
+    void settle(const K& key, uint64_t id, std::promise<V>& promise, std::exception_ptr error, const V& value) {
+        std::vector<Callback> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = calls_.find(key);
+            if (it != calls_.end() && it->second.id == id) {
+                waiters = std::move(it->second.waiters);
+                calls_.erase(it);
+            }
+        }
+        if (error) promise.set_exception(error);
+        else promise.set_value(value);
+        for (auto& waiter : waiters) waiter(error, value);
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<K, Call, Hash> calls_;
+    uint64_t lastId_ = 0; // guarded by mutex_
+    std::atomic<uint64_t> coalesced_{0};
+};
+
+#endif // SINGLE_FLIGHT_HPP
@@ -0,0 +1,58 @@
+#ifndef TIMER_QUEUE_HPP
+#define TIMER_QUEUE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Deferred callbacks on one shared thread. Waiting out a retry backoff or
+// a queue timeout becomes a heap entry instead of a thread parked in
+// sleep_for, so a brownout that sends every request into backoff costs no
+// worker capacity.
+//
+// Callbacks run on the timer thread, in deadline order; they must be short
+// (start an HTTP request, post to an executor) or they delay every timer
+// behind them. Callbacks still pending at destruction are dropped.
+class TimerQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static TimerQueue& instance();
+
+    TimerQueue();
+    ~TimerQueue();
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    // Runs `fn` once `delay` has passed.
+    void schedule(Clock::duration delay, std::function<void()> fn);
+
+    // Callbacks scheduled but not yet run.
+    size_t pending() const;
+
+private:
+    struct Entry {
+        Clock::time_point due;
+        uint64_t seq; // keeps equal deadlines in scheduling order
+        std::function<void()> fn;
+    };
+    // Heap order: earliest deadline on top.
+    static bool later(const Entry& a, const Entry& b) {
+        return a.due != b.due ? a.due > b.due : a.seq > b.seq;
+    }
+
+    void run();
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<Entry> heap_;
+    uint64_t nextSeq_ = 0;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+#endif // TIMER_QUEUE_HPP
@@ -0,0 +1,135 @@
+#ifndef TRACING_HPP
+#define TRACING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Lightweight request tracing. A Span times one unit of work and becomes
+// the current span of its thread until it ends, so spans opened beneath it
+// (APIHandler -> FlightProvider -> HTTP call) pick it up as their parent
+// automatically. Work that hops threads (std::async, executors, the HTTP
+// engine) must carry the context across explicitly: capture
+// Tracer::current() before the hop and adopt it with ScopedSpanContext on
+// the other side.
+//
+// Completed spans are appended as JSON lines to TRACE_FILE. With no file
+// configured, tracing is off and a Span costs one relaxed atomic load.
+struct SpanContext {
+    uint64_t traceId = 0;
+    uint64_t spanId = 0;
+
+    explicit operator bool() const { return traceId != 0; }
+};
+
+// One finished span, as exported.
+struct SpanRecord {
+    SpanContext context;
+    uint64_t parentId = 0;
+    std::string name;
+    std::chrono::system_clock::time_point start;
+    std::chrono::microseconds duration{0};
+    std::vector<std::pair<std::string, std::string>> attributes;
+    bool error = false;
+};
+
+class Tracer {
+public:
+    static Tracer& instance();
+
+    // Start (or, with an empty path, stop) exporting to `path`. The
+    // TRACE_FILE environment variable is applied on first use.
+    void exportTo(const std::string& path);
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // The calling thread's current span; empty outside any span.
+    static SpanContext current();
+    static uint64_t newId();
+    static std::string toHex(uint64_t id);
+
+    // Export a span whose timing was measured elsewhere (e.g. by libcurl).
+    void record(const SpanRecord& span);
+    void flush();
+
+private:
+    Tracer();
+
+    std::atomic<bool> enabled_{false};
+    std::mutex mutex_;
+    FILE* out_ = nullptr;
+};
+
+class Span {
+public:
+    // Child of the thread's current span, or the root of a new trace.
+    explicit Span(std::string name);
+    // Child of an explicitly captured context.
+    Span(std::string name, SpanContext parent);
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    void set(std::string key, std::string value);
+    void markError() { record_.error = true; }
+
+    // Empty when tracing is off.
+    SpanContext context() const { return record_.context; }
+
+private:
+    bool active_ = false;
+    int uncaughtAtStart_ = 0;
+    SpanContext previous_;
+    std::chrono::steady_clock::time_point startedAt_;
+    SpanRecord record_;
+};
+
+// A span for work that finishes through a callback, possibly on another
+// thread. Unlike Span it never becomes a thread's current span: adopt
+// context() with ScopedSpanContext wherever children should hang off it,
+// and end() it when the work reports back. Share it (shared_ptr) with the
+// callbacks; one dropped without end() is recorded as an error.
+class AsyncSpan {
+public:
+    // Child of the calling thread's current span, or the root of a new trace.
+    explicit AsyncSpan(std::string name);
+    ~AsyncSpan();
+
+    AsyncSpan(const AsyncSpan&) = delete;
+    AsyncSpan& operator=(const AsyncSpan&) = delete;
+
+    // Before the work is handed off only: set() is not synchronized.
+    void set(std::string key, std::string value);
+    // Records the span; later calls do nothing.
+    void end(bool error = false);
+
+    // Where children belong: this span, or while tracing is off the
+    // caller's context, so adopting it changes nothing.
+    SpanContext context() const { return record_.context; }
+
+private:
+    bool active_ = false;
+    std::atomic<bool> ended_{false};
+    std::chrono::steady_clock::time_point startedAt_;
+    SpanRecord record_;
+};
+
+// Makes `context` the current span context for a scope on another thread.
+class ScopedSpanContext {
+public:
+    explicit ScopedSpanContext(SpanContext context);
+    ~ScopedSpanContext();
+
+    ScopedSpanContext(const ScopedSpanContext&) = delete;
+    ScopedSpanContext& operator=(const ScopedSpanContext&) = delete;
+
+private:
+    SpanContext previous_;
+};
+
+#endif // TRACING_HPP
@@ -0,0 +1,74 @@
+#ifndef UPSTREAM_ERROR_HPP
+#define UPSTREAM_ERROR_HPP
+
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// A failed upstream call, typed so retry decisions look at what went wrong
+// rather than at what() text. Messages keep their established shape
+// ("HTTP error <code>: <body>", "Curl failed: <reason>") for logs and for
+// the error bodies the server returns.
+class UpstreamError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+
+    // Worth another try: the upstream was busy or unreachable, not wrong.
+    virtual bool retryable() const = 0;
+};
+
+// The upstream answered with a 4xx/5xx status.
+class HttpError : public UpstreamError {
+public:
+    HttpError(int status, std::string body, std::optional<std::chrono::milliseconds> retryAfter = std::nullopt);
+
+    int status() const { return status_; }
+    const std::string& body() const { return body_; }
+    // How long the upstream asked us to wait (Retry-After), if it said.
+    std::optional<std::chrono::milliseconds> retryAfter() const { return retryAfter_; }
+
+    // 408, 429, 502, 503 and 504: overload, rate limiting and gateway
+    // trouble. Everything else is the request's fault or a hard failure.
+    bool retryable() const override;
+
+private:
+    int status_;
+    std::string body_;
+    std::optional<std::chrono::milliseconds> retryAfter_;
+};
+
+// The call never produced a response.
+class TransportError : public UpstreamError {
+public:
+    enum class Kind {
+        Timeout,     // gave up waiting
+        Connection,  // couldn't resolve, connect, or the connection dropped
+        Other,       // local or protocol failure; repeating won't help
+    };
+
+    TransportError(Kind kind, const std::string& reason);
+
+    Kind kind() const { return kind_; }
+    bool retryable() const override { return kind_ != Kind::Other; }
+
+private:
+    Kind kind_;
+};
+
+// The call was refused locally, without reaching the upstream: its
+// circuit is open or its bulkhead is full. Clients get a 503, and it is
+// never retried - shedding this load is the point.
+class ServiceUnavailable : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Parses a Retry-After value: delay-seconds ("120") or an IMF-fixdate
+// ("Wed, 21 Oct 2015 07:28:00 GMT"), the latter relative to `now`. A date
+// in the past means "now" (zero). Anything else is nullopt.
+std::optional<std::chrono::milliseconds> parseRetryAfter(
+    std::string_view value, std::chrono::system_clock::time_point now = std::chrono::system_clock::now());
+
+#endif // UPSTREAM_ERROR_HPP
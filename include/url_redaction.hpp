@@ -0,0 +1,12 @@
+#ifndef URL_REDACTION_HPP
+#define URL_REDACTION_HPP
+
+#include <string>
+
+// "https://host/v1/forecast.json?key=SECRET&q=Goa" -> "host/v1/forecast.json".
+// Upstream API keys travel in query strings (Gemini, WeatherAPI) and,
+// potentially, in userinfo; both are dropped, as is the fragment, so the
+// result is safe to put in logs and traces.
+std::string redactUrlForLog(const std::string& url);
+
+#endif // URL_REDACTION_HPP
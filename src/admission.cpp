@@ -0,0 +1,25 @@
+#include "admission.hpp"
+#include <utility>
+
+Admission admit(const std::string& service, Bulkhead& bulkhead, CircuitBreaker& breaker) {
+    Bulkhead::Permit permit = bulkhead.acquire(service);
+    // If the circuit refuses, the permit goes out of scope and frees the slot.
+    CircuitBreaker::Ticket ticket = breaker.checkAllowed(service);
+    return Admission{std::move(permit), ticket};
+}
+
+void admitAsync(const std::string& service, std::function<void(std::exception_ptr, Admission)> done,
+                Bulkhead& bulkhead, CircuitBreaker& breaker) {
+    bulkhead.acquireAsync(service, [service, &breaker, done = std::move(done)](std::exception_ptr refused,
+                                                                               Bulkhead::Permit permit) {
+        if (refused) return done(refused, Admission{});
+        CircuitBreaker::Ticket ticket;
+        try {
+            ticket = breaker.checkAllowed(service);
+        } catch (...) {
+            permit.release();
+            return done(std::current_exception(), Admission{});
+        }
+        done(nullptr, Admission{std::move(permit), ticket});
+    });
+}
@@ -0,0 +1,386 @@
+#include "airport_table.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+namespace AirportTable {
+
+namespace {
+
+struct Airport {
+    std::string_view city; // normalized: lower case, single spaces
+    std::string_view iata;
+};
+
+// Main commercial airport per city, plus common alternative names. Keep the
+// entries sorted by `city` (byte order) - lookup binary-searches them and
+// the static_assert below rejects an unsorted table at compile time.
+constexpr Airport airports[] = {
+    {"abu dhabi", "AUH"},
+    {"abuja", "ABV"},
+    {"accra", "ACC"},
+    {"addis ababa", "ADD"},
+    {"adelaide", "ADL"},
+    {"agartala", "IXA"},
+    {"agra", "AGR"},
+    {"ahmedabad", "AMD"},
+    {"aizawl", "AJL"},
+    {"algiers", "ALG"},
+    {"allahabad", "IXD"},
+    {"amman", "AMM"},
+    {"amritsar", "ATQ"},
+    {"amsterdam", "AMS"},
+    {"anchorage", "ANC"},
+    {"ankara", "ESB"},
+    {"antalya", "AYT"},
+    {"athens", "ATH"},
+    {"atlanta", "ATL"},
+    {"auckland", "AKL"},
+    {"aurangabad", "IXU"},
+    {"austin", "AUS"},
+    {"bagdogra", "IXB"},
+    {"bahrain", "BAH"},
+    {"bali", "DPS"},
+    {"bangalore", "BLR"},
+    {"bangkok", "BKK"},
+    {"barcelona", "BCN"},
+    {"baroda", "BDQ"},
+    {"beijing", "PEK"},
+    {"beirut", "BEY"},
+    {"belagavi", "IXG"},
+    {"belgaum", "IXG"},
+    {"belgrade", "BEG"},
+    {"bengaluru", "BLR"},
+    {"bergen", "BGO"},
+    {"berlin", "BER"},
+    {"bhopal", "BHO"},
+    {"bhubaneswar", "BBI"},
+    {"birmingham", "BHX"},
+    {"bogota", "BOG"},
+    {"bogotá", "BOG"},
+    {"bombay", "BOM"},
+    {"boston", "BOS"},
+    {"brisbane", "BNE"},
+    {"brussels", "BRU"},
+    {"bucharest", "OTP"},
+    {"budapest", "BUD"},
+    {"buenos aires", "EZE"},
+    {"busan", "PUS"},
+    {"cairns", "CNS"},
+    {"cairo", "CAI"},
+    {"calcutta", "CCU"},
+    {"calgary", "YYC"},
+    {"calicut", "CCJ"},
+    {"cancun", "CUN"},
+    {"cape town", "CPT"},
+    {"caracas", "CCS"},
+    {"casablanca", "CMN"},
+    {"cebu", "CEB"},
+    {"chandigarh", "IXC"},
+    {"charlotte", "CLT"},
+    {"chennai", "MAA"},
+    {"chiang mai", "CNX"},
+    {"chicago", "ORD"},
+    {"christchurch", "CHC"},
+    {"cochin", "COK"},
+    {"coimbatore", "CJB"},
+    {"cologne", "CGN"},
+    {"colombo", "CMB"},
+    {"copenhagen", "CPH"},
+    {"cusco", "CUZ"},
+    {"da nang", "DAD"},
+    {"dakar", "DSS"},
+    {"dallas", "DFW"},
+    {"dammam", "DMM"},
+    {"dar es salaam", "DAR"},
+    {"darjeeling", "IXB"},
+    {"dehradun", "DED"},
+    {"delhi", "DEL"},
+    {"denpasar", "DPS"},
+    {"denver", "DEN"},
+    {"detroit", "DTW"},
+    {"dhaka", "DAC"},
+    {"dharamshala", "DHM"},
+    {"dibrugarh", "DIB"},
+    {"dimapur", "DMU"},
+    {"doha", "DOH"},
+    {"dubai", "DXB"},
+    {"dublin", "DUB"},
+    {"dubrovnik", "DBV"},
+    {"durban", "DUR"},
+    {"dusseldorf", "DUS"},
+    {"düsseldorf", "DUS"},
+    {"edinburgh", "EDI"},
+    {"edmonton", "YEG"},
+    {"entebbe", "EBB"},
+    {"ernakulam", "COK"},
+    {"fiji", "NAN"},
+    {"florence", "FLR"},
+    {"frankfurt", "FRA"},
+    {"fukuoka", "FUK"},
+    {"gaya", "GAY"},
+    {"geneva", "GVA"},
+    {"glasgow", "GLA"},
+    {"goa", "GOI"},
+    {"gold coast", "OOL"},
+    {"gorakhpur", "GOP"},
+    {"guadalajara", "GDL"},
+    {"guangzhou", "CAN"},
+    {"guwahati", "GAU"},
+    {"gwalior", "GWL"},
+    {"hamburg", "HAM"},
+    {"hanoi", "HAN"},
+    {"harare", "HRE"},
+    {"havana", "HAV"},
+    {"helsinki", "HEL"},
+    {"ho chi minh city", "SGN"},
+    {"hong kong", "HKG"},
+    {"honolulu", "HNL"},
+    {"houston", "IAH"},
+    {"hubli", "HBX"},
+    {"hyderabad", "HYD"},
+    {"imphal", "IMF"},
+    {"indore", "IDR"},
+    {"islamabad", "ISB"},
+    {"istanbul", "IST"},
+    {"jabalpur", "JLR"},
+    {"jaipur", "JAI"},
+    {"jakarta", "CGK"},
+    {"jammu", "IXJ"},
+    {"jeddah", "JED"},
+    {"jodhpur", "JDH"},
+    {"johannesburg", "JNB"},
+    {"jorhat", "JRH"},
+    {"kampala", "EBB"},
+    {"kangra", "DHM"},
+    {"karachi", "KHI"},
+    {"kathmandu", "KTM"},
+    {"kiev", "KBP"},
+    {"kigali", "KGL"},
+    {"kilimanjaro", "JRO"},
+    {"kochi", "COK"},
+    {"kolkata", "CCU"},
+    {"kozhikode", "CCJ"},
+    {"krakow", "KRK"},
+    {"kraków", "KRK"},
+    {"kuala lumpur", "KUL"},
+    {"kullu", "KUU"},
+    {"kuwait", "KWI"},
+    {"kuwait city", "KWI"},
+    {"kyiv", "KBP"},
+    {"lagos", "LOS"},
+    {"lahore", "LHE"},
+    {"langkawi", "LGK"},
+    {"larnaca", "LCA"},
+    {"las vegas", "LAS"},
+    {"leh", "IXL"},
+    {"lima", "LIM"},
+    {"lisbon", "LIS"},
+    {"london", "LHR"},
+    {"los angeles", "LAX"},
+    {"lucknow", "LKO"},
+    {"lusaka", "LUN"},
+    {"luxembourg", "LUX"},
+    {"lyon", "LYS"},
+    {"macau", "MFM"},
+    {"madras", "MAA"},
+    {"madrid", "MAD"},
+    {"madurai", "IXM"},
+    {"malaga", "AGP"},
+    {"maldives", "MLE"},
+    {"male", "MLE"},
+    {"mallorca", "PMI"},
+    {"malta", "MLA"},
+    {"manali", "KUU"},
+    {"manama", "BAH"},
+    {"manchester", "MAN"},
+    {"mangalore", "IXE"},
+    {"mangaluru", "IXE"},
+    {"manila", "MNL"},
+    {"marrakech", "RAK"},
+    {"marrakesh", "RAK"},
+    {"marseille", "MRS"},
+    {"mauritius", "MRU"},
+    {"medellin", "MDE"},
+    {"medellín", "MDE"},
+    {"melbourne", "MEL"},
+    {"mexico city", "MEX"},
+    {"miami", "MIA"},
+    {"milan", "MXP"},
+    {"minneapolis", "MSP"},
+    {"montevideo", "MVD"},
+    {"montreal", "YUL"},
+    {"moscow", "SVO"},
+    {"mumbai", "BOM"},
+    {"munich", "MUC"},
+    {"muscat", "MCT"},
+    {"mykonos", "JMK"},
+    {"mysore", "MYQ"},
+    {"mysuru", "MYQ"},
+    {"málaga", "AGP"},
+    {"nadi", "NAN"},
+    {"nagoya", "NGO"},
+    {"nagpur", "NAG"},
+    {"nairobi", "NBO"},
+    {"naples", "NAP"},
+    {"nashville", "BNA"},
+    {"new delhi", "DEL"},
+    {"new orleans", "MSY"},
+    {"new york", "JFK"},
+    {"new york city", "JFK"},
+    {"newark", "EWR"},
+    {"nice", "NCE"},
+    {"orlando", "MCO"},
+    {"osaka", "KIX"},
+    {"oslo", "OSL"},
+    {"ottawa", "YOW"},
+    {"palma", "PMI"},
+    {"panaji", "GOI"},
+    {"panama city", "PTY"},
+    {"paris", "CDG"},
+    {"paro", "PBH"},
+    {"patna", "PAT"},
+    {"penang", "PEN"},
+    {"perth", "PER"},
+    {"philadelphia", "PHL"},
+    {"phoenix", "PHX"},
+    {"phuket", "HKT"},
+    {"pondicherry", "PNY"},
+    {"port blair", "IXZ"},
+    {"port louis", "MRU"},
+    {"portland", "PDX"},
+    {"porto", "OPO"},
+    {"prague", "PRG"},
+    {"prayagraj", "IXD"},
+    {"puducherry", "PNY"},
+    {"pune", "PNQ"},
+    {"quito", "UIO"},
+    {"raipur", "RPR"},
+    {"ranchi", "IXR"},
+    {"reykjavik", "KEF"},
+    {"reykjavík", "KEF"},
+    {"riga", "RIX"},
+    {"rio de janeiro", "GIG"},
+    {"riyadh", "RUH"},
+    {"rome", "FCO"},
+    {"saigon", "SGN"},
+    {"saint petersburg", "LED"},
+    {"salt lake city", "SLC"},
+    {"san diego", "SAN"},
+    {"san francisco", "SFO"},
+    {"santiago", "SCL"},
+    {"santorini", "JTR"},
+    {"sao paulo", "GRU"},
+    {"sapporo", "CTS"},
+    {"seattle", "SEA"},
+    {"seoul", "ICN"},
+    {"seville", "SVQ"},
+    {"seychelles", "SEZ"},
+    {"shanghai", "PVG"},
+    {"sharjah", "SHJ"},
+    {"shenzhen", "SZX"},
+    {"shillong", "SHL"},
+    {"silchar", "IXS"},
+    {"siliguri", "IXB"},
+    {"singapore", "SIN"},
+    {"sofia", "SOF"},
+    {"split", "SPU"},
+    {"srinagar", "SXR"},
+    {"st petersburg", "LED"},
+    {"stockholm", "ARN"},
+    {"stuttgart", "STR"},
+    {"surat", "STV"},
+    {"sydney", "SYD"},
+    {"são paulo", "GRU"},
+    {"taipei", "TPE"},
+    {"tallinn", "TLL"},
+    {"tehran", "IKA"},
+    {"tel aviv", "TLV"},
+    {"thiruvananthapuram", "TRV"},
+    {"tiruchirappalli", "TRZ"},
+    {"tirupati", "TIR"},
+    {"tokyo", "HND"},
+    {"toronto", "YYZ"},
+    {"trichy", "TRZ"},
+    {"trivandrum", "TRV"},
+    {"tunis", "TUN"},
+    {"udaipur", "UDR"},
+    {"vadodara", "BDQ"},
+    {"valencia", "VLC"},
+    {"vancouver", "YVR"},
+    {"varanasi", "VNS"},
+    {"venice", "VCE"},
+    {"vienna", "VIE"},
+    {"vientiane", "VTE"},
+    {"vijayawada", "VGA"},
+    {"vilnius", "VNO"},
+    {"visakhapatnam", "VTZ"},
+    {"vizag", "VTZ"},
+    {"warsaw", "WAW"},
+    {"washington", "IAD"},
+    {"washington dc", "IAD"},
+    {"wellington", "WLG"},
+    {"windhoek", "WDH"},
+    {"yangon", "RGN"},
+    {"zagreb", "ZAG"},
+    {"zanzibar", "ZNZ"},
+    {"zurich", "ZRH"},
+    {"zürich", "ZRH"},
+};
+
+constexpr bool isSorted() {
+    for (size_t i = 1; i < std::size(airports); ++i) {
+        if (!(airports[i - 1].city < airports[i].city)) return false;
+    }
+    return true;
+}
+static_assert(isSorted(), "airports[] must be sorted by city with no duplicates");
+
+// Lower-cases ASCII, trims, collapses runs of whitespace and drops a
+// trailing ", Country" so "  New   York, USA" matches "new york".
+std::string normalize(std::string_view city) {
+    city = city.substr(0, city.find(','));
+    std::string out;
+    out.reserve(city.size());
+    bool pendingSpace = false;
+    for (char c : city) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (std::isspace(u)) {
+            pendingSpace = !out.empty();
+            continue;
+        }
+        if (pendingSpace) out += ' ';
+        pendingSpace = false;
+        out += static_cast<char>(u < 0x80 ? std::tolower(u) : u);
+    }
+    return out;
+}
+
+} // namespace
+
+std::optional<std::string> lookup(std::string_view city) {
+    std::string key = normalize(city);
+
+    auto it = std::lower_bound(std::begin(airports), std::end(airports), key,
+                               [](const Airport& a, const std::string& k) { return a.city < k; });
+    if (it != std::end(airports) && it->city == key) {
+        return std::string(it->iata);
+    }
+
+    // Already an airport code, e.g. "del" or "BOM".
+    if (key.size() == 3) {
+        std::string code = key;
+        std::transform(code.begin(), code.end(), code.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        for (const Airport& a : airports) {
+            if (a.iata == code) return code;
+        }
+    }
+    return std::nullopt;
+}
+
+size_t size() {
+    return std::size(airports);
+}
+
+} // namespace AirportTable
@@ -2,20 +2,35 @@
 #define WIN32_LEAN_AND_MEAN
 #include "api_handler.hpp"
 #include "flight_parser.hpp"
+#include "gemini_parser.hpp"
 #include "flight_provider.hpp"
 #include "retry.hpp"
 #include "circuit_breaker.hpp"
+#include "bulkhead.hpp"
+#include "admission.hpp"
 #include "logger.hpp"
+#include "curl_pool.hpp"
+#include "sharded_cache.hpp"
+#include "refreshing_cache.hpp"
+#include "airport_table.hpp"
+#include "single_flight.hpp"
+#include "http_engine.hpp"
+#include "http_transfer.hpp"
+#include "metrics.hpp"
+#include "tracing.hpp"
+#include "request_cost.hpp"
+#include "fast_parse.hpp"
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <string>
 #include <algorithm>
 #include <chrono>
 #include <cstdlib>
 #include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
 #include <curl/curl.h>
-#include <iomanip>
 
 using namespace std;
 using json = nlohmann::json;
@@ -31,6 +46,11 @@ string APIHandler::WEATHER_API_KEY;
 string APIHandler::WEATHER_API_URL = "http://api.weatherapi.com/v1";
 string APIHandler::CURRENCY_CODE = "INR";
 string APIHandler::FLIGHT_PROVIDER = "auto";
+int APIHandler::FLIGHT_CACHE_TTL_SECONDS = 300;
+int APIHandler::FLIGHT_CACHE_STALE_SECONDS = 1800;
+int APIHandler::SLOW_CALL_THRESHOLD_MS = 2000;
+int APIHandler::AMADEUS_MAX_OFFERS = 10;
+int APIHandler::FLIGHT_RESULT_LIMIT = 10;
 
 namespace {
 
@@ -40,17 +60,332 @@ string getEnvOrEmpty(const char* name) {
     return value ? string(value) : string();
 }
 
+// Reads a numeric env var: nullopt when unset, and also - with a warning -
+// when the value isn't entirely a number, so a typo keeps the default
+// rather than aborting startup.
+template <typename T>
+optional<T> envNumber(const string& name) {
+    string value = getEnvOrEmpty(name.c_str());
+    if (value.empty()) return nullopt;
+    try {
+        size_t used = 0;
+        T number;
+        if constexpr (is_integral_v<T>) {
+            number = stoi(value, &used);
+        } else {
+            number = stod(value, &used);
+        }
+        if (used == value.size()) return number;
+    } catch (const exception&) {
+    }
+    LOG_WARN("Ignoring ", name, "=", value, ": not a number");
+    return nullopt;
+}
+
 // In-memory caches: IATA codes rarely change, weather is cheap to cache
-// for a short TTL to avoid re-fetching within the same session.
-unordered_map<string, string> iataCache;
-struct WeatherCacheEntry { chrono::steady_clock::time_point fetchedAt; json data; };
-unordered_map<string, WeatherCacheEntry> weatherCache;
+// for a short TTL to avoid re-fetching within the same session. Both are
+// shared by every server worker thread, so they are sharded, locked and
+// bounded rather than plain maps.
+ShardedCache<string, string> iataCache(1 << 20);
 const chrono::minutes weatherCacheTTL{30};
+// Approximate heap footprint of a JSON value: one node per value plus
+// string and key bytes. A walk with no allocation, unlike weighing the
+// entry by dump()ing it on every put.
+size_t jsonFootprint(const json& value) {
+    size_t bytes = sizeof(json);
+    if (value.is_string()) {
+        bytes += value.get_ref<const string&>().capacity();
+    } else if (value.is_object()) {
+        for (const auto& item : value.items()) bytes += 48 + item.key().size() + jsonFootprint(item.value());
+    } else if (value.is_array()) {
+        for (const auto& element : value) bytes += jsonFootprint(element);
+    }
+    return bytes;
+}
+
+ShardedCache<string, json> weatherCache(16 << 20, weatherCacheTTL, 16,
+                                        [](const string& key, const json& data) -> size_t {
+                                            return 64 + key.capacity() + jsonFootprint(data);
+                                        });
+
+// Cache counters are read from the caches' own stats when /metrics is
+// scraped, so lookups pay nothing extra for them.
+template <typename Cache>
+bool exportCacheMetrics(const string& name, const Cache& cache) {
+    auto& registry = MetricsRegistry::instance();
+    MetricLabels labels{{"cache", name}};
+    registry.counterFn("travelplanner_cache_hits_total", "Cache lookups that found a live entry", labels,
+                       [&cache] { return static_cast<double>(cache.stats().hits); });
+    registry.counterFn("travelplanner_cache_misses_total", "Cache lookups that found nothing", labels,
+                       [&cache] { return static_cast<double>(cache.stats().misses); });
+    registry.counterFn("travelplanner_cache_evictions_total", "Entries dropped to stay within the byte budget",
+                       labels, [&cache] { return static_cast<double>(cache.stats().evictions); });
+    registry.counterFn("travelplanner_cache_expirations_total", "Entries dropped because their TTL passed",
+                       labels, [&cache] { return static_cast<double>(cache.stats().expirations); });
+    registry.gaugeFn("travelplanner_cache_entries", "Entries currently cached", labels,
+                     [&cache] { return static_cast<double>(cache.stats().entries); });
+    registry.gaugeFn("travelplanner_cache_bytes", "Approximate bytes currently cached", labels,
+                     [&cache] { return static_cast<double>(cache.stats().bytes); });
+    return true;
+}
+
+[[maybe_unused]] const bool lookupCacheMetrics =
+    exportCacheMetrics("iata", iataCache) && exportCacheMetrics("weather", weatherCache);
 
 string weatherCacheKey(const string& city, int days) {
     return city + "|" + to_string(days);
 }
 
+// Flight results: popular routes are searched over and over, and each
+// Amadeus search costs an OAuth call plus IATA lookups. Results are fresh
+// for FLIGHT_CACHE_TTL_SECONDS, then served stale for up to
+// FLIGHT_CACHE_STALE_SECONDS while one background refresh runs. Built on
+// first use so the configured TTLs apply.
+//
+// Tables are shared rather than copied out: a hit costs a refcount, and
+// the caller copies the rows once, into its own memory resource.
+using SharedFlights = shared_ptr<const FlightTable>;
+
+RefreshingCache<string, SharedFlights>& flightCache() {
+    static RefreshingCache<string, SharedFlights> cache(
+        16 << 20,
+        chrono::seconds(APIHandler::FLIGHT_CACHE_TTL_SECONDS),
+        chrono::seconds(APIHandler::FLIGHT_CACHE_STALE_SECONDS),
+        [](const string& key, const SharedFlights& flights) -> size_t {
+            return 64 + key.capacity() + flights->memoryBytes();
+        });
+    [[maybe_unused]] static const bool exported = exportCacheMetrics("flights", cache);
+    return cache;
+}
+
+// "Delhi " and "delhi" are the same search.
+string normalizeCity(const string& city) {
+    size_t first = city.find_first_not_of(" \t");
+    size_t last = city.find_last_not_of(" \t");
+    if (first == string::npos) return "";
+    string normalized = city.substr(first, last - first + 1);
+    transform(normalized.begin(), normalized.end(), normalized.begin(),
+              [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return normalized;
+}
+
+string flightCacheKey(const string& from, const string& to, const string& date, int passengers) {
+    return normalizeCity(from) + "|" + normalizeCity(to) + "|" + date + "|" + to_string(passengers);
+}
+
+// Identical concurrent lookups (a burst of the same /flights query, say)
+// share one upstream call instead of each spending Gemini/Amadeus quota.
+SingleFlight<string, SharedFlights> flightFlights;
+SingleFlight<string, json> weatherFlights;
+SingleFlight<string, string> iataFlights;
+
+[[maybe_unused]] const bool coalescingMetrics = [] {
+    auto& registry = MetricsRegistry::instance();
+    const char* help = "Lookups that shared another caller's in-flight upstream call";
+    registry.counterFn("travelplanner_coalesced_requests_total", help, {{"call", "flights"}},
+                       [] { return static_cast<double>(flightFlights.coalesced()); });
+    registry.counterFn("travelplanner_coalesced_requests_total", help, {{"call", "weather"}},
+                       [] { return static_cast<double>(weatherFlights.coalesced()); });
+    registry.counterFn("travelplanner_coalesced_requests_total", help, {{"call", "iata"}},
+                       [] { return static_cast<double>(iataFlights.coalesced()); });
+    return true;
+}();
+
+function<void(function<void()>)> backgroundExecutor;
+
+// Circuit-breaker settings for one upstream, each overridable through
+// <SERVICE>_BREAKER_FAILURE_RATE, _SLOW_CALL_MS, _SLOW_CALL_RATE and
+// _COOLDOWN_SECONDS (e.g. GEMINI_BREAKER_SLOW_CALL_MS).
+CircuitBreaker::Config breakerConfig(const string& service, chrono::milliseconds slowCall,
+                                     chrono::seconds cooldown) {
+    CircuitBreaker::Config config;
+    config.slowCallDuration = slowCall;
+    config.cooldown = cooldown;
+
+    string prefix = service + "_BREAKER_";
+    transform(prefix.begin(), prefix.end(), prefix.begin(),
+              [](unsigned char c) { return static_cast<char>(toupper(c)); });
+    if (auto rate = envNumber<double>(prefix + "FAILURE_RATE")) config.failureRateThreshold = *rate;
+    if (auto ms = envNumber<int>(prefix + "SLOW_CALL_MS")) config.slowCallDuration = chrono::milliseconds(*ms);
+    if (auto rate = envNumber<double>(prefix + "SLOW_CALL_RATE")) config.slowCallRateThreshold = *rate;
+    if (auto seconds = envNumber<int>(prefix + "COOLDOWN_SECONDS")) config.cooldown = chrono::seconds(*seconds);
+    return config;
+}
+
+// Bulkhead limits for one upstream, overridable through
+// <SERVICE>_MAX_CONCURRENT and <SERVICE>_MAX_QUEUE_WAIT_MS.
+Bulkhead::Config bulkheadConfig(const string& service, size_t maxConcurrent, chrono::milliseconds maxQueueWait) {
+    Bulkhead::Config config;
+    config.maxConcurrent = maxConcurrent;
+    config.maxQueueWait = maxQueueWait;
+
+    string prefix = service + "_";
+    transform(prefix.begin(), prefix.end(), prefix.begin(),
+              [](unsigned char c) { return static_cast<char>(toupper(c)); });
+    if (auto concurrent = envNumber<int>(prefix + "MAX_CONCURRENT")) {
+        config.maxConcurrent = static_cast<size_t>(std::max(*concurrent, 1));
+    }
+    if (auto queueWait = envNumber<int>(prefix + "MAX_QUEUE_WAIT_MS")) {
+        config.maxQueueWait = chrono::milliseconds(std::max(*queueWait, 0));
+    }
+    return config;
+}
+
+// Retries for calls to `service`, drawn from that service's shared budget
+// and counted in `metrics`.
+RetryPolicy retryPolicy(const string& service, RetryMetrics& metrics) {
+    RetryPolicy policy;
+    policy.budget = &RetryBudget::forService(service);
+    policy.metrics = &metrics;
+    return policy;
+}
+
+// Per-operation retry counters, labelled with the operation's error prefix.
+RetryMetrics& flightRetryMetrics() {
+    static RetryMetrics metrics("Error in searchFlights");
+    return metrics;
+}
+
+RetryMetrics& hotelRetryMetrics() {
+    static RetryMetrics metrics("Error getting hotel suggestions");
+    return metrics;
+}
+
+RetryMetrics& itineraryRetryMetrics() {
+    static RetryMetrics metrics("Error generating itinerary");
+    return metrics;
+}
+
+// A WeatherAPI forecast reshaped into our JSON.
+json parseForecast(const string& city, const string& response) {
+    json responseJson = json::parse(response);
+
+    json result;
+    result["city"] = city;
+    result["forecast"] = json::array();
+    for (const auto& day : responseJson["forecast"]["forecastday"]) {
+        result["forecast"].push_back({
+            {"date", day["date"].get<string>()},
+            {"max_temp_c", day["day"]["maxtemp_c"].get<double>()},
+            {"min_temp_c", day["day"]["mintemp_c"].get<double>()},
+            {"condition", day["day"]["condition"]["text"].get<string>()},
+            {"rain_chance", day["day"]["daily_chance_of_rain"].get<int>()}
+        });
+    }
+    return result;
+}
+
+// Gemini request for the main airport of `city` (see fetchIATACode).
+json iataCodeRequest(const string& city) {
+    json request = {
+        {"contents", {
+            {
+                {"parts", {
+                    {{"text", "You are an IATA airport code assistant. For the city '" + city + "', return ONLY the 3-letter IATA code of its main airport. Return just the code, nothing else. For example, if asked about New York, you would return 'JFK'."}}
+                }}
+            }
+        }}
+    };
+    return request;
+}
+
+string parseIATACode(const string& response) {
+    json responseJson = json::parse(response);
+
+    if (!responseJson.contains("candidates") || responseJson["candidates"].empty()) {
+        throw runtime_error("Invalid Gemini response structure");
+    }
+
+    string iataCode = responseJson["candidates"][0]["content"]["parts"][0]["text"].get<string>();
+    iataCode.erase(remove_if(iataCode.begin(), iataCode.end(), ::isspace), iataCode.end());
+
+    if (iataCode.length() == 3 && all_of(iataCode.begin(), iataCode.end(), ::isupper)) {
+        return iataCode;
+    }
+
+    throw runtime_error("Invalid IATA code format: " + iataCode);
+}
+
+// Gemini structured-output request for hotel suggestions (see searchHotels).
+json hotelSuggestionRequest(const string& city, const string& checkIn, const string& checkOut, int guests) {
+    json request = {
+        {"contents", {
+            {
+                {"parts", {
+                    {{"text", "Suggest 3 good hotels to stay in " + city + " from " + checkIn + " to " + checkOut +
+                             " for " + to_string(guests) + " people."}}
+                }}
+            }
+        }},
+        {"generationConfig", {
+            {"responseMimeType", "application/json"},
+            {"responseSchema", {
+                {"type", "ARRAY"},
+                {"items", {
+                    {"type", "OBJECT"},
+                    {"properties", {
+                        {"hotel_name", {{"type", "STRING"}}},
+                        {"star_rating", {{"type", "NUMBER"}}},
+                        {"total_stay_cost", {{"type", "NUMBER"}}},
+                        {"address", {{"type", "STRING"}}}
+                    }},
+                    {"required", {"hotel_name", "star_rating", "total_stay_cost", "address"}}
+                }}
+            }}
+        }}
+    };
+    return request;
+}
+
+// Gemini structured-output request for a day-by-day itinerary.
+json itineraryRequest(const string& destination, const string& startDate, const string& endDate) {
+    tm start = {}, end = {};
+    int num_days = 1;
+    if (FastParse::parseDate(startDate, start) && FastParse::parseDate(endDate, end)) {
+        num_days = static_cast<int>(
+            FastParse::daysFromCivil(end.tm_year + 1900, end.tm_mon + 1, end.tm_mday) -
+            FastParse::daysFromCivil(start.tm_year + 1900, start.tm_mon + 1, start.tm_mday)) + 1;
+    }
+
+    string prompt =
+        "Create a simple " + to_string(num_days) + "-day travel itinerary for " + destination + " from " + startDate + " to " + endDate + ".\n"
+        "For each day, provide a date (YYYY-MM-DD), a place to visit, what it's famous for (1-2 sentences), "
+        "and how to get there (brief transportation description).";
+
+    json request = {
+        {"contents", {
+            {
+                {"parts", {
+                    {{"text", prompt}}
+                }}
+            }
+        }},
+        {"generationConfig", {
+            {"responseMimeType", "application/json"},
+            {"responseSchema", {
+                {"type", "OBJECT"},
+                {"properties", {
+                    {"itinerary", {
+                        {"type", "ARRAY"},
+                        {"items", {
+                            {"type", "OBJECT"},
+                            {"properties", {
+                                {"date", {{"type", "STRING"}}},
+                                {"place", {{"type", "STRING"}}},
+                                {"famous_for", {{"type", "STRING"}}},
+                                {"how_to_go", {{"type", "STRING"}}}
+                            }},
+                            {"required", {"date", "place", "famous_for", "how_to_go"}}
+                        }}
+                    }}
+                }},
+                {"required", {"itinerary"}}
+            }}
+        }}
+    };
+    return request;
+}
+
 } // namespace
 
 // Initialize API keys: environment variables take priority; falls back to
@@ -65,6 +400,26 @@ void APIHandler::initializeAPIKeys() {
     if (!envCurrency.empty()) CURRENCY_CODE = envCurrency;
     string envProvider = getEnvOrEmpty("FLIGHT_PROVIDER");
     if (!envProvider.empty()) FLIGHT_PROVIDER = envProvider;
+    if (auto ttl = envNumber<int>("FLIGHT_CACHE_TTL_SECONDS")) FLIGHT_CACHE_TTL_SECONDS = *ttl;
+    if (auto stale = envNumber<int>("FLIGHT_CACHE_STALE_SECONDS")) FLIGHT_CACHE_STALE_SECONDS = *stale;
+    if (auto slowCall = envNumber<int>("SLOW_CALL_THRESHOLD_MS")) SLOW_CALL_THRESHOLD_MS = *slowCall;
+    HttpTransfer::setSlowCallThreshold(chrono::milliseconds(SLOW_CALL_THRESHOLD_MS));
+    if (auto maxOffers = envNumber<int>("AMADEUS_MAX_OFFERS")) AMADEUS_MAX_OFFERS = std::clamp(*maxOffers, 1, 250);
+    if (auto resultLimit = envNumber<int>("FLIGHT_RESULT_LIMIT")) FLIGHT_RESULT_LIMIT = std::max(*resultLimit, 1);
+    // Register every upstream before any traffic, so breaker lookups on
+    // the request path never take the registration lock. What counts as
+    // slow differs a lot between a forecast lookup and an LLM call.
+    CircuitBreaker& breaker = CircuitBreaker::instance();
+    breaker.configure("weather", breakerConfig("weather", chrono::seconds(3), chrono::seconds(30)));
+    breaker.configure("amadeus", breakerConfig("amadeus", chrono::seconds(8), chrono::seconds(30)));
+    breaker.configure("gemini", breakerConfig("gemini", chrono::seconds(15), chrono::seconds(60)));
+    breaker.configure("mock", CircuitBreaker::Config{});
+    // Each upstream gets its own share of the upstream pool, so a Gemini
+    // slowdown queues (then sheds) Gemini calls while weather keeps going.
+    Bulkhead& bulkhead = Bulkhead::instance();
+    bulkhead.configure("weather", bulkheadConfig("weather", 8, chrono::milliseconds(100)));
+    bulkhead.configure("amadeus", bulkheadConfig("amadeus", 12, chrono::milliseconds(250)));
+    bulkhead.configure("gemini", bulkheadConfig("gemini", 12, chrono::milliseconds(250)));
 
     // Amadeus credentials are optional: without them the flight backend
     // falls back to the Gemini estimator or the offline mock (see
@@ -107,79 +462,48 @@ void APIHandler::initializeAPIKeys() {
 void APIHandler::clearCaches() {
     iataCache.clear();
     weatherCache.clear();
+    flightCache().clear();
 }
 
-// Callback function to write response data
-size_t APIHandler::WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    ((string*)userp)->append((char*)contents, size * nmemb);
-    return size * nmemb;
+void APIHandler::setBackgroundExecutor(function<void(function<void()>)> executor) {
+    backgroundExecutor = std::move(executor);
 }
 
-// Make HTTP request
-string APIHandler::makeHttpRequest(const string& url, const string& method, const string& data, const string& token) {
-    CURL* curl = curl_easy_init();
-    string response;
-
-    if (curl) {
-        try {
-            struct curl_slist* headers = NULL;
-
-            if (url.find("amadeus") != string::npos && url.find("oauth2/token") != string::npos) {
-                headers = curl_slist_append(headers, "Content-Type: application/x-www-form-urlencoded");
-            } else {
-                headers = curl_slist_append(headers, "Content-Type: application/json");
-            }
-
-            if (!token.empty()) {
-                headers = curl_slist_append(headers, ("Authorization: Bearer " + token).c_str());
-            }
-
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-
-            if (method == "POST") {
-                curl_easy_setopt(curl, CURLOPT_POST, 1L);
-                if (!data.empty()) {
-                    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
-                    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.length());
-                }
-            }
-
-            CURLcode res = curl_easy_perform(curl);
-
-            if (res != CURLE_OK) {
-                string error = "Curl failed: " + string(curl_easy_strerror(res));
-                curl_slist_free_all(headers);
-                curl_easy_cleanup(curl);
-                throw runtime_error(error);
-            }
-
-            long http_code = 0;
-            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-
-            if (http_code >= 400) {
-                string error = "HTTP error " + to_string(http_code) + ": " + response;
-                curl_slist_free_all(headers);
-                curl_easy_cleanup(curl);
-                throw runtime_error(error);
-            }
+void APIHandler::runInBackground(function<void()> task) {
+    if (backgroundExecutor) {
+        backgroundExecutor(std::move(task));
+    } else {
+        thread(std::move(task)).detach();
+    }
+}
 
-            curl_slist_free_all(headers);
-            curl_easy_cleanup(curl);
+// Make HTTP request on a pooled handle, so repeat calls to the same upstream
+// reuse its DNS entry, TLS session and (usually) an open connection.
+string APIHandler::makeHttpRequest(const string& url, const string& method, const string& data, const string& token) {
+    HttpTransfer transfer({url, method, data, token});
+    return transfer.finish(curl_easy_perform(transfer.handle()));
+}
 
-            return response;
-        } catch (const exception& e) {
-            curl_easy_cleanup(curl);
-            throw;
-        }
-    }
+// Same request, driven by the shared event-loop engine instead of blocking
+// the calling thread inside curl_easy_perform.
+future<string> APIHandler::httpRequestAsync(const string& url, const string& method,
+                                            const string& data, const string& token) {
+    return HttpEngine::instance().requestAsync(HttpRequest{url, method, data, token});
+}
 
-    throw runtime_error("Failed to initialize CURL");
+void APIHandler::httpRequestAsync(const string& url, const string& method, const string& data,
+                                  const string& token, function<void(exception_ptr, string)> done) {
+    auto cost = RequestCost::current();
+    SpanContext trace = Tracer::current();
+    HttpEngine::instance().requestAsync(HttpRequest{url, method, data, token},
+                                        [cost, trace, done = std::move(done)](exception_ptr error, string body) {
+        // Off the engine thread before the caller parses anything.
+        runInBackground([cost, trace, done, error, body = std::move(body)]() mutable {
+            RequestCostScope charge(cost);
+            ScopedSpanContext scope(trace);
+            done(error, std::move(body));
+        });
+    });
 }
 
 // Get weather forecast (console display)
@@ -197,48 +521,119 @@ void APIHandler::getWeather(const string& city, int days) {
 
 // Get weather forecast as JSON, backed by a short-lived cache.
 json APIHandler::getWeatherJson(const string& city, int days) {
+    Span span("APIHandler::getWeatherJson");
     string key = weatherCacheKey(city, days);
-    auto it = weatherCache.find(key);
-    if (it != weatherCache.end()) {
-        auto age = chrono::steady_clock::now() - it->second.fetchedAt;
-        if (age < weatherCacheTTL) {
-            Logger::info("Weather cache hit for " + key);
-            return it->second.data;
-        }
-        weatherCache.erase(it);
+    auto cached = [&] {
+        PhaseTimer timer(RequestCost::Phase::Cache);
+        return weatherCache.get(key);
+    }();
+    if (cached) {
+        LOG_DEBUG("Weather cache hit for ", key);
+        span.set("cache", "hit");
+        return *cached;
     }
+    span.set("cache", "miss");
 
-    const string service = "weather";
-    CircuitBreaker::instance().checkAllowed(service);
+    return weatherFlights.run(key, [&] {
+        json result = fetchWeatherJson(city, days);
+        weatherCache.put(key, result);
+        return result;
+    });
+}
 
-    try {
-        string url = WEATHER_API_URL + "/forecast.json?key=" + WEATHER_API_KEY +
-                    "&q=" + urlEncode(city) + "&days=" + to_string(days);
-        string response = makeHttpRequest(url);
-        json responseJson = json::parse(response);
-
-        json result;
-        result["city"] = city;
-        result["forecast"] = json::array();
-        for (const auto& day : responseJson["forecast"]["forecastday"]) {
-            result["forecast"].push_back({
-                {"date", day["date"].get<string>()},
-                {"max_temp_c", day["day"]["maxtemp_c"].get<double>()},
-                {"min_temp_c", day["day"]["mintemp_c"].get<double>()},
-                {"condition", day["day"]["condition"]["text"].get<string>()},
-                {"rain_chance", day["day"]["daily_chance_of_rain"].get<int>()}
+// getWeatherJson without holding a thread: a miss joins (or leads) the
+// coalesced fetch through SingleFlight::runAsync.
+void APIHandler::getWeatherJsonAsync(const string& city, int days, function<void(exception_ptr, json)> done) {
+    auto span = make_shared<AsyncSpan>("APIHandler::getWeatherJson");
+    ScopedSpanContext scope(span->context());
+    string key = weatherCacheKey(city, days);
+    auto cached = [&] {
+        PhaseTimer timer(RequestCost::Phase::Cache);
+        return weatherCache.get(key);
+    }();
+    if (cached) {
+        LOG_DEBUG("Weather cache hit for ", key);
+        span->set("cache", "hit");
+        span->end();
+        return done(nullptr, *cached);
+    }
+    span->set("cache", "miss");
+
+    weatherFlights.runAsync(
+        key,
+        [=](SingleFlight<string, json>::Callback finish) {
+            fetchWeatherJsonAsync(city, days, [key, finish](exception_ptr error, json result) {
+                if (!error) weatherCache.put(key, result);
+                finish(error, std::move(result));
             });
-        }
+        },
+        [span, done](exception_ptr error, json result) {
+            span->end(error != nullptr);
+            done(error, std::move(result));
+        });
+}
+
+string APIHandler::forecastUrl(const string& city, int days) {
+    return WEATHER_API_URL + "/forecast.json?key=" + WEATHER_API_KEY +
+           "&q=" + urlEncode(city) + "&days=" + to_string(days);
+}
+
+// One WeatherAPI forecast call, reshaped into our JSON.
+json APIHandler::fetchWeatherJson(const string& city, int days) {
+    PhaseTimer timer(RequestCost::Phase::Provider);
+    const string service = "weather";
+    Admission admission = admit(service);
+    auto started = chrono::steady_clock::now();
 
-        CircuitBreaker::instance().recordSuccess(service);
-        weatherCache[key] = {chrono::steady_clock::now(), result};
+    try {
+        string response = makeHttpRequest(forecastUrl(city, days));
+        PhaseTimer parseTimer(RequestCost::Phase::Parse);
+        json result = parseForecast(city, response);
+        CircuitBreaker::instance().recordSuccess(service, admission.ticket, chrono::steady_clock::now() - started);
         return result;
     } catch (const exception& e) {
-        CircuitBreaker::instance().recordFailure(service);
+        CircuitBreaker::instance().recordFailure(service, admission.ticket, chrono::steady_clock::now() - started);
         throw;
     }
 }
 
+// fetchWeatherJson over the HTTP engine: neither the wait for a "weather"
+// bulkhead slot nor the call itself holds a thread.
+void APIHandler::fetchWeatherJsonAsync(const string& city, int days, function<void(exception_ptr, json)> done) {
+    const string service = "weather";
+    string url = forecastUrl(city, days);
+    auto cost = RequestCost::current();
+    SpanContext trace = Tracer::current();
+    auto providerStarted = chrono::steady_clock::now();
+
+    admitAsync(service, [=](exception_ptr refused, Admission admission) {
+        if (refused) return done(refused, json());
+        RequestCostScope charge(cost);
+        ScopedSpanContext scope(trace);
+        auto started = chrono::steady_clock::now();
+        httpRequestAsync(url, "GET", "", "", [=](exception_ptr error, string response) mutable {
+            admission.permit.release();
+            auto elapsed = chrono::steady_clock::now() - started;
+            json result;
+            if (!error) {
+                try {
+                    PhaseTimer parseTimer(RequestCost::Phase::Parse);
+                    result = parseForecast(city, response);
+                } catch (...) {
+                    error = current_exception();
+                }
+            }
+            if (error) {
+                CircuitBreaker::instance().recordFailure(service, admission.ticket, elapsed);
+            } else {
+                CircuitBreaker::instance().recordSuccess(service, admission.ticket, elapsed);
+            }
+            if (cost) cost->add(RequestCost::Phase::Provider, chrono::steady_clock::now() - providerStarted);
+            done(error, std::move(result));
+        });
+    });
+}
+
 // Builds the configured flight backend once, on first use.
 FlightProvider& APIHandler::flightProvider() {
     static std::unique_ptr<FlightProvider> provider = [] {
@@ -247,12 +642,21 @@ FlightProvider& APIHandler::flightProvider() {
                                 const string& data, const string& token) {
             return makeHttpRequest(url, method, data, token);
         };
+        config.httpRequestAsync = [](const string& url, const string& method, const string& data,
+                                     const string& token, FlightProviderConfig::Callback done) {
+            httpRequestAsync(url, method, data, token, std::move(done));
+        };
         config.resolveIATA = [](const string& city) { return getIATACode(city); };
+        config.resolveIATAAsync = [](const string& city, FlightProviderConfig::Callback done) {
+            getIATACodeAsync(city, std::move(done));
+        };
         config.currency = CURRENCY_CODE;
         config.amadeusClientId = AMADEUS_CLIENT_ID;
         config.amadeusClientSecret = AMADEUS_CLIENT_SECRET;
         config.amadeusTokenUrl = AMADEUS_TOKEN_URL;
         config.amadeusFlightUrl = AMADEUS_FLIGHT_URL;
+        config.amadeusMaxOffers = AMADEUS_MAX_OFFERS;
+        config.flightResultLimit = static_cast<size_t>(FLIGHT_RESULT_LIMIT);
         config.geminiApiKey = GEMINI_API_KEY;
         config.geminiApiUrl = GEMINI_API_URL;
         return makeFlightProvider(FLIGHT_PROVIDER, config);
@@ -260,42 +664,81 @@ FlightProvider& APIHandler::flightProvider() {
     return *provider;
 }
 
-// Helper function to get IATA code using Gemini API, cached per city.
+// Resolves a city to its IATA code: the compiled-in airport table first,
+// then the cache, and only for names neither knows a Gemini lookup.
 string APIHandler::getIATACode(const string& city) {
-    auto cached = iataCache.find(city);
-    if (cached != iataCache.end()) {
-        Logger::info("IATA cache hit for " + city);
-        return cached->second;
+    Span span("APIHandler::getIATACode");
+    PhaseTimer timer(RequestCost::Phase::Iata);
+    if (auto known = AirportTable::lookup(city)) {
+        span.set("source", "table");
+        return *known;
     }
 
-    try {
-        json request = {
-            {"contents", {
-                {
-                    {"parts", {
-                        {{"text", "You are an IATA airport code assistant. For the city '" + city + "', return ONLY the 3-letter IATA code of its main airport. Return just the code, nothing else. For example, if asked about New York, you would return 'JFK'."}}
-                    }}
-                }
-            }}
-        };
+    string key = normalizeCity(city);
+    if (auto cached = iataCache.get(key)) {
+        LOG_DEBUG("IATA cache hit for ", city);
+        span.set("source", "cache");
+        return *cached;
+    }
+    span.set("source", "gemini");
 
-        string url = GEMINI_API_URL + "?key=" + GEMINI_API_KEY;
-        string response = makeHttpRequest(url, "POST", request.dump());
-        json responseJson = json::parse(response);
+    return iataFlights.run(key, [&] {
+        string iataCode = fetchIATACode(city);
+        iataCache.put(key, iataCode);
+        return iataCode;
+    });
+}
 
-        if (!responseJson.contains("candidates") || responseJson["candidates"].empty()) {
-            throw runtime_error("Invalid Gemini response structure");
-        }
+// getIATACode for the non-blocking flight search: the table and cache
+// answer inline, and a Gemini lookup holds no thread while it waits.
+void APIHandler::getIATACodeAsync(const string& city, function<void(exception_ptr, string)> done) {
+    auto span = make_shared<AsyncSpan>("APIHandler::getIATACode");
+    if (auto known = AirportTable::lookup(city)) {
+        span->set("source", "table");
+        span->end();
+        return done(nullptr, *known);
+    }
 
-        string iataCode = responseJson["candidates"][0]["content"]["parts"][0]["text"].get<string>();
-        iataCode.erase(remove_if(iataCode.begin(), iataCode.end(), ::isspace), iataCode.end());
+    string key = normalizeCity(city);
+    if (auto cached = iataCache.get(key)) {
+        LOG_DEBUG("IATA cache hit for ", city);
+        span->set("source", "cache");
+        span->end();
+        return done(nullptr, *cached);
+    }
+    span->set("source", "gemini");
 
-        if (iataCode.length() == 3 && all_of(iataCode.begin(), iataCode.end(), ::isupper)) {
-            iataCache[city] = iataCode;
-            return iataCode;
-        }
+    ScopedSpanContext scope(span->context());
+    auto cost = RequestCost::current();
+    auto started = chrono::steady_clock::now();
+    iataFlights.runAsync(
+        key,
+        [key, city](SingleFlight<string, string>::Callback finish) {
+            httpRequestAsync(GEMINI_API_URL + "?key=" + GEMINI_API_KEY, "POST", iataCodeRequest(city).dump(), "",
+                             [key, finish](exception_ptr error, string response) {
+                string iataCode;
+                try {
+                    if (error) rethrow_exception(error);
+                    iataCode = parseIATACode(response);
+                    iataCache.put(key, iataCode);
+                } catch (const exception& e) {
+                    error = make_exception_ptr(runtime_error("Error getting IATA code: " + string(e.what())));
+                }
+                finish(error, std::move(iataCode));
+            });
+        },
+        [span, cost, started, done = std::move(done)](exception_ptr error, string iataCode) {
+            if (cost) cost->add(RequestCost::Phase::Iata, chrono::steady_clock::now() - started);
+            span->end(error != nullptr);
+            done(error, std::move(iataCode));
+        });
+}
 
-        throw runtime_error("Invalid IATA code format: " + iataCode);
+// Asks Gemini for the main airport of a city the table doesn't know.
+string APIHandler::fetchIATACode(const string& city) {
+    try {
+        string url = GEMINI_API_URL + "?key=" + GEMINI_API_KEY;
+        return parseIATACode(makeHttpRequest(url, "POST", iataCodeRequest(city).dump()));
     } catch (const exception& e) {
         throw runtime_error("Error getting IATA code: " + string(e.what()));
     }
@@ -303,37 +746,158 @@ string APIHandler::getIATACode(const string& city) {
 
 // Helper function to URL encode parameters
 string APIHandler::urlEncode(const string& str) {
-    CURL* curl = curl_easy_init();
+    CurlHandlePool::Lease lease = CurlHandlePool::instance().acquire();
     string encoded;
-    if (curl) {
-        char* output = curl_easy_escape(curl, str.c_str(), str.length());
-        if (output) {
-            encoded = output;
-            curl_free(output);
-        }
-        curl_easy_cleanup(curl);
+    char* output = curl_easy_escape(lease.get(), str.c_str(), static_cast<int>(str.length()));
+    if (output) {
+        encoded = output;
+        curl_free(output);
     }
     return encoded;
 }
 
+// Search for flights, answering from the result cache when possible. A
+// stale hit is returned immediately while one background refresh replaces
+// it, so popular routes never wait on the provider.
+FlightTable APIHandler::searchFlights(const string& from, const string& to,
+                                      const string& date, int passengers,
+                                      std::pmr::memory_resource* resource) {
+    Span span("APIHandler::searchFlights");
+    string key = flightCacheKey(from, to, date, passengers);
+    auto cached = [&] {
+        PhaseTimer timer(RequestCost::Phase::Cache);
+        return flightCache().get(key);
+    }();
+    if (cached.value) {
+        span.set("cache", cached.stale ? "stale" : "hit");
+        if (cached.shouldRefresh) refreshFlightsInBackground(key, from, to, date, passengers);
+        return FlightTable(**cached.value, resource);
+    }
+    span.set("cache", "miss");
+
+    SharedFlights flights = flightFlights.run(key, [&] {
+        auto fetched = make_shared<const FlightTable>(fetchFlights(from, to, date, passengers));
+        flightCache().put(key, fetched);
+        return fetched;
+    });
+    return FlightTable(*flights, resource);
+}
+
+// searchFlights without holding a thread: a miss joins (or leads) the
+// coalesced fetch through SingleFlight::runAsync.
+void APIHandler::searchFlightsAsync(const string& from, const string& to, const string& date, int passengers,
+                                    std::pmr::memory_resource* resource,
+                                    function<void(exception_ptr, FlightTable)> done) {
+    // Ends when the fetch reports back, not when this returns.
+    auto span = make_shared<AsyncSpan>("APIHandler::searchFlights");
+    ScopedSpanContext scope(span->context());
+    string key = flightCacheKey(from, to, date, passengers);
+    auto cached = [&] {
+        PhaseTimer timer(RequestCost::Phase::Cache);
+        return flightCache().get(key);
+    }();
+    if (cached.value) {
+        span->set("cache", cached.stale ? "stale" : "hit");
+        if (cached.shouldRefresh) refreshFlightsInBackground(key, from, to, date, passengers);
+        span->end();
+        done(nullptr, FlightTable(**cached.value, resource));
+        return;
+    }
+    span->set("cache", "miss");
+
+    flightFlights.runAsync(
+        key,
+        [=](SingleFlight<string, SharedFlights>::Callback finish) {
+            fetchFlightsAsync(from, to, date, passengers, [key, finish](exception_ptr error, SharedFlights flights) {
+                if (!error) flightCache().put(key, flights);
+                finish(error, std::move(flights));
+            });
+        },
+        [resource, done, span](exception_ptr error, SharedFlights flights) {
+            span->end(error != nullptr);
+            if (error) return done(error, FlightTable());
+            done(nullptr, FlightTable(*flights, resource));
+        });
+}
+
+// Replaces a stale cached result; failures keep serving the stale one.
+// Goes through fetchFlightsAsync, so its retries wait on the timer queue
+// rather than on a thread. It is traced under the search that found the
+// stale entry but not charged to it: that request has been answered.
+void APIHandler::refreshFlightsInBackground(const string& key, const string& from, const string& to,
+                                            const string& date, int passengers) {
+    RequestCostScope uncharged(nullptr);
+    auto span = make_shared<AsyncSpan>("APIHandler::refreshFlights");
+    ScopedSpanContext scope(span->context());
+    fetchFlightsAsync(from, to, date, passengers, [key, span](exception_ptr error, SharedFlights flights) {
+        span->end(error != nullptr);
+        if (!error) return flightCache().put(key, std::move(flights));
+        flightCache().refreshFailed(key);
+        try {
+            rethrow_exception(error);
+        } catch (const exception& e) {
+            LOG_WARN("Background flight refresh failed for ", key, ": ", e.what());
+        }
+    });
+}
+
 // Search for flights via whichever backend is configured. The provider is
-// built once and reused so the selection is logged a single time.
-vector<Flight> APIHandler::searchFlights(const string& from, const string& to,
-                                       const string& date, int passengers) {
+// built once and reused so the selection is logged a single time. For the
+// CLI only: it sleeps through retry backoff, where the server's path
+// (fetchFlightsAsync) waits on the timer queue.
+FlightTable APIHandler::fetchFlights(const string& from, const string& to,
+                                     const string& date, int passengers) {
+    PhaseTimer timer(RequestCost::Phase::Provider);
     FlightProvider& provider = flightProvider();
     const string service = provider.name();
 
-    return retryWithBackoff<vector<Flight>>("Error in searchFlights", [&]() -> vector<Flight> {
-        CircuitBreaker::instance().checkAllowed(service);
+    return retryWithBackoff<FlightTable>("Error in searchFlights", [&]() -> FlightTable {
+        Admission admission = admit(service);
+        auto started = chrono::steady_clock::now();
         try {
             auto flights = provider.search(from, to, date, passengers);
-            CircuitBreaker::instance().recordSuccess(service);
+            CircuitBreaker::instance().recordSuccess(service, admission.ticket, chrono::steady_clock::now() - started);
             return flights;
         } catch (const exception&) {
-            CircuitBreaker::instance().recordFailure(service);
+            CircuitBreaker::instance().recordFailure(service, admission.ticket, chrono::steady_clock::now() - started);
             throw;
         }
-    });
+    }, retryPolicy(service, flightRetryMetrics()));
+}
+
+// fetchFlights without holding a thread at any point: each try waits for
+// a slot in the provider's bulkhead, then runs the provider's searchAsync
+// (Amadeus and Gemini wait on the HTTP engine, not on a thread), and the
+// backoff between tries waits on the timer queue.
+void APIHandler::fetchFlightsAsync(const string& from, const string& to, const string& date, int passengers,
+                                   function<void(exception_ptr, SharedFlights)> done) {
+    FlightProvider& provider = flightProvider();
+    const string service = provider.name();
+    auto cost = RequestCost::current();
+    SpanContext trace = Tracer::current();
+    auto providerStarted = chrono::steady_clock::now();
+
+    retryAsync<SharedFlights>("Error in searchFlights", [=, &provider](AsyncCompletion<SharedFlights> attemptDone) {
+        admitAsync(service, [=, &provider](exception_ptr refused, Admission admission) {
+            if (refused) return attemptDone(refused, nullptr);
+            RequestCostScope charge(cost);
+            ScopedSpanContext scope(trace);
+            auto started = chrono::steady_clock::now();
+            provider.searchAsync(from, to, date, passengers, [=](exception_ptr error, FlightTable flights) mutable {
+                admission.permit.release();
+                auto elapsed = chrono::steady_clock::now() - started;
+                if (error) {
+                    CircuitBreaker::instance().recordFailure(service, admission.ticket, elapsed);
+                    return attemptDone(error, nullptr);
+                }
+                CircuitBreaker::instance().recordSuccess(service, admission.ticket, elapsed);
+                attemptDone(nullptr, make_shared<const FlightTable>(std::move(flights)));
+            });
+        });
+    }, [cost, providerStarted, done](exception_ptr error, SharedFlights flights) {
+        if (cost) cost->add(RequestCost::Phase::Provider, chrono::steady_clock::now() - providerStarted);
+        done(error, std::move(flights));
+    }, retryPolicy(service, flightRetryMetrics()));
 }
 
 string APIHandler::activeFlightProviderName() {
@@ -344,171 +908,158 @@ bool APIHandler::flightResultsAreBookable() {
     return flightProvider().isLiveInventory();
 }
 
+// One Gemini generateContent call through the HTTP engine, guarded by the
+// "gemini" breaker and bulkhead and retried with retryAsync. The reply is parsed on the
+// background executor rather than the engine thread. Every hop re-enters
+// the caller's request cost and trace, since later tries start on the
+// timer thread.
+template <typename T>
+void APIHandler::geminiRequestAsync(const char* errorPrefix, RetryMetrics& metrics, const string& body,
+                                    function<T(const string&)> parse, function<void(exception_ptr, T)> done) {
+    const string service = "gemini";
+    string url = GEMINI_API_URL + "?key=" + GEMINI_API_KEY;
+    auto cost = RequestCost::current();
+    SpanContext trace = Tracer::current();
+    auto providerStarted = chrono::steady_clock::now();
+
+    retryAsync<T>(errorPrefix, [=](AsyncCompletion<T> attemptDone) {
+        admitAsync(service, [=](exception_ptr refused, Admission admission) {
+            if (refused) return attemptDone(refused, T{});
+            RequestCostScope charge(cost);
+            ScopedSpanContext scope(trace);
+            auto started = chrono::steady_clock::now();
+            HttpRequest request;
+            request.url = url;
+            request.method = "POST";
+            request.data = body;
+            HttpEngine::instance().requestAsync(std::move(request),
+                                                [=](exception_ptr error, string response) mutable {
+                // The slot covers the upstream call, not our parsing.
+                admission.permit.release();
+                auto elapsed = chrono::steady_clock::now() - started;
+                if (error) {
+                    CircuitBreaker::instance().recordFailure(service, admission.ticket, elapsed);
+                    return attemptDone(error, T{});
+                }
+                runInBackground([=, response = std::move(response)] {
+                    RequestCostScope charge(cost);
+                    ScopedSpanContext scope(trace);
+                    // Parsed straight into the value handed on: assigning it
+                    // would copy a pmr result out of the request's arena.
+                    completeFrom(attemptDone, [&]() -> T {
+                        try {
+                            PhaseTimer parseTimer(RequestCost::Phase::Parse);
+                            T result = parse(response);
+                            CircuitBreaker::instance().recordSuccess(service, admission.ticket, elapsed);
+                            return result;
+                        } catch (...) {
+                            CircuitBreaker::instance().recordFailure(service, admission.ticket, elapsed);
+                            throw;
+                        }
+                    });
+                });
+            });
+        });
+    }, [cost, providerStarted, done](exception_ptr error, T value) {
+        if (cost) cost->add(RequestCost::Phase::Provider, chrono::steady_clock::now() - providerStarted);
+        done(error, std::move(value));
+    }, retryPolicy(service, metrics));
+}
+
 // Search for hotels. Uses Gemini structured output (responseMimeType +
 // responseSchema) instead of asking the model to emit JSON in prose and
 // scraping it out of markdown fences - the model is contractually bound to
 // return valid JSON matching the schema, so no brittle text surgery.
-vector<Hotel> APIHandler::searchHotels(const string& city, const string& checkIn,
-                                       const string& checkOut, int guests) {
+std::pmr::vector<Hotel> APIHandler::searchHotels(const string& city, const string& checkIn,
+                                                 const string& checkOut, int guests,
+                                                 std::pmr::memory_resource* resource) {
+    Span span("APIHandler::searchHotels");
+    PhaseTimer timer(RequestCost::Phase::Provider);
     const string service = "gemini";
-    return retryWithBackoff<vector<Hotel>>("Error getting hotel suggestions", [&]() -> vector<Hotel> {
-        CircuitBreaker::instance().checkAllowed(service);
+    return retryWithBackoff<std::pmr::vector<Hotel>>("Error getting hotel suggestions", [&]() -> std::pmr::vector<Hotel> {
+        Admission admission = admit(service);
+        auto started = chrono::steady_clock::now();
         try {
-            json request = {
-                {"contents", {
-                    {
-                        {"parts", {
-                            {{"text", "Suggest 3 good hotels to stay in " + city + " from " + checkIn + " to " + checkOut +
-                                     " for " + to_string(guests) + " people."}}
-                        }}
-                    }
-                }},
-                {"generationConfig", {
-                    {"responseMimeType", "application/json"},
-                    {"responseSchema", {
-                        {"type", "ARRAY"},
-                        {"items", {
-                            {"type", "OBJECT"},
-                            {"properties", {
-                                {"hotel_name", {{"type", "STRING"}}},
-                                {"star_rating", {{"type", "NUMBER"}}},
-                                {"total_stay_cost", {{"type", "NUMBER"}}},
-                                {"address", {{"type", "STRING"}}}
-                            }},
-                            {"required", {"hotel_name", "star_rating", "total_stay_cost", "address"}}
-                        }}
-                    }}
-                }}
-            };
+            json request = hotelSuggestionRequest(city, checkIn, checkOut, guests);
 
             string url = GEMINI_API_URL + "?key=" + GEMINI_API_KEY;
             string response = makeHttpRequest(url, "POST", request.dump());
-            json responseJson = json::parse(response);
-
-            if (!responseJson.contains("candidates") || responseJson["candidates"].empty()) {
-                throw runtime_error("Invalid Gemini response structure");
-            }
-
-            string hotelText = responseJson["candidates"][0]["content"]["parts"][0]["text"];
-            json hotelJson = json::parse(hotelText);
-
-            vector<Hotel> hotels;
-            for (const auto& hotel : hotelJson) {
-                hotels.emplace_back(
-                    hotel.at("hotel_name").get<string>(),
-                    city,
-                    hotel.at("total_stay_cost").get<double>(),
-                    hotel.at("star_rating").get<double>(),
-                    checkIn,
-                    checkOut,
-                    hotel.at("address").get<string>(),
-                    CURRENCY_CODE
-                );
-            }
-            CircuitBreaker::instance().recordSuccess(service);
+            PhaseTimer parseTimer(RequestCost::Phase::Parse);
+            auto hotels = GeminiParser::parseHotels(GeminiParser::candidateText(response), city, checkIn,
+                                                    checkOut, CURRENCY_CODE, resource);
+            CircuitBreaker::instance().recordSuccess(service, admission.ticket, chrono::steady_clock::now() - started);
             return hotels;
         } catch (const exception&) {
-            CircuitBreaker::instance().recordFailure(service);
+            CircuitBreaker::instance().recordFailure(service, admission.ticket, chrono::steady_clock::now() - started);
             throw;
         }
-    });
+    }, retryPolicy(service, hotelRetryMetrics()));
+}
+
+void APIHandler::searchHotelsAsync(const string& city, const string& checkIn, const string& checkOut, int guests,
+                                   std::pmr::memory_resource* resource,
+                                   function<void(exception_ptr, std::pmr::vector<Hotel>)> done) {
+    auto span = make_shared<AsyncSpan>("APIHandler::searchHotels");
+    ScopedSpanContext scope(span->context());
+    geminiRequestAsync<std::pmr::vector<Hotel>>(
+        "Error getting hotel suggestions", hotelRetryMetrics(), hotelSuggestionRequest(city, checkIn, checkOut, guests).dump(),
+        [=](const string& response) {
+            return GeminiParser::parseHotels(GeminiParser::candidateText(response), city, checkIn, checkOut,
+                                             CURRENCY_CODE, resource);
+        },
+        [span, done = std::move(done)](exception_ptr error, std::pmr::vector<Hotel> hotels) {
+            span->end(error != nullptr);
+            done(error, std::move(hotels));
+        });
 }
 
 // Generate itinerary, again using Gemini structured output for a
 // schema-validated response instead of markdown-fence scraping.
-vector<ItineraryItem> APIHandler::generateItinerary(const string& destination,
-                                                  const string& startDate,
-                                                  const string& endDate,
-                                                  int peopleCount,
-                                                  double budget,
-                                                  const Hotel& selectedHotel) {
+std::pmr::vector<ItineraryItem> APIHandler::generateItinerary(const string& destination,
+                                                             const string& startDate,
+                                                             const string& endDate,
+                                                             int peopleCount,
+                                                             double budget,
+                                                             const Hotel& selectedHotel,
+                                                             std::pmr::memory_resource* resource) {
+    Span span("APIHandler::generateItinerary");
+    PhaseTimer timer(RequestCost::Phase::Provider);
     const string service = "gemini";
-    return retryWithBackoff<vector<ItineraryItem>>("Error generating itinerary", [&]() -> vector<ItineraryItem> {
-        CircuitBreaker::instance().checkAllowed(service);
+    return retryWithBackoff<std::pmr::vector<ItineraryItem>>("Error generating itinerary",
+                                                             [&]() -> std::pmr::vector<ItineraryItem> {
+        Admission admission = admit(service);
+        auto started = chrono::steady_clock::now();
         try {
-            tm start = {}, end = {};
-            istringstream(startDate) >> get_time(&start, "%Y-%m-%d");
-            istringstream(endDate) >> get_time(&end, "%Y-%m-%d");
-            time_t start_time = mktime(&start);
-            time_t end_time = mktime(&end);
-            int num_days = static_cast<int>((end_time - start_time) / (60 * 60 * 24)) + 1;
-
-            string prompt =
-                "Create a simple " + to_string(num_days) + "-day travel itinerary for " + destination + " from " + startDate + " to " + endDate + ".\n"
-                "For each day, provide a date (YYYY-MM-DD), a place to visit, what it's famous for (1-2 sentences), "
-                "and how to get there (brief transportation description).";
-
-            json request = {
-                {"contents", {
-                    {
-                        {"parts", {
-                            {{"text", prompt}}
-                        }}
-                    }
-                }},
-                {"generationConfig", {
-                    {"responseMimeType", "application/json"},
-                    {"responseSchema", {
-                        {"type", "OBJECT"},
-                        {"properties", {
-                            {"itinerary", {
-                                {"type", "ARRAY"},
-                                {"items", {
-                                    {"type", "OBJECT"},
-                                    {"properties", {
-                                        {"date", {{"type", "STRING"}}},
-                                        {"place", {{"type", "STRING"}}},
-                                        {"famous_for", {{"type", "STRING"}}},
-                                        {"how_to_go", {{"type", "STRING"}}}
-                                    }},
-                                    {"required", {"date", "place", "famous_for", "how_to_go"}}
-                                }}
-                            }}
-                        }},
-                        {"required", {"itinerary"}}
-                    }}
-                }}
-            };
+            json request = itineraryRequest(destination, startDate, endDate);
 
             string url = GEMINI_API_URL + "?key=" + GEMINI_API_KEY;
             string response = makeHttpRequest(url, "POST", request.dump());
-            json responseJson = json::parse(response);
-
-            if (!responseJson.contains("candidates") || responseJson["candidates"].empty()) {
-                throw runtime_error("Invalid Gemini response structure");
-            }
-
-            string itineraryText = responseJson["candidates"][0]["content"]["parts"][0]["text"];
-            json itineraryJson = json::parse(itineraryText);
-
-            vector<ItineraryItem> itinerary;
-
-            itinerary.emplace_back("Check-in at " + selectedHotel.getName(),
-                                  startDate, "14:00", "Accommodation");
-
-            if (itineraryJson.contains("itinerary") && itineraryJson["itinerary"].is_array()) {
-                for (const auto& day : itineraryJson["itinerary"]) {
-                    string date = day.value("date", "");
-                    string place = day.value("place", "");
-                    string description = day.value("famous_for", "");
-                    string transport = day.value("how_to_go", "");
-                    if (!place.empty())
-                        itinerary.emplace_back("Visit " + place, date, "10:00", "Sightseeing");
-                    if (!description.empty())
-                        itinerary.emplace_back(description, date, "10:30", "Information");
-                    if (!transport.empty())
-                        itinerary.emplace_back("Transportation: " + transport, date, "09:30", "Transport");
-                }
-            }
-
-            itinerary.emplace_back("Check-out from " + selectedHotel.getName(),
-                                  endDate, "11:00", "Accommodation");
-
-            CircuitBreaker::instance().recordSuccess(service);
+            PhaseTimer parseTimer(RequestCost::Phase::Parse);
+            auto itinerary = GeminiParser::parseItinerary(GeminiParser::candidateText(response),
+                                                          selectedHotel.getName(), startDate, endDate, resource);
+            CircuitBreaker::instance().recordSuccess(service, admission.ticket, chrono::steady_clock::now() - started);
             return itinerary;
         } catch (const exception&) {
-            CircuitBreaker::instance().recordFailure(service);
+            CircuitBreaker::instance().recordFailure(service, admission.ticket, chrono::steady_clock::now() - started);
             throw;
         }
-    });
+    }, retryPolicy(service, itineraryRetryMetrics()));
+}
+
+void APIHandler::generateItineraryAsync(const string& destination, const string& startDate, const string& endDate,
+                                        const Hotel& selectedHotel,
+                                        std::pmr::memory_resource* resource,
+                                        function<void(exception_ptr, std::pmr::vector<ItineraryItem>)> done) {
+    auto span = make_shared<AsyncSpan>("APIHandler::generateItinerary");
+    ScopedSpanContext scope(span->context());
+    geminiRequestAsync<std::pmr::vector<ItineraryItem>>(
+        "Error generating itinerary", itineraryRetryMetrics(), itineraryRequest(destination, startDate, endDate).dump(),
+        [=, hotelName = string(selectedHotel.getName())](const string& response) {
+            return GeminiParser::parseItinerary(GeminiParser::candidateText(response), hotelName, startDate,
+                                                endDate, resource);
+        },
+        [span, done = std::move(done)](exception_ptr error, std::pmr::vector<ItineraryItem> items) {
+            span->end(error != nullptr);
+            done(error, std::move(items));
+        });
 }
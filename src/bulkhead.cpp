@@ -0,0 +1,159 @@
+#include "bulkhead.hpp"
+#include "logger.hpp"
+#include "upstream_error.hpp"
+#include <algorithm>
+#include <future>
+
+Bulkhead::State::State(const std::string& name, const Config& cfg) : service(name), config(cfg) {
+    auto& registry = MetricsRegistry::instance();
+    MetricLabels labels{{"service", service}};
+    rejections = &registry.counter("travelplanner_bulkhead_rejections_total",
+                                   "Calls refused after waiting maxQueueWait for a slot", labels);
+    activeGauge = &registry.gauge("travelplanner_bulkhead_active", "Calls holding a slot", labels);
+    queuedGauge = &registry.gauge("travelplanner_bulkhead_queued", "Calls waiting for a slot", labels);
+}
+
+Bulkhead& Bulkhead::instance() {
+    static Bulkhead bulkhead;
+    return bulkhead;
+}
+
+Bulkhead::Bulkhead(TimerQueue& timers) : timers_(timers) {}
+
+std::shared_ptr<Bulkhead::State> Bulkhead::stateFor(const std::string& service) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& state = services_[service];
+    if (!state) state = std::make_shared<State>(service, Config());
+    return state;
+}
+
+void Bulkhead::configure(const std::string& service, const Config& config) {
+    auto state = stateFor(service);
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->config = config;
+}
+
+struct Bulkhead::Permit::Slot {
+    explicit Slot(std::shared_ptr<State> owner) : state(std::move(owner)) {}
+    ~Slot() { free(); }
+
+    void free() {
+        if (!released.exchange(true, std::memory_order_acq_rel)) Bulkhead::release(state);
+    }
+
+    std::shared_ptr<State> state;
+    std::atomic<bool> released{false};
+};
+
+Bulkhead::Permit::operator bool() const {
+    return slot_ && !slot_->released.load(std::memory_order_acquire);
+}
+
+void Bulkhead::Permit::release() {
+    if (slot_) slot_->free();
+    slot_.reset();
+}
+
+// Called with the slot already counted in `active`.
+Bulkhead::Permit Bulkhead::grant(const std::shared_ptr<State>& state) {
+    Permit permit;
+    permit.slot_ = std::make_shared<Permit::Slot>(state);
+    return permit;
+}
+
+// Passes the slot straight to the oldest waiter, if any, so a queued call
+// can't be overtaken by one that just arrived.
+void Bulkhead::release(const std::shared_ptr<State>& state) {
+    std::shared_ptr<Waiter> next;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->queue.empty()) {
+            state->active--;
+            state->activeGauge->set(static_cast<int64_t>(state->active));
+            return;
+        }
+        next = std::move(state->queue.front());
+        state->queue.pop_front();
+        next->settled = true;
+        state->queuedGauge->set(static_cast<int64_t>(state->queue.size()));
+    }
+    // May run in a permit's destructor, so nothing may escape.
+    try {
+        next->done(nullptr, grant(state));
+    } catch (const std::exception& e) {
+        LOG_ERROR("Bulkhead callback for ", state->service, " threw: ", e.what());
+    }
+}
+
+// Under the state's lock, for the config.
+std::exception_ptr Bulkhead::rejection(const State& state) {
+    std::string message = "Bulkhead full for " + state.service + ": " +
+                          std::to_string(state.config.maxConcurrent) + " calls in flight";
+    if (state.config.maxQueueWait.count() > 0) {
+        message += ", none finished within " + std::to_string(state.config.maxQueueWait.count()) + "ms";
+    }
+    return std::make_exception_ptr(ServiceUnavailable(message));
+}
+
+void Bulkhead::acquireAsync(const std::string& service, Callback done) {
+    auto state = stateFor(service);
+    std::shared_ptr<Waiter> waiter;
+    std::exception_ptr refused;
+    std::chrono::milliseconds wait;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        wait = state->config.maxQueueWait;
+        if (state->active < state->config.maxConcurrent) {
+            state->active++;
+            state->activeGauge->set(static_cast<int64_t>(state->active));
+        } else if (wait.count() > 0) {
+            waiter = std::make_shared<Waiter>();
+            waiter->done = std::move(done);
+            state->queue.push_back(waiter);
+            state->queuedGauge->set(static_cast<int64_t>(state->queue.size()));
+        } else {
+            state->rejections->inc();
+            refused = rejection(*state);
+        }
+    }
+    if (refused) return done(refused, Permit());
+    if (!waiter) return done(nullptr, grant(state));
+
+    timers_.schedule(wait, [state, weak = std::weak_ptr<Waiter>(waiter)] {
+        auto waiter = weak.lock();
+        if (!waiter) return;
+        std::exception_ptr refused;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (waiter->settled) return;
+            waiter->settled = true;
+            state->queue.erase(std::find(state->queue.begin(), state->queue.end(), waiter));
+            state->queuedGauge->set(static_cast<int64_t>(state->queue.size()));
+            state->rejections->inc();
+            refused = rejection(*state);
+        }
+        waiter->done(refused, Permit());
+    });
+}
+
+Bulkhead::Permit Bulkhead::acquire(const std::string& service) {
+    auto slot = std::make_shared<std::promise<Permit>>();
+    std::future<Permit> result = slot->get_future();
+    acquireAsync(service, [slot](std::exception_ptr error, Permit permit) {
+        if (error) slot->set_exception(error);
+        else slot->set_value(std::move(permit));
+    });
+    return result.get();
+}
+
+size_t Bulkhead::active(const std::string& service) {
+    auto state = stateFor(service);
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->active;
+}
+
+size_t Bulkhead::queued(const std::string& service) {
+    auto state = stateFor(service);
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->queue.size();
+}
@@ -1,40 +1,185 @@
 #include "circuit_breaker.hpp"
 #include "logger.hpp"
-#include <stdexcept>
+#include "upstream_error.hpp"
+#include <algorithm>
+
+namespace {
+
+using Mode = CircuitBreaker::Mode;
+
+uint64_t pack(Mode mode, int64_t sinceNanos) {
+    return (static_cast<uint64_t>(sinceNanos) << 2) | static_cast<uint64_t>(mode);
+}
+Mode modeOf(uint64_t word) { return static_cast<Mode>(word & 3); }
+int64_t sinceOf(uint64_t word) { return static_cast<int64_t>(word >> 2); }
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// A window slot: steady_clock milliseconds (+1, so a used slot is never
+// 0) above a failed bit and a slow bit.
+constexpr uint64_t kFailed = 1;
+constexpr uint64_t kSlow = 2;
+
+uint64_t outcome(int64_t nanos, bool failed, bool slow) {
+    return (static_cast<uint64_t>(nanos / 1000000 + 1) << 2) | (failed ? kFailed : 0) | (slow ? kSlow : 0);
+}
+int64_t outcomeMillis(uint64_t slot) { return static_cast<int64_t>(slot >> 2) - 1; }
+
+} // namespace
+
+CircuitBreaker::State::State(const Config& cfg, const std::string& service)
+    : config(cfg), outcomes(new std::atomic<uint64_t>[cfg.windowSize]) {
+    for (size_t i = 0; i < config.windowSize; ++i) outcomes[i].store(0, std::memory_order_relaxed);
+    auto& registry = MetricsRegistry::instance();
+    MetricLabels labels{{"service", service}};
+    rejections = &registry.counter("travelplanner_circuit_breaker_rejections_total",
+                                   "Calls refused without touching the network", labels);
+    trips = &registry.counter("travelplanner_circuit_breaker_trips_total", "Times the circuit opened", labels);
+    openGauge = &registry.gauge("travelplanner_circuit_breaker_open", "1 while the circuit is open", labels);
+    openGauge->set(0);
+}
 
 CircuitBreaker& CircuitBreaker::instance() {
     static CircuitBreaker breaker;
     return breaker;
 }
 
-void CircuitBreaker::checkAllowed(const std::string& service) {
-    auto& state = states[service];
-    if (!state.open) return;
+CircuitBreaker::CircuitBreaker() {
+    snapshots_.push_back(std::make_unique<const Map>());
+    services_.store(snapshots_.back().get(), std::memory_order_release);
+}
 
-    auto elapsed = std::chrono::steady_clock::now() - state.openedAt;
-    if (elapsed >= cooldown) {
-        // Half-open: let one request through to probe recovery.
-        state.open = false;
-        state.consecutiveFailures = 0;
-        return;
+CircuitBreaker::~CircuitBreaker() = default;
+
+CircuitBreaker::State& CircuitBreaker::stateFor(const std::string& service) {
+    const Map* services = services_.load(std::memory_order_acquire);
+    auto it = services->find(service);
+    if (it != services->end()) return *it->second;
+    return publish(service, nullptr);
+}
+
+// Publishes a snapshot with a new State for `service`: configured, or with
+// the defaults if it isn't there yet.
+CircuitBreaker::State& CircuitBreaker::publish(const std::string& service, const Config* config) {
+    std::lock_guard<std::mutex> lock(registerMutex_);
+    const Map* current = services_.load(std::memory_order_relaxed);
+    if (!config) {
+        // Another thread may have published it while we waited.
+        auto it = current->find(service);
+        if (it != current->end()) return *it->second;
+    }
+
+    Config settings = config ? *config : Config{};
+    settings.windowSize = std::max<size_t>(settings.windowSize, 1);
+    settings.minimumCalls = std::clamp<size_t>(settings.minimumCalls, 1, settings.windowSize);
+    states_.push_back(std::make_unique<State>(settings, service));
+
+    auto next = std::make_unique<Map>(*current);
+    (*next)[service] = states_.back().get();
+    snapshots_.push_back(std::move(next));
+    services_.store(snapshots_.back().get(), std::memory_order_release);
+    return *states_.back();
+}
+
+void CircuitBreaker::configure(const std::string& service, const Config& config) {
+    publish(service, &config);
+}
+
+CircuitBreaker::Ticket CircuitBreaker::checkAllowed(const std::string& service) {
+    State& state = stateFor(service);
+    uint64_t word = state.word.load(std::memory_order_acquire);
+    if (modeOf(word) == Mode::Closed) return Ticket{word};
+
+    // Open past its cooldown, or half-open with a probe that never
+    // reported back: the caller that wins the swap becomes the probe.
+    // Its ticket is the half-open word it installed.
+    int64_t now = nowNanos();
+    uint64_t probe = pack(Mode::HalfOpen, now);
+    if (now - sinceOf(word) >= std::chrono::nanoseconds(state.config.cooldown).count() &&
+        state.word.compare_exchange_strong(word, probe, std::memory_order_acq_rel)) {
+        LOG_INFO("Circuit breaker HALF-OPEN for ", service, ": probing recovery");
+        return Ticket{probe};
     }
 
-    throw std::runtime_error("Circuit open for " + service + ": too many recent failures, backing off");
+    state.rejections->inc();
+    if (modeOf(word) == Mode::HalfOpen) {
+        throw ServiceUnavailable("Circuit half-open for " + service + ": waiting on a recovery probe");
+    }
+    throw ServiceUnavailable("Circuit open for " + service + ": upstream failing or slow, backing off");
 }
 
-void CircuitBreaker::recordSuccess(const std::string& service) {
-    auto& state = states[service];
-    state.consecutiveFailures = 0;
-    state.open = false;
+void CircuitBreaker::recordSuccess(const std::string& service, Ticket ticket,
+                                   std::chrono::steady_clock::duration elapsed) {
+    record(service, ticket, false, elapsed);
 }
 
-void CircuitBreaker::recordFailure(const std::string& service) {
-    auto& state = states[service];
-    state.consecutiveFailures++;
-    if (state.consecutiveFailures >= failureThreshold && !state.open) {
-        state.open = true;
-        state.openedAt = std::chrono::steady_clock::now();
-        Logger::error("Circuit breaker OPEN for " + service + " after " +
-                      std::to_string(state.consecutiveFailures) + " consecutive failures");
+void CircuitBreaker::recordFailure(const std::string& service, Ticket ticket,
+                                   std::chrono::steady_clock::duration elapsed) {
+    record(service, ticket, true, elapsed);
+}
+
+void CircuitBreaker::record(const std::string& service, Ticket ticket, bool failed,
+                            std::chrono::steady_clock::duration elapsed) {
+    State& state = stateFor(service);
+    const Config& config = state.config;
+    bool slow = elapsed >= config.slowCallDuration;
+    int64_t now = nowNanos();
+
+    uint64_t word = state.word.load(std::memory_order_acquire);
+    switch (modeOf(word)) {
+    case Mode::Open:
+        // A straggler admitted before the trip proves nothing either way.
+        return;
+    case Mode::HalfOpen:
+        // Only the current probe decides. A call admitted while closed, or
+        // a probe since replaced, reporting late proves nothing.
+        if (ticket.word != word) return;
+        if (failed || slow) {
+            if (state.word.compare_exchange_strong(word, pack(Mode::Open, now), std::memory_order_acq_rel)) {
+                state.trips->inc();
+                LOG_WARN("Circuit breaker re-OPENED for ", service, ": probe ", failed ? "failed" : "was slow");
+            }
+        } else if (state.word.compare_exchange_strong(word, pack(Mode::Closed, 0), std::memory_order_acq_rel)) {
+            for (size_t i = 0; i < config.windowSize; ++i) state.outcomes[i].store(0, std::memory_order_relaxed);
+            state.openGauge->set(0);
+            LOG_INFO("Circuit breaker CLOSED for ", service, ": probe succeeded");
+        }
+        return;
+    case Mode::Closed:
+        break;
+    }
+
+    uint64_t slot = state.cursor.fetch_add(1, std::memory_order_relaxed) % config.windowSize;
+    state.outcomes[slot].store(outcome(now, failed, slow), std::memory_order_relaxed);
+    // A good outcome can only lower the rates.
+    if (!failed && !slow) return;
+
+    // Rates over the slots still inside the time window.
+    int64_t oldest = now / 1000000 - config.windowDuration.count();
+    size_t calls = 0, failures = 0, slowCalls = 0;
+    for (size_t i = 0; i < config.windowSize; ++i) {
+        uint64_t entry = state.outcomes[i].load(std::memory_order_relaxed);
+        if (entry == 0 || outcomeMillis(entry) < oldest) continue;
+        ++calls;
+        if (entry & kFailed) ++failures;
+        if (entry & kSlow) ++slowCalls;
     }
+    if (calls < config.minimumCalls) return;
+    double failureRate = static_cast<double>(failures) / calls;
+    double slowRate = static_cast<double>(slowCalls) / calls;
+    if (failureRate < config.failureRateThreshold && slowRate < config.slowCallRateThreshold) return;
+
+    if (state.word.compare_exchange_strong(word, pack(Mode::Open, now), std::memory_order_acq_rel)) {
+        state.trips->inc();
+        state.openGauge->set(1);
+        LOG_ERROR("Circuit breaker OPEN for ", service, ": ", failures, "/", calls, " calls failed, ",
+                  slowCalls, "/", calls, " slower than ", config.slowCallDuration.count(), "ms");
+    }
+}
+
+CircuitBreaker::Mode CircuitBreaker::mode(const std::string& service) {
+    return modeOf(stateFor(service).word.load(std::memory_order_acquire));
 }
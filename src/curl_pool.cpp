@@ -0,0 +1,120 @@
+#include "curl_pool.hpp"
+#include <stdexcept>
+
+CurlHandlePool::Lease::~Lease() {
+    if (handle_) pool_->release(handle_);
+}
+
+CurlHandlePool& CurlHandlePool::instance() {
+    static CurlHandlePool pool;
+    return pool;
+}
+
+CurlHandlePool::CurlHandlePool() {
+    // Reference counted by libcurl, so this is safe alongside the CLI's own
+    // curl_global_init and keeps the server (which never calls it) correct.
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    share_ = curl_share_init();
+    if (!share_) {
+        throw std::runtime_error("Failed to initialize CURL share object");
+    }
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &CurlHandlePool::lockShare);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &CurlHandlePool::unlockShare);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+}
+
+CurlHandlePool::~CurlHandlePool() {
+    // Handles must let go of the share before it can be cleaned up.
+    for (CURL* handle : idle_) curl_easy_cleanup(handle);
+    idle_.clear();
+    curl_share_cleanup(share_);
+    curl_global_cleanup();
+}
+
+void CurlHandlePool::lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    static_cast<CurlHandlePool*>(userptr)->shareLocks_[data].lock();
+}
+
+void CurlHandlePool::unlockShare(CURL*, curl_lock_data data, void* userptr) {
+    static_cast<CurlHandlePool*>(userptr)->shareLocks_[data].unlock();
+}
+
+// Settings every pooled handle carries. Re-applied after curl_easy_reset,
+// which clears options but keeps the handle's live connections and caches.
+void CurlHandlePool::applyDefaults(CURL* handle) const {
+    curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+    // Probe idle connections so NATs and upstream load balancers don't drop
+    // them silently between requests to the same host.
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, 60L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, 30L);
+    // Don't reuse a connection that has sat idle longer than most upstream
+    // keep-alive timeouts; it would likely be reset mid-request.
+    curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN, 110L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+}
+
+CurlHandlePool::Lease CurlHandlePool::acquire() {
+    CURL* handle = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        if (!idle_.empty()) {
+            handle = idle_.back();
+            idle_.pop_back();
+        }
+    }
+
+    if (handle) {
+        handlesReused_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        handle = curl_easy_init();
+        if (!handle) {
+            throw std::runtime_error("Failed to initialize CURL");
+        }
+        handlesCreated_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    applyDefaults(handle);
+    return Lease(*this, handle);
+}
+
+void CurlHandlePool::release(CURL* handle) {
+    curl_easy_reset(handle);
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        if (idle_.size() < maxIdleHandles) {
+            idle_.push_back(handle);
+            return;
+        }
+    }
+    handlesDiscarded_.fetch_add(1, std::memory_order_relaxed);
+    curl_easy_cleanup(handle);
+}
+
+void CurlHandlePool::recordTransfer(CURL* handle) {
+    long newConnections = 0;
+    if (curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &newConnections) != CURLE_OK) return;
+    if (newConnections > 0) {
+        freshConnects_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        reusedConnects_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+CurlHandlePool::Stats CurlHandlePool::stats() const {
+    Stats s;
+    s.handlesCreated = handlesCreated_.load(std::memory_order_relaxed);
+    s.handlesReused = handlesReused_.load(std::memory_order_relaxed);
+    s.handlesDiscarded = handlesDiscarded_.load(std::memory_order_relaxed);
+    s.freshConnects = freshConnects_.load(std::memory_order_relaxed);
+    s.reusedConnects = reusedConnects_.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        s.idleHandles = idle_.size();
+    }
+    return s;
+}
@@ -1,4 +1,5 @@
 #include "date_utils.hpp"
+#include "fast_parse.hpp"
 
 namespace DateUtils {
 
@@ -23,20 +24,9 @@ bool isValidDate(int year, int month, int day, int minYear) {
 }
 
 bool isValidDateString(const std::string& date, int minYear) {
-    if (date.length() != 10 || date[4] != '-' || date[7] != '-') return false;
-
-    for (int i : {0, 1, 2, 3, 5, 6, 8, 9}) {
-        if (!isdigit(static_cast<unsigned char>(date[i]))) return false;
-    }
-
-    try {
-        int year = std::stoi(date.substr(0, 4));
-        int month = std::stoi(date.substr(5, 2));
-        int day = std::stoi(date.substr(8, 2));
-        return isValidDate(year, month, day, minYear);
-    } catch (...) {
-        return false;
-    }
+    std::tm parsed;
+    if (!FastParse::parseDate(date, parsed)) return false;
+    return isValidDate(parsed.tm_year + 1900, parsed.tm_mon + 1, parsed.tm_mday, minYear);
 }
 
 } // namespace DateUtils
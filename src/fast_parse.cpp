@@ -0,0 +1,109 @@
+#include "fast_parse.hpp"
+#include <charconv>
+
+namespace FastParse {
+
+namespace {
+
+// Exactly `width` ASCII digits starting at `pos`.
+bool digits(std::string_view text, size_t pos, size_t width, int& out) {
+    int value = 0;
+    for (size_t i = pos; i < pos + width; ++i) {
+        unsigned d = static_cast<unsigned char>(text[i]) - '0';
+        if (d > 9) return false;
+        value = value * 10 + static_cast<int>(d);
+    }
+    out = value;
+    return true;
+}
+
+bool scanDate(std::string_view text, int& year, int& month, int& day) {
+    if (text.size() < 10 || text[4] != '-' || text[7] != '-') return false;
+    return digits(text, 0, 4, year) && digits(text, 5, 2, month) && digits(text, 8, 2, day) &&
+           month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+bool scanTime(std::string_view text, int& hour, int& minute) {
+    if (text.size() < 5 || text[2] != ':') return false;
+    return digits(text, 0, 2, hour) && digits(text, 3, 2, minute) && hour <= 23 && minute <= 59;
+}
+
+} // namespace
+
+bool parseInt(std::string_view text, int& out) {
+    const char* end = text.data() + text.size();
+    int value;
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    if (ec != std::errc() || ptr != end) return false;
+    out = value;
+    return true;
+}
+
+bool parseDouble(std::string_view text, double& out) {
+    const char* end = text.data() + text.size();
+    double value;
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    if (ec != std::errc() || ptr != end) return false;
+    out = value;
+    return true;
+}
+
+bool parseDate(std::string_view text, std::tm& out) {
+    int year, month, day;
+    if (text.size() != 10 || !scanDate(text, year, month, day)) return false;
+    out = {};
+    out.tm_year = year - 1900;
+    out.tm_mon = month - 1;
+    out.tm_mday = day;
+    return true;
+}
+
+bool parseTime(std::string_view text, int& hour, int& minute) {
+    int h, m;
+    if (text.size() != 5 || !scanTime(text, h, m)) return false;
+    hour = h;
+    minute = m;
+    return true;
+}
+
+bool parseDateTime(std::string_view text, std::tm& out) {
+    int year, month, day, hour, minute, second = 0;
+    if ((text.size() != 16 && text.size() != 19) || text[10] != 'T' ||
+        !scanDate(text, year, month, day) || !scanTime(text.substr(11), hour, minute)) {
+        return false;
+    }
+    if (text.size() == 19 && (text[16] != ':' || !digits(text, 17, 2, second) || second > 60)) return false;
+    out = {};
+    out.tm_year = year - 1900;
+    out.tm_mon = month - 1;
+    out.tm_mday = day;
+    out.tm_hour = hour;
+    out.tm_min = minute;
+    out.tm_sec = second;
+    return true;
+}
+
+// Howard Hinnant's days_from_civil.
+int64_t daysFromCivil(int year, int month, int day) {
+    int64_t y = year - (month <= 2);
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// Howard Hinnant's civil_from_days.
+void civilFromDays(int64_t days, int& year, int& month, int& day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year = static_cast<int>(yoe + era * 400 + (month <= 2));
+}
+
+} // namespace FastParse
@@ -4,12 +4,26 @@
 #include <ctime>
 using namespace std;
 
-Flight::Flight(string airline, string flightNum, string depAirport,
-               string arrAirport, tm depTime, tm arrTime,
-               double price, int seats, string currency, string source)
-    : airline(airline), flightNumber(flightNum), departureAirport(depAirport),
-      arrivalAirport(arrAirport), departureTime(depTime), arrivalTime(arrTime),
-      price(price), availableSeats(seats), currency(currency), source(source) {}
+Flight::Flight(string_view airline, string_view flightNum, string_view depAirport,
+               string_view arrAirport, tm depTime, tm arrTime,
+               double price, int seats, string_view currency, string_view source,
+               allocator_type alloc)
+    : airline(airline, alloc), flightNumber(flightNum, alloc), departureAirport(depAirport, alloc),
+      arrivalAirport(arrAirport, alloc), departureTime(depTime), arrivalTime(arrTime),
+      price(price), availableSeats(seats), currency(currency, alloc), source(source, alloc) {}
+
+Flight::Flight(const Flight& other, allocator_type alloc)
+    : airline(other.airline, alloc), flightNumber(other.flightNumber, alloc),
+      departureAirport(other.departureAirport, alloc), arrivalAirport(other.arrivalAirport, alloc),
+      departureTime(other.departureTime), arrivalTime(other.arrivalTime), price(other.price),
+      availableSeats(other.availableSeats), currency(other.currency, alloc), source(other.source, alloc) {}
+
+Flight::Flight(Flight&& other, allocator_type alloc)
+    : airline(std::move(other.airline), alloc), flightNumber(std::move(other.flightNumber), alloc),
+      departureAirport(std::move(other.departureAirport), alloc),
+      arrivalAirport(std::move(other.arrivalAirport), alloc), departureTime(other.departureTime),
+      arrivalTime(other.arrivalTime), price(other.price), availableSeats(other.availableSeats),
+      currency(std::move(other.currency), alloc), source(std::move(other.source), alloc) {}
 
 void Flight::displayInfo() const {
     char depTimeStr[80], arrTimeStr[80];
@@ -31,14 +45,14 @@ void Flight::displayPrice() const {
 }
 
 // Getters implementation
-string Flight::getAirline() const { return airline; }
-string Flight::getFlightNumber() const { return flightNumber; }
-string Flight::getDepartureAirport() const { return departureAirport; }
-string Flight::getArrivalAirport() const { return arrivalAirport; }
+string_view Flight::getAirline() const { return airline; }
+string_view Flight::getFlightNumber() const { return flightNumber; }
+string_view Flight::getDepartureAirport() const { return departureAirport; }
+string_view Flight::getArrivalAirport() const { return arrivalAirport; }
 tm Flight::getDepartureTime() const { return departureTime; }
 tm Flight::getArrivalTime() const { return arrivalTime; }
 double Flight::getPrice() const { return price; }
 int Flight::getAvailableSeats() const { return availableSeats; }
-string Flight::getCurrency() const { return currency; }
-string Flight::getSource() const { return source; }
+string_view Flight::getCurrency() const { return currency; }
+string_view Flight::getSource() const { return source; }
 bool Flight::isBookable() const { return source == "amadeus"; }
\ No newline at end of file
@@ -1,74 +1,290 @@
 #include "flight_parser.hpp"
 #include "logger.hpp"
+#include "request_cost.hpp"
+#include "fast_parse.hpp"
 #include "json.hpp"
 #include <algorithm>
-#include <sstream>
-#include <iomanip>
+#include <cstdint>
 #include <stdexcept>
 
 using json = nlohmann::json;
 
-namespace FlightParser {
+namespace {
 
-std::vector<Flight> parseAmadeusFlightOffers(const std::string& response,
-                                             const std::string& currency) {
-    std::vector<Flight> flights;
-    try {
-        json responseJson = json::parse(response);
+// What the Amadeus parser keeps of one offer: the first itinerary's
+// segments, the price and the seat count. Everything else in the payload
+// (dictionaries, travelerPricings, fare details) is skipped unread.
+struct SegmentFields {
+    std::string carrier;
+    std::string number;
+    std::string departureIata;
+    std::string departureAt;
+    std::string arrivalIata;
+    std::string arrivalAt;
+    uint8_t seen = 0; // one bit per field above
+};
+
+struct OfferFields {
+    double price = 0;
+    bool hasPrice = false;
+    int seats = 1;
+    bool hasSegments = false;
+    bool malformed = false;
+    std::vector<SegmentFields> segments;
+};
+
+// SAX handler for a flight-offers response. Tracks where it is with a
+// stack of container kinds; any container it doesn't need is marked Skip
+// and everything inside it is ignored, so no DOM is ever built.
+class AmadeusOffersHandler : public nlohmann::json_sax<json> {
+public:
+    std::vector<OfferFields> offers;
+    bool sawData = false;
+    bool sawErrors = false;
+    std::string parseError;
+
+    bool null() override { return scalar(); }
+    bool boolean(bool) override { return scalar(); }
+    bool number_integer(number_integer_t value) override { return number(static_cast<double>(value)); }
+    bool number_unsigned(number_unsigned_t value) override { return number(static_cast<double>(value)); }
+    bool number_float(number_float_t value, const string_t&) override { return number(value); }
+    bool binary(binary_t&) override { return scalar(); }
+
+    bool string(string_t& value) override {
+        Kind at = top();
+        if (at == Kind::Price && key_ == Key::Total) {
+            OfferFields& offer = offers.back();
+            offer.hasPrice = FastParse::parseDouble(value, offer.price);
+            if (!offer.hasPrice) offer.malformed = true;
+        } else if (at == Kind::Segment || at == Kind::Departure || at == Kind::Arrival) {
+            storeSegmentField(at, value);
+        } else {
+            return scalar();
+        }
+        return true;
+    }
+
+    bool key(string_t& name) override {
+        key_ = classify(name);
+        return true;
+    }
 
-        if (!responseJson.contains("data")) {
-            if (responseJson.contains("errors")) {
-                throw std::runtime_error(responseJson["errors"].dump(2));
-            }
-            return flights;
+    bool start_object(std::size_t) override {
+        Kind parent = stack_.empty() ? Kind::None : top();
+        Kind kind = Kind::Skip;
+        switch (parent) {
+            case Kind::None: kind = Kind::Root; break;
+            case Kind::Data:
+                offers.emplace_back();
+                kind = Kind::Offer;
+                break;
+            case Kind::Offer:
+                if (key_ == Key::Price) kind = Kind::Price;
+                else if (isWanted()) offers.back().malformed = true;
+                break;
+            case Kind::Itineraries:
+                // Only the outbound itinerary becomes flights.
+                if (itineraryIndex_++ == 0) kind = Kind::Itinerary;
+                break;
+            case Kind::Segments:
+                offers.back().segments.emplace_back();
+                kind = Kind::Segment;
+                break;
+            case Kind::Segment:
+                if (key_ == Key::Departure) kind = Kind::Departure;
+                else if (key_ == Key::Arrival) kind = Kind::Arrival;
+                else if (isWanted()) offers.back().malformed = true;
+                break;
+            default: break;
         }
+        stack_.push_back(kind);
+        return true;
+    }
 
-        auto offers = responseJson["data"];
-        std::sort(offers.begin(), offers.end(),
-             [](const json& a, const json& b) {
-                 return std::stod(a["price"]["total"].get<std::string>()) <
-                        std::stod(b["price"]["total"].get<std::string>());
-             });
-
-        size_t numOffers = std::min(size_t(10), offers.size());
-        for (size_t i = 0; i < numOffers; ++i) {
-            try {
-                const auto& offer = offers[i];
-                const auto& itinerary = offer.at("itineraries").at(0);
-
-                for (const auto& segment : itinerary.at("segments")) {
-                    std::string airline = segment.at("carrierCode").get<std::string>();
-                    std::string flightNumber = segment.at("number").get<std::string>();
-                    std::string depAirport = segment.at("departure").at("iataCode").get<std::string>();
-                    std::string arrAirport = segment.at("arrival").at("iataCode").get<std::string>();
-                    std::string depTime = segment.at("departure").at("at").get<std::string>();
-                    std::string arrTime = segment.at("arrival").at("at").get<std::string>();
-                    double price = std::stod(offer.at("price").at("total").get<std::string>());
-                    int availableSeats = offer.value("numberOfBookableSeats", 1);
-
-                    tm departure = {}, arrival = {};
-                    std::istringstream(depTime) >> std::get_time(&departure, "%Y-%m-%dT%H:%M:%S");
-                    std::istringstream(arrTime) >> std::get_time(&arrival, "%Y-%m-%dT%H:%M:%S");
-
-                    flights.emplace_back(airline, flightNumber, depAirport, arrAirport,
-                                       departure, arrival, price, availableSeats, currency);
-                }
-            } catch (const std::exception& e) {
-                Logger::warn(std::string("Skipping malformed flight offer: ") + e.what());
-                continue;
-            }
+    bool start_array(std::size_t) override {
+        Kind parent = stack_.empty() ? Kind::None : top();
+        Kind kind = Kind::Skip;
+        if (parent == Kind::Root && key_ == Key::Data) {
+            sawData = true;
+            kind = Kind::Data;
+        } else if (parent == Kind::Root && key_ == Key::Errors) {
+            sawErrors = true;
+        } else if (parent == Kind::Offer && key_ == Key::Itineraries) {
+            itineraryIndex_ = 0;
+            kind = Kind::Itineraries;
+        } else if (parent == Kind::Itinerary && key_ == Key::Segments) {
+            offers.back().hasSegments = true;
+            kind = Kind::Segments;
+        } else if (isWanted() && parent != Kind::Skip && parent != Kind::None) {
+            if (!offers.empty()) offers.back().malformed = true;
+        }
+        stack_.push_back(kind);
+        return true;
+    }
+
+    bool end_object() override {
+        if (top() == Kind::Segment && offers.back().segments.back().seen != allSegmentFields) {
+            offers.back().malformed = true;
+        }
+        stack_.pop_back();
+        return true;
+    }
+
+    bool end_array() override {
+        stack_.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) override {
+        parseError = e.what();
+        return false;
+    }
+
+private:
+    enum class Kind : uint8_t {
+        None, Root, Data, Offer, Price, Itineraries, Itinerary, Segments, Segment, Departure, Arrival, Skip
+    };
+    enum class Key : uint8_t {
+        Other, Data, Errors, Price, Total, Seats, Itineraries, Segments,
+        CarrierCode, Number, Departure, Arrival, IataCode, At
+    };
+    static constexpr uint8_t allSegmentFields = 0x3f;
+
+    static Key classify(const string_t& name) {
+        static const std::pair<const char*, Key> keys[] = {
+            {"data", Key::Data}, {"errors", Key::Errors}, {"price", Key::Price}, {"total", Key::Total},
+            {"numberOfBookableSeats", Key::Seats}, {"itineraries", Key::Itineraries},
+            {"segments", Key::Segments}, {"carrierCode", Key::CarrierCode}, {"number", Key::Number},
+            {"departure", Key::Departure}, {"arrival", Key::Arrival}, {"iataCode", Key::IataCode},
+            {"at", Key::At},
+        };
+        for (const auto& [text, key] : keys) {
+            if (name == text) return key;
+        }
+        return Key::Other;
+    }
+
+    Kind top() const { return stack_.back(); }
+
+    // A field we need arrived with the wrong JSON type.
+    bool isWanted() const {
+        switch (top()) {
+            case Kind::Offer: return key_ == Key::Price || key_ == Key::Itineraries;
+            case Kind::Price: return key_ == Key::Total;
+            case Kind::Itinerary: return key_ == Key::Segments;
+            case Kind::Segment:
+                return key_ == Key::CarrierCode || key_ == Key::Number || key_ == Key::Departure ||
+                       key_ == Key::Arrival;
+            case Kind::Departure:
+            case Kind::Arrival: return key_ == Key::IataCode || key_ == Key::At;
+            default: return false;
         }
-    } catch (const json::exception& e) {
-        throw std::runtime_error("Error parsing flight offers: " + std::string(e.what()));
     }
 
+    bool scalar() {
+        if (!stack_.empty() && isWanted()) offers.back().malformed = true;
+        return true;
+    }
+
+    bool number(double value) {
+        if (!stack_.empty() && top() == Kind::Offer && key_ == Key::Seats) {
+            offers.back().seats = static_cast<int>(value);
+            return true;
+        }
+        return scalar();
+    }
+
+    void storeSegmentField(Kind at, const string_t& value) {
+        SegmentFields& segment = offers.back().segments.back();
+        auto store = [&](std::string& field, uint8_t bit) {
+            field.assign(value);
+            segment.seen |= bit;
+        };
+        if (at == Kind::Segment) {
+            if (key_ == Key::CarrierCode) store(segment.carrier, 0x01);
+            else if (key_ == Key::Number) store(segment.number, 0x02);
+        } else if (at == Kind::Departure) {
+            if (key_ == Key::IataCode) store(segment.departureIata, 0x04);
+            else if (key_ == Key::At) store(segment.departureAt, 0x08);
+        } else {
+            if (key_ == Key::IataCode) store(segment.arrivalIata, 0x10);
+            else if (key_ == Key::At) store(segment.arrivalAt, 0x20);
+        }
+    }
+
+    std::vector<Kind> stack_;
+    Key key_ = Key::Other;
+    int itineraryIndex_ = 0;
+};
+
+} // namespace
+
+namespace FlightParser {
+
+FlightTable parseAmadeusFlightOffers(const std::string& response,
+                                     const std::string& currency,
+                                     size_t maxOffers) {
+    PhaseTimer timer(RequestCost::Phase::Parse);
+    AmadeusOffersHandler handler;
+    if (!json::sax_parse(response, &handler)) {
+        throw std::runtime_error("Error parsing flight offers: " + handler.parseError);
+    }
+
+    FlightTable flights(currency, "amadeus");
+    if (!handler.sawData) {
+        if (handler.sawErrors) {
+            // Rare path: build the DOM just to report Amadeus' own message.
+            throw std::runtime_error(json::parse(response)["errors"].dump(2));
+        }
+        return flights;
+    }
+
+    // Select on a compact (price, position) index rather than moving the
+    // offers themselves: O(n) to find the cheapest maxOffers, then only
+    // those are sorted and materialized. Position breaks price ties, so
+    // equal fares keep Amadeus' order.
+    const std::vector<OfferFields>& offers = handler.offers;
+    std::vector<std::pair<double, uint32_t>> byPrice;
+    byPrice.reserve(offers.size());
+    for (size_t i = 0; i < offers.size(); ++i) {
+        const OfferFields& offer = offers[i];
+        if (offer.malformed || !offer.hasPrice || !offer.hasSegments) continue;
+        byPrice.emplace_back(offer.price, static_cast<uint32_t>(i));
+    }
+    if (size_t skipped = offers.size() - byPrice.size()) {
+        LOG_WARN("Skipping ", skipped, " malformed flight offer(s)");
+    }
+
+    size_t keep = std::min(maxOffers, byPrice.size());
+    if (keep < byPrice.size()) {
+        std::nth_element(byPrice.begin(), byPrice.begin() + keep, byPrice.end());
+        byPrice.resize(keep);
+    }
+    std::sort(byPrice.begin(), byPrice.end());
+
+    size_t segments = 0;
+    for (const auto& [price, index] : byPrice) segments += offers[index].segments.size();
+    flights.reserve(segments);
+    for (const auto& [price, index] : byPrice) {
+        const OfferFields& offer = offers[index];
+        for (const SegmentFields& segment : offer.segments) {
+            tm departure = {}, arrival = {};
+            FastParse::parseDateTime(segment.departureAt, departure);
+            FastParse::parseDateTime(segment.arrivalAt, arrival);
+
+            flights.add(segment.carrier, segment.number, segment.departureIata, segment.arrivalIata,
+                        FlightTable::toEpoch(departure), FlightTable::toEpoch(arrival),
+                        FlightTable::toMinorUnits(offer.price), offer.seats);
+        }
+    }
     return flights;
 }
 
-std::vector<Flight> parseEstimatedFlights(const std::string& payload,
-                                          const std::string& date,
-                                          const std::string& currency) {
-    std::vector<Flight> flights;
+FlightTable parseEstimatedFlights(const std::string& payload,
+                                  const std::string& date,
+                                  const std::string& currency) {
+    PhaseTimer timer(RequestCost::Phase::Parse);
+    FlightTable flights(currency, "estimate");
     json parsed;
     try {
         parsed = json::parse(payload);
@@ -94,21 +310,20 @@ std::vector<Flight> parseEstimatedFlights(const std::string& payload,
             // The model is asked for HH:MM local times; combine with the
             // requested travel date to get a full timestamp.
             tm departure = {}, arrival = {};
-            std::istringstream(date + "T" + depTime) >> std::get_time(&departure, "%Y-%m-%dT%H:%M");
-            std::istringstream(date + "T" + arrTime) >> std::get_time(&arrival, "%Y-%m-%dT%H:%M");
+            if (FastParse::parseDate(date, departure)) arrival = departure;
+            FastParse::parseTime(depTime, departure.tm_hour, departure.tm_min);
+            FastParse::parseTime(arrTime, arrival.tm_hour, arrival.tm_min);
 
-            flights.emplace_back(airline, flightNumber, depAirport, arrAirport,
-                                 departure, arrival, price, seats, currency, "estimate");
+            flights.add(airline, flightNumber, depAirport, arrAirport,
+                        FlightTable::toEpoch(departure), FlightTable::toEpoch(arrival),
+                        FlightTable::toMinorUnits(price), seats);
         } catch (const std::exception& e) {
-            Logger::warn(std::string("Skipping malformed estimated flight: ") + e.what());
+            LOG_WARN("Skipping malformed estimated flight: ", e.what());
             continue;
         }
     }
 
-    std::sort(flights.begin(), flights.end(), [](const Flight& a, const Flight& b) {
-        return a.getPrice() < b.getPrice();
-    });
-
+    flights.sortByPrice();
     return flights;
 }
 
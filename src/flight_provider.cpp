@@ -1,14 +1,23 @@
 #include "flight_provider.hpp"
 #include "flight_parser.hpp"
+#include "gemini_parser.hpp"
 #include "logger.hpp"
+#include "tracing.hpp"
+#include "request_cost.hpp"
+#include "fast_parse.hpp"
+#include "upstream_error.hpp"
 #include "json.hpp"
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <ctime>
 #include <functional>
-#include <iomanip>
+#include <future>
+#include <mutex>
 #include <random>
-#include <sstream>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 using json = nlohmann::json;
 
@@ -17,13 +26,24 @@ namespace {
 // Builds a tm for `date` (YYYY-MM-DD) at the given hour/minute.
 tm makeTime(const std::string& date, int hour, int minute) {
     tm t = {};
-    std::istringstream(date) >> std::get_time(&t, "%Y-%m-%d");
+    FastParse::parseDate(date, t);
     t.tm_hour = hour;
     t.tm_min = minute;
     t.tm_sec = 0;
     return t;
 }
 
+// Wraps `fn` to run under the calling thread's request cost and trace,
+// whichever thread eventually calls it.
+template <typename Fn>
+auto inCallerContext(Fn fn) {
+    return [fn = std::move(fn), cost = RequestCost::current(), trace = Tracer::current()](auto&&... args) {
+        RequestCostScope charge(cost);
+        ScopedSpanContext adopt(trace);
+        return fn(std::forward<decltype(args)>(args)...);
+    };
+}
+
 // ---------------------------------------------------------------------------
 // Amadeus: real GDS inventory. Preferred when credentials are available.
 // ---------------------------------------------------------------------------
@@ -34,12 +54,99 @@ public:
     std::string name() const override { return "amadeus"; }
     bool isLiveInventory() const override { return true; }
 
-    std::vector<Flight> search(const std::string& from, const std::string& to,
-                               const std::string& date, int passengers) override {
-        std::string token = fetchToken();
-        std::string fromIATA = config_.resolveIATA(from);
-        std::string toIATA = config_.resolveIATA(to);
+    FlightTable search(const std::string& from, const std::string& to,
+                       const std::string& date, int passengers) override {
+        // The token and the two airport codes don't depend on each other, so
+        // fetch them concurrently: a cold search then waits for the slowest
+        // of the three lookups instead of their sum.
+        Span span("AmadeusFlightProvider::search");
+        SpanContext trace = span.context();
+        std::shared_ptr<RequestCost> cost = RequestCost::current();
+        auto fromFuture = std::async(std::launch::async, [&, trace, cost] {
+            ScopedSpanContext adopt(trace);
+            RequestCostScope charge(cost);
+            return config_.resolveIATA(from);
+        });
+        auto toFuture = std::async(std::launch::async, [&, trace, cost] {
+            ScopedSpanContext adopt(trace);
+            RequestCostScope charge(cost);
+            return config_.resolveIATA(to);
+        });
+        std::string token = accessToken();
+        std::string fromIATA = fromFuture.get();
+        std::string toIATA = toFuture.get();
+
+        std::string body = offersRequest(fromIATA, toIATA, date, passengers);
+        std::string response;
+        try {
+            response = config_.httpRequest(config_.amadeusFlightUrl, "POST", body, token);
+        } catch (const HttpError& e) {
+            // Revoked or expired early on Amadeus' side: drop it and retry
+            // once with a fresh token rather than failing the search.
+            if (e.status() != 401) throw;
+            invalidateToken(token);
+            response = config_.httpRequest(config_.amadeusFlightUrl, "POST", body, accessToken());
+        }
+        return FlightParser::parseAmadeusFlightOffers(response, config_.currency, config_.flightResultLimit);
+    }
+
+    // search() over the async hooks: the same three concurrent lookups,
+    // but whichever finishes last sends the offers request, so no thread
+    // waits on Amadeus at any point.
+    void searchAsync(const std::string& from, const std::string& to, const std::string& date,
+                     int passengers, SearchCallback done) override {
+        if (!config_.httpRequestAsync) {
+            FlightProvider::searchAsync(from, to, date, passengers, std::move(done));
+            return;
+        }
+        auto span = std::make_shared<AsyncSpan>("AmadeusFlightProvider::search");
+        ScopedSpanContext scope(span->context());
+        SearchCallback finish = [span, done = std::move(done)](std::exception_ptr error, FlightTable flights) {
+            span->end(error != nullptr);
+            done(error, std::move(flights));
+        };
 
+        auto lookups = std::make_shared<Lookups>();
+        auto arrive = [this, lookups, finish, date, passengers](std::string Lookups::*slot) {
+            return inCallerContext([this, lookups, finish, date, passengers, slot](std::exception_ptr error,
+                                                                                   std::string value) {
+                {
+                    std::lock_guard<std::mutex> lock(lookups->mutex);
+                    if (error && !lookups->error) lookups->error = error;
+                    (*lookups).*slot = std::move(value);
+                    if (--lookups->pending > 0) return;
+                }
+                if (lookups->error) return finish(lookups->error, FlightTable());
+                postOffers(offersRequest(lookups->fromIATA, lookups->toIATA, date, passengers),
+                           lookups->token, false, finish);
+            });
+        };
+        withAccessToken(arrive(&Lookups::token));
+        resolveIATA(from, arrive(&Lookups::fromIATA));
+        resolveIATA(to, arrive(&Lookups::toIATA));
+    }
+
+    ~AmadeusFlightProvider() override {
+        std::unique_lock<std::mutex> lock(tokenMutex_);
+        tokenFetched_.wait(lock, [this] { return !fetching_; });
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using TokenCallback = FlightProviderConfig::Callback;
+
+    // What an async search collects before it can ask for offers.
+    struct Lookups {
+        std::mutex mutex;
+        int pending = 3;
+        std::exception_ptr error;
+        std::string token;
+        std::string fromIATA;
+        std::string toIATA;
+    };
+
+    std::string offersRequest(const std::string& fromIATA, const std::string& toIATA,
+                              const std::string& date, int passengers) const {
         json requestBody = {
             {"currencyCode", config_.currency},
             {"originDestinations", {{
@@ -51,7 +158,7 @@ public:
             {"travelers", json::array()},
             {"sources", {"GDS"}},
             {"searchCriteria", {
-                {"maxFlightOffers", 10},
+                {"maxFlightOffers", config_.amadeusMaxOffers},
                 {"flightFilters", {
                     {"cabinRestrictions", {{
                         {"cabin", "ECONOMY"},
@@ -68,26 +175,168 @@ public:
                 {"travelerType", "ADULT"}
             });
         }
+        return requestBody.dump();
+    }
 
-        std::string response = config_.httpRequest(config_.amadeusFlightUrl, "POST",
-                                                   requestBody.dump(), token);
-        return FlightParser::parseAmadeusFlightOffers(response, config_.currency);
+    // The offers call of searchAsync, with search()'s one retry on a 401.
+    void postOffers(const std::string& body, const std::string& token, bool reauthenticated,
+                    SearchCallback done) {
+        config_.httpRequestAsync(config_.amadeusFlightUrl, "POST", body, token, inCallerContext(
+            [this, body, token, reauthenticated, done](std::exception_ptr error, std::string response) {
+                if (error && !reauthenticated && isUnauthorized(error)) {
+                    invalidateToken(token);
+                    withAccessToken(inCallerContext([this, body, done](std::exception_ptr error, std::string fresh) {
+                        if (error) return done(error, FlightTable());
+                        postOffers(body, fresh, true, done);
+                    }));
+                    return;
+                }
+                FlightTable flights;
+                if (!error) {
+                    try {
+                        flights = FlightParser::parseAmadeusFlightOffers(response, config_.currency,
+                                                                         config_.flightResultLimit);
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                }
+                done(error, std::move(flights));
+            }));
     }
 
-private:
-    std::string fetchToken() {
+    void resolveIATA(const std::string& city, FlightProviderConfig::Callback done) {
+        if (config_.resolveIATAAsync) return config_.resolveIATAAsync(city, std::move(done));
+        std::string code;
+        try {
+            code = config_.resolveIATA(city);
+        } catch (...) {
+            return done(std::current_exception(), "");
+        }
+        done(nullptr, std::move(code));
+    }
+
+    static bool isUnauthorized(std::exception_ptr error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const HttpError& e) {
+            return e.status() == 401;
+        } catch (...) {
+            return false;
+        }
+    }
+
+    // Returns a usable OAuth token; see withAccessToken.
+    std::string accessToken() {
+        auto token = std::make_shared<std::promise<std::string>>();
+        std::future<std::string> result = token->get_future();
+        withAccessToken([token](std::exception_ptr error, std::string value) {
+            if (error) token->set_exception(error);
+            else token->set_value(std::move(value));
+        });
+        return result.get();
+    }
+
+    // Hands `done` a usable OAuth token. In steady state this is the cached
+    // one, immediately; once it is within amadeusTokenRefreshAhead of
+    // expiry a refresh starts in the background and callers keep the
+    // current token meanwhile. Only with no valid token at all is `done`
+    // queued, and then all queued callers share a single fetch.
+    void withAccessToken(TokenCallback done) {
+        std::unique_lock<std::mutex> lock(tokenMutex_);
+        Clock::time_point now = Clock::now();
+        bool valid = !token_.empty() && now < expiresAt_;
+        if (!valid) waiters_.push_back(std::move(done));
+        bool fetch = (!valid || now >= refreshAt_) && !fetching_;
+        if (fetch) fetching_ = true;
+        std::string token = valid ? token_ : std::string();
+        lock.unlock();
+
+        if (fetch) startFetch();
+        if (valid) done(nullptr, std::move(token));
+    }
+
+    void invalidateToken(const std::string& rejected) {
+        std::lock_guard<std::mutex> lock(tokenMutex_);
+        if (token_ == rejected) token_.clear();
+    }
+
+    // Caller has set fetching_. Traced and charged to the search that
+    // triggered it; later searches that reuse the token don't wait on it.
+    void startFetch() {
+        auto span = std::make_shared<AsyncSpan>("AmadeusFlightProvider::fetchToken");
+        Clock::time_point requestedAt = Clock::now();
+        TokenCallback finish = [this, span, requestedAt](std::exception_ptr error, std::string response) {
+            std::pair<std::string, std::chrono::seconds> grant;
+            if (!error) {
+                try {
+                    grant = parseGrant(response);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            std::vector<TokenCallback> waiters;
+            {
+                std::lock_guard<std::mutex> lock(tokenMutex_);
+                if (!error) {
+                    token_ = grant.first;
+                    // Measured from when we asked, so we never overestimate.
+                    expiresAt_ = requestedAt + grant.second;
+                    refreshAt_ = expiresAt_ - std::min(config_.amadeusTokenRefreshAhead, grant.second);
+                }
+                fetching_ = false;
+                waiters.swap(waiters_);
+                // Under the lock, so the destructor can't finish first.
+                tokenFetched_.notify_all();
+            }
+            span->end(error != nullptr);
+            for (auto& waiter : waiters) waiter(error, grant.first);
+        };
+
         std::string payload = "grant_type=client_credentials&"
                               "client_id=" + config_.amadeusClientId + "&"
                               "client_secret=" + config_.amadeusClientSecret;
-        std::string response = config_.httpRequest(config_.amadeusTokenUrl, "POST", payload, "");
+        ScopedSpanContext scope(span->context());
+        if (config_.httpRequestAsync) {
+            config_.httpRequestAsync(config_.amadeusTokenUrl, "POST", payload, "", std::move(finish));
+            return;
+        }
+        // Only a blocking client: give the fetch its own thread, so searches
+        // that still hold a valid token never wait for the refresh.
+        std::thread([this, payload, finish, trace = span->context(), cost = RequestCost::current()] {
+            ScopedSpanContext adopt(trace);
+            RequestCostScope charge(cost);
+            std::string response;
+            std::exception_ptr error;
+            try {
+                response = config_.httpRequest(config_.amadeusTokenUrl, "POST", payload, "");
+            } catch (...) {
+                error = std::current_exception();
+            }
+            finish(error, std::move(response));
+        }).detach();
+    }
+
+    // Token plus its lifetime from the response's expires_in.
+    static std::pair<std::string, std::chrono::seconds> parseGrant(const std::string& response) {
         json j = json::parse(response);
         if (!j.contains("access_token")) {
             throw std::runtime_error("No access_token in Amadeus response");
         }
-        return j["access_token"].get<std::string>();
+        // Without expires_in we can't know how long the token lives, so it
+        // is used once and never cached.
+        std::chrono::seconds lifetime{j.value("expires_in", 0)};
+        return {j["access_token"].get<std::string>(), lifetime};
     }
 
     FlightProviderConfig config_;
+
+    std::mutex tokenMutex_;
+    std::condition_variable tokenFetched_;
+    std::string token_;
+    Clock::time_point expiresAt_{};
+    Clock::time_point refreshAt_{};
+    bool fetching_ = false;
+    std::vector<TokenCallback> waiters_;
 };
 
 // ---------------------------------------------------------------------------
@@ -103,8 +352,42 @@ public:
     std::string name() const override { return "gemini"; }
     bool isLiveInventory() const override { return false; }
 
-    std::vector<Flight> search(const std::string& from, const std::string& to,
-                               const std::string& date, int passengers) override {
+    FlightTable search(const std::string& from, const std::string& to,
+                       const std::string& date, int passengers) override {
+        Span span("GeminiFlightProvider::search");
+        std::string response = config_.httpRequest(url(), "POST", requestBody(from, to, date, passengers), "");
+        return parse(response, date);
+    }
+
+    void searchAsync(const std::string& from, const std::string& to, const std::string& date,
+                     int passengers, SearchCallback done) override {
+        if (!config_.httpRequestAsync) {
+            FlightProvider::searchAsync(from, to, date, passengers, std::move(done));
+            return;
+        }
+        auto span = std::make_shared<AsyncSpan>("GeminiFlightProvider::search");
+        ScopedSpanContext scope(span->context());
+        config_.httpRequestAsync(url(), "POST", requestBody(from, to, date, passengers), "",
+                                 [this, span, date, done = std::move(done)](std::exception_ptr error,
+                                                                            std::string response) {
+            FlightTable flights;
+            if (!error) {
+                try {
+                    flights = parse(response, date);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            span->end(error != nullptr);
+            done(error, std::move(flights));
+        });
+    }
+
+private:
+    std::string url() const { return config_.geminiApiUrl + "?key=" + config_.geminiApiKey; }
+
+    std::string requestBody(const std::string& from, const std::string& to,
+                            const std::string& date, int passengers) const {
         std::string prompt =
             "List 5 realistic economy flight options from " + from + " to " + to +
             " on " + date + " for " + std::to_string(passengers) + " passenger(s). "
@@ -140,19 +423,14 @@ public:
             }}
         };
 
-        std::string url = config_.geminiApiUrl + "?key=" + config_.geminiApiKey;
-        std::string response = config_.httpRequest(url, "POST", request.dump(), "");
-
-        json responseJson = json::parse(response);
-        if (!responseJson.contains("candidates") || responseJson["candidates"].empty()) {
-            throw std::runtime_error("Invalid Gemini response structure");
-        }
+        return request.dump();
+    }
 
-        std::string text = responseJson["candidates"][0]["content"]["parts"][0]["text"];
-        return FlightParser::parseEstimatedFlights(text, date, config_.currency);
+    FlightTable parse(const std::string& response, const std::string& date) const {
+        return FlightParser::parseEstimatedFlights(GeminiParser::candidateText(response), date,
+                                                   config_.currency);
     }
 
-private:
     FlightProviderConfig config_;
 };
 
@@ -168,8 +446,9 @@ public:
     std::string name() const override { return "mock"; }
     bool isLiveInventory() const override { return false; }
 
-    std::vector<Flight> search(const std::string& from, const std::string& to,
-                               const std::string& date, int passengers) override {
+    FlightTable search(const std::string& from, const std::string& to,
+                       const std::string& date, int passengers) override {
+        Span span("MockFlightProvider::search");
         // Seed from the query so the same search always yields the same
         // results - stable demos and reproducible tests.
         std::seed_seq seed{std::hash<std::string>{}(from + "|" + to + "|" + date)};
@@ -186,24 +465,20 @@ public:
         std::string fromCode = toCode(from);
         std::string toCode_ = toCode(to);
 
-        std::vector<Flight> flights;
+        FlightTable flights(config_.currency, "mock");
+        flights.reserve(carriers.size());
         for (size_t i = 0; i < carriers.size(); ++i) {
             int depHour = 6 + static_cast<int>(i) * 3;
             int duration = durationDist(rng);
             tm departure = makeTime(date, depHour, 25);
             tm arrival = makeTime(date, (depHour + duration) % 24, 15);
 
-            flights.emplace_back(carriers[i].first,
-                                 std::to_string(1000 + static_cast<int>(i) * 111),
-                                 fromCode, toCode_, departure, arrival,
-                                 static_cast<double>(priceDist(rng)),
-                                 std::max(seatDist(rng), passengers),
-                                 config_.currency, "mock");
+            flights.add(carriers[i].first, std::to_string(1000 + static_cast<int>(i) * 111),
+                        fromCode, toCode_, FlightTable::toEpoch(departure), FlightTable::toEpoch(arrival),
+                        FlightTable::toMinorUnits(priceDist(rng)), std::max(seatDist(rng), passengers));
         }
 
-        std::sort(flights.begin(), flights.end(), [](const Flight& a, const Flight& b) {
-            return a.getPrice() < b.getPrice();
-        });
+        flights.sortByPrice();
         return flights;
     }
 
@@ -224,6 +499,17 @@ private:
 
 } // namespace
 
+void FlightProvider::searchAsync(const std::string& from, const std::string& to, const std::string& date,
+                                 int passengers, SearchCallback done) {
+    FlightTable flights;
+    try {
+        flights = search(from, to, date, passengers);
+    } catch (...) {
+        return done(std::current_exception(), FlightTable());
+    }
+    done(nullptr, std::move(flights));
+}
+
 std::unique_ptr<FlightProvider> makeFlightProvider(const std::string& preference,
                                                    const FlightProviderConfig& config) {
     bool hasAmadeus = !config.amadeusClientId.empty() && !config.amadeusClientSecret.empty();
@@ -0,0 +1,161 @@
+#include "flight_table.hpp"
+#include "fast_parse.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+Flight FlightTable::Row::toFlight() const {
+    return Flight(getAirline(), getFlightNumber(), getDepartureAirport(), getArrivalAirport(),
+                  getDepartureTime(), getArrivalTime(), getPrice(), getAvailableSeats(),
+                  getCurrency(), getSource());
+}
+
+FlightTable::FlightTable(std::string_view currency, std::string_view source, allocator_type alloc)
+    : currency_(currency, alloc), source_(source, alloc), codes_(alloc), airline_(alloc),
+      departureAirport_(alloc), arrivalAirport_(alloc), flightNumbers_(alloc), flightNumberEnd_(alloc),
+      departureTime_(alloc), arrivalTime_(alloc), priceMinor_(alloc), seats_(alloc) {}
+
+FlightTable::FlightTable(const FlightTable& other, allocator_type alloc)
+    : currency_(other.currency_, alloc), source_(other.source_, alloc), codes_(other.codes_, alloc),
+      airline_(other.airline_, alloc), departureAirport_(other.departureAirport_, alloc),
+      arrivalAirport_(other.arrivalAirport_, alloc), flightNumbers_(other.flightNumbers_, alloc),
+      flightNumberEnd_(other.flightNumberEnd_, alloc), departureTime_(other.departureTime_, alloc),
+      arrivalTime_(other.arrivalTime_, alloc), priceMinor_(other.priceMinor_, alloc),
+      seats_(other.seats_, alloc) {}
+
+void FlightTable::reserve(size_t rows) {
+    airline_.reserve(rows);
+    departureAirport_.reserve(rows);
+    arrivalAirport_.reserve(rows);
+    flightNumbers_.reserve(rows * 4);
+    flightNumberEnd_.reserve(rows);
+    departureTime_.reserve(rows);
+    arrivalTime_.reserve(rows);
+    priceMinor_.reserve(rows);
+    seats_.reserve(rows);
+}
+
+void FlightTable::add(std::string_view airline, std::string_view flightNumber,
+                      std::string_view departureAirport, std::string_view arrivalAirport,
+                      int64_t departureEpoch, int64_t arrivalEpoch, int64_t priceMinor, int seats) {
+    airline_.push_back(intern(airline));
+    departureAirport_.push_back(intern(departureAirport));
+    arrivalAirport_.push_back(intern(arrivalAirport));
+    flightNumbers_.append(flightNumber);
+    flightNumberEnd_.push_back(static_cast<uint32_t>(flightNumbers_.size()));
+    departureTime_.push_back(departureEpoch);
+    arrivalTime_.push_back(arrivalEpoch);
+    priceMinor_.push_back(priceMinor);
+    seats_.push_back(seats);
+}
+
+// A result set names a handful of carriers and airports, so a linear scan
+// of the dictionary beats hashing.
+uint16_t FlightTable::intern(std::string_view code) {
+    for (size_t id = 0; id < codes_.size(); ++id) {
+        if (codes_[id] == code) return static_cast<uint16_t>(id);
+    }
+    if (codes_.size() > UINT16_MAX) throw std::length_error("FlightTable: too many distinct codes");
+    codes_.emplace_back(code);
+    return static_cast<uint16_t>(codes_.size() - 1);
+}
+
+std::string_view FlightTable::flightNumber(size_t i) const {
+    uint32_t begin = i == 0 ? 0 : flightNumberEnd_[i - 1];
+    return std::string_view(flightNumbers_).substr(begin, flightNumberEnd_[i] - begin);
+}
+
+void FlightTable::sortByPrice() {
+    std::pmr::vector<uint32_t> order(size(), get_allocator());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [this](uint32_t a, uint32_t b) { return priceMinor_[a] < priceMinor_[b]; });
+    gather(order);
+}
+
+void FlightTable::truncate(size_t rows) {
+    if (rows >= size()) return;
+    airline_.resize(rows);
+    departureAirport_.resize(rows);
+    arrivalAirport_.resize(rows);
+    flightNumbers_.resize(rows == 0 ? 0 : flightNumberEnd_[rows - 1]);
+    flightNumberEnd_.resize(rows);
+    departureTime_.resize(rows);
+    arrivalTime_.resize(rows);
+    priceMinor_.resize(rows);
+    seats_.resize(rows);
+}
+
+namespace {
+
+template <typename T>
+void permute(std::pmr::vector<T>& column, const std::pmr::vector<uint32_t>& order) {
+    std::pmr::vector<T> out(column.get_allocator());
+    out.reserve(order.size());
+    for (uint32_t i : order) out.push_back(column[i]);
+    column.swap(out);
+}
+
+} // namespace
+
+void FlightTable::gather(const std::pmr::vector<uint32_t>& order) {
+    std::pmr::string numbers(get_allocator());
+    std::pmr::vector<uint32_t> numberEnd(get_allocator());
+    numbers.reserve(flightNumbers_.size());
+    numberEnd.reserve(order.size());
+    for (uint32_t i : order) {
+        numbers.append(flightNumber(i));
+        numberEnd.push_back(static_cast<uint32_t>(numbers.size()));
+    }
+    flightNumbers_.swap(numbers);
+    flightNumberEnd_.swap(numberEnd);
+
+    permute(airline_, order);
+    permute(departureAirport_, order);
+    permute(arrivalAirport_, order);
+    permute(departureTime_, order);
+    permute(arrivalTime_, order);
+    permute(priceMinor_, order);
+    permute(seats_, order);
+}
+
+std::vector<Flight> FlightTable::toFlights() const {
+    std::vector<Flight> flights;
+    flights.reserve(size());
+    for (Row row : *this) flights.push_back(row.toFlight());
+    return flights;
+}
+
+size_t FlightTable::memoryBytes() const {
+    size_t bytes = sizeof(*this) + currency_.capacity() + source_.capacity() + flightNumbers_.capacity();
+    for (const std::pmr::string& code : codes_) bytes += sizeof(code) + code.capacity();
+    bytes += size() * (3 * sizeof(uint16_t) + sizeof(uint32_t) + 3 * sizeof(int64_t) + sizeof(int32_t));
+    return bytes;
+}
+
+int64_t FlightTable::toEpoch(const std::tm& time) {
+    int64_t days = FastParse::daysFromCivil(time.tm_year + 1900, time.tm_mon + 1, time.tm_mday);
+    return days * 86400 + time.tm_hour * 3600 + time.tm_min * 60 + time.tm_sec;
+}
+
+std::tm FlightTable::toTm(int64_t epoch) {
+    int64_t days = epoch >= 0 ? epoch / 86400 : (epoch - 86399) / 86400;
+    int64_t seconds = epoch - days * 86400;
+    int year, month, day;
+    FastParse::civilFromDays(days, year, month, day);
+    std::tm time = {};
+    time.tm_year = year - 1900;
+    time.tm_mon = month - 1;
+    time.tm_mday = day;
+    time.tm_hour = static_cast<int>(seconds / 3600);
+    time.tm_min = static_cast<int>(seconds / 60 % 60);
+    time.tm_sec = static_cast<int>(seconds % 60);
+    time.tm_wday = static_cast<int>(((days % 7) + 11) % 7); // 1970-01-01 was a Thursday
+    time.tm_yday = static_cast<int>(days - FastParse::daysFromCivil(year, 1, 1));
+    return time;
+}
+
+int64_t FlightTable::toMinorUnits(double amount) {
+    return std::llround(amount * 100.0);
+}
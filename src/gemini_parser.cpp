@@ -0,0 +1,164 @@
+#include "gemini_parser.hpp"
+#include "json.hpp"
+#include <array>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Walks the envelope looking only for candidates[0].content.parts[0].text.
+// Containers off that path are skipped without being stored, and parsing
+// stops as soon as the text has been taken.
+class CandidateTextHandler : public nlohmann::json_sax<json> {
+public:
+    std::string text;
+    bool found = false;
+    std::string parseError;
+
+    CandidateTextHandler() { stack_.reserve(16); }
+
+    bool null() override { return scalar(); }
+    bool boolean(bool) override { return scalar(); }
+    bool number_integer(number_integer_t) override { return scalar(); }
+    bool number_unsigned(number_unsigned_t) override { return scalar(); }
+    bool number_float(number_float_t, const string_t&) override { return scalar(); }
+    bool binary(binary_t&) override { return scalar(); }
+
+    bool string(string_t& value) override {
+        if (onPath() && stack_.size() == kPath.size()) {
+            text = std::move(value);
+            found = true;
+            return false; // done - stop the parser here
+        }
+        return scalar();
+    }
+
+    bool start_object(std::size_t) override { return open(false); }
+    bool start_array(std::size_t) override { return open(true); }
+    bool end_object() override { return close(); }
+    bool end_array() override { return close(); }
+
+    bool key(string_t& name) override {
+        const Frame& frame = stack_.back();
+        size_t step = stack_.size() - 1;
+        keyOnPath_ = frame.onPath && step < kPath.size() && kPath[step] && name == kPath[step];
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        parseError = ex.what();
+        return false;
+    }
+
+private:
+    // One entry per level; nullptr means "element 0 of an array".
+    static constexpr std::array<const char*, 6> kPath = {"candidates", nullptr, "content", "parts", nullptr, "text"};
+
+    struct Frame {
+        bool isArray;
+        bool onPath;
+        size_t index;
+    };
+
+    // Whether the value about to start sits on kPath.
+    bool onPath() const {
+        if (stack_.empty()) return true;
+        const Frame& parent = stack_.back();
+        size_t step = stack_.size() - 1;
+        if (!parent.onPath || step >= kPath.size()) return false;
+        return parent.isArray ? kPath[step] == nullptr && parent.index == 0 : keyOnPath_;
+    }
+
+    bool open(bool isArray) {
+        stack_.push_back(Frame{isArray, onPath(), 0});
+        return true;
+    }
+
+    bool close() {
+        stack_.pop_back();
+        return scalar();
+    }
+
+    // A value has ended: advance the enclosing array's index.
+    bool scalar() {
+        if (!stack_.empty() && stack_.back().isArray) ++stack_.back().index;
+        return true;
+    }
+
+    std::vector<Frame> stack_;
+    bool keyOnPath_ = false;
+};
+
+std::string_view field(const json& object, const char* key) {
+    auto it = object.find(key);
+    if (it == object.end()) return {};
+    return it->get_ref<const std::string&>();
+}
+
+} // namespace
+
+namespace GeminiParser {
+
+std::string candidateText(const std::string& response) {
+    CandidateTextHandler handler;
+    json::sax_parse(response, &handler);
+    if (handler.found) return std::move(handler.text);
+    if (!handler.parseError.empty()) {
+        throw std::runtime_error("Error parsing Gemini response: " + handler.parseError);
+    }
+    throw std::runtime_error("Invalid Gemini response structure");
+}
+
+std::pmr::vector<Hotel> parseHotels(const std::string& text, std::string_view city,
+                                    std::string_view checkIn, std::string_view checkOut,
+                                    std::string_view currency, std::pmr::memory_resource* resource) {
+    json hotelJson = json::parse(text);
+    std::pmr::vector<Hotel> hotels(resource);
+    hotels.reserve(hotelJson.size());
+    for (const auto& hotel : hotelJson) {
+        hotels.emplace_back(hotel.at("hotel_name").get_ref<const std::string&>(), city,
+                            hotel.at("total_stay_cost").get<double>(), hotel.at("star_rating").get<double>(),
+                            checkIn, checkOut, hotel.at("address").get_ref<const std::string&>(), currency);
+    }
+    return hotels;
+}
+
+std::pmr::vector<ItineraryItem> parseItinerary(const std::string& text, std::string_view hotelName,
+                                               std::string_view startDate, std::string_view endDate,
+                                               std::pmr::memory_resource* resource) {
+    json itineraryJson = json::parse(text);
+    std::pmr::vector<ItineraryItem> itinerary(resource);
+    std::pmr::string activity(resource);
+
+    auto days = itineraryJson.find("itinerary");
+    bool hasDays = days != itineraryJson.end() && days->is_array();
+    itinerary.reserve(2 + (hasDays ? 3 * days->size() : 0));
+
+    activity.assign("Check-in at ").append(hotelName);
+    itinerary.emplace_back(activity, startDate, "14:00", "Accommodation");
+
+    if (hasDays) {
+        for (const auto& day : *days) {
+            std::string_view date = field(day, "date");
+            std::string_view place = field(day, "place");
+            std::string_view description = field(day, "famous_for");
+            std::string_view transport = field(day, "how_to_go");
+            if (!place.empty()) {
+                activity.assign("Visit ").append(place);
+                itinerary.emplace_back(activity, date, "10:00", "Sightseeing");
+            }
+            if (!description.empty()) itinerary.emplace_back(description, date, "10:30", "Information");
+            if (!transport.empty()) {
+                activity.assign("Transportation: ").append(transport);
+                itinerary.emplace_back(activity, date, "09:30", "Transport");
+            }
+        }
+    }
+
+    activity.assign("Check-out from ").append(hotelName);
+    itinerary.emplace_back(activity, endDate, "11:00", "Accommodation");
+    return itinerary;
+}
+
+} // namespace GeminiParser
@@ -3,10 +3,23 @@
 #include <iomanip> // for setprecision
 using namespace std;
 
-Hotel::Hotel(string n, string loc, double price, double rat,
-             string checkIn, string checkOut, string addr, string currency)
-    : name(n), location(loc), pricePerNight(price), rating(rat),
-      checkInDate(checkIn), checkOutDate(checkOut), address(addr), currency(currency) {}
+Hotel::Hotel(string_view n, string_view loc, double price, double rat,
+             string_view checkIn, string_view checkOut, string_view addr, string_view currency,
+             allocator_type alloc)
+    : name(n, alloc), location(loc, alloc), pricePerNight(price), rating(rat),
+      checkInDate(checkIn, alloc), checkOutDate(checkOut, alloc), address(addr, alloc),
+      currency(currency, alloc) {}
+
+Hotel::Hotel(const Hotel& other, allocator_type alloc)
+    : name(other.name, alloc), location(other.location, alloc), pricePerNight(other.pricePerNight),
+      rating(other.rating), checkInDate(other.checkInDate, alloc), checkOutDate(other.checkOutDate, alloc),
+      address(other.address, alloc), currency(other.currency, alloc) {}
+
+Hotel::Hotel(Hotel&& other, allocator_type alloc)
+    : name(std::move(other.name), alloc), location(std::move(other.location), alloc),
+      pricePerNight(other.pricePerNight), rating(other.rating),
+      checkInDate(std::move(other.checkInDate), alloc), checkOutDate(std::move(other.checkOutDate), alloc),
+      address(std::move(other.address), alloc), currency(std::move(other.currency), alloc) {}
 
 void Hotel::displayInfo() const {
     cout << "Hotel: " << name << endl;
@@ -16,10 +29,10 @@ void Hotel::displayInfo() const {
 }
 
 // Getters implementation
-string Hotel::getName() const { return name; }
-string Hotel::getLocation() const { return location; }
+string_view Hotel::getName() const { return name; }
+string_view Hotel::getLocation() const { return location; }
 double Hotel::getPricePerNight() const { return pricePerNight; }
 double Hotel::getRating() const { return rating; }
-string Hotel::getCheckInDate() const { return checkInDate; }
-string Hotel::getCheckOutDate() const { return checkOutDate; }
-string Hotel::getAddress() const { return address; }
\ No newline at end of file
+string_view Hotel::getCheckInDate() const { return checkInDate; }
+string_view Hotel::getCheckOutDate() const { return checkOutDate; }
+string_view Hotel::getAddress() const { return address; }
@@ -0,0 +1,265 @@
+#include "http_engine.hpp"
+#include "logger.hpp"
+#include "upstream_error.hpp"
+#include <algorithm>
+#include <stdexcept>
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+using PollFd = WSAPOLLFD;
+int pollSockets(PollFd* fds, size_t count, int timeoutMs) {
+    return WSAPoll(fds, static_cast<ULONG>(count), timeoutMs);
+}
+// No self-pipe for WSAPoll; bound the wait so new submissions are picked
+// up promptly instead.
+constexpr int maxPollWaitMs = 10;
+#else
+using PollFd = pollfd;
+int pollSockets(PollFd* fds, size_t count, int timeoutMs) {
+    return poll(fds, static_cast<nfds_t>(count), timeoutMs);
+}
+constexpr int maxPollWaitMs = 1000;
+#endif
+
+} // namespace
+
+HttpEngine& HttpEngine::instance() {
+    static HttpEngine engine;
+    return engine;
+}
+
+HttpEngine::HttpEngine() {
+    // Make sure the pool (and with it curl_global_init) outlives us.
+    CurlHandlePool::instance();
+
+    multi_ = curl_multi_init();
+    if (!multi_) {
+        throw std::runtime_error("Failed to initialize CURL multi handle");
+    }
+    curl_multi_setopt(multi_, CURLMOPT_SOCKETFUNCTION, &HttpEngine::onSocket);
+    curl_multi_setopt(multi_, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(multi_, CURLMOPT_TIMERFUNCTION, &HttpEngine::onTimer);
+    curl_multi_setopt(multi_, CURLMOPT_TIMERDATA, this);
+
+#ifndef _WIN32
+    if (pipe(wakePipe_) != 0) {
+        curl_multi_cleanup(multi_);
+        throw std::runtime_error("Failed to create HTTP engine wake pipe");
+    }
+    for (int fd : wakePipe_) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#endif
+
+    loop_ = std::thread([this] { run(); });
+}
+
+HttpEngine::~HttpEngine() {
+    stopping_.store(true);
+    wake();
+    if (loop_.joinable()) loop_.join();
+    curl_multi_cleanup(multi_);
+#ifndef _WIN32
+    close(wakePipe_[0]);
+    close(wakePipe_[1]);
+#endif
+}
+
+void HttpEngine::requestAsync(HttpRequest request, Callback done) {
+    if (stopping_.load()) {
+        done(std::make_exception_ptr(std::runtime_error("HTTP engine shutting down")), {});
+        return;
+    }
+
+    auto pending = std::make_unique<Pending>();
+    pending->done = std::move(done);
+    try {
+        pending->transfer = std::make_unique<HttpTransfer>(std::move(request));
+    } catch (...) {
+        pending->done(std::current_exception(), {});
+        return;
+    }
+
+    inFlight_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        queued_.push_back(std::move(pending));
+    }
+    wake();
+}
+
+std::future<std::string> HttpEngine::requestAsync(HttpRequest request) {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> result = promise->get_future();
+    requestAsync(std::move(request), [promise](std::exception_ptr error, std::string body) {
+        if (error) promise->set_exception(error);
+        else promise->set_value(std::move(body));
+    });
+    return result;
+}
+
+void HttpEngine::wake() {
+#ifndef _WIN32
+    char byte = 1;
+    // A full pipe already guarantees a wake-up, so a failed write is fine.
+    (void)!write(wakePipe_[1], &byte, 1);
+#endif
+}
+
+int HttpEngine::onSocket(CURL*, curl_socket_t socket, int what, void* userp, void*) {
+    auto* engine = static_cast<HttpEngine*>(userp);
+    if (what == CURL_POLL_REMOVE) {
+        engine->sockets_.erase(socket);
+    } else {
+        engine->sockets_[socket] = what;
+    }
+    return 0;
+}
+
+int HttpEngine::onTimer(CURLM*, long timeoutMs, void* userp) {
+    auto* engine = static_cast<HttpEngine*>(userp);
+    if (timeoutMs < 0) {
+        engine->timerArmed_ = false;
+    } else {
+        engine->timerArmed_ = true;
+        engine->timerDeadline_ = std::chrono::steady_clock::now() +
+                                 std::chrono::milliseconds(timeoutMs);
+    }
+    return 0;
+}
+
+void HttpEngine::fail(Pending& pending, std::exception_ptr error) {
+    inFlight_.fetch_sub(1, std::memory_order_relaxed);
+    try {
+        pending.done(error, {});
+    } catch (const std::exception& e) {
+        LOG_ERROR("HTTP engine callback threw: ", e.what());
+    }
+}
+
+// Hands newly submitted transfers to the multi handle. Ownership moves to
+// the easy handle's CURLOPT_PRIVATE until the transfer completes.
+void HttpEngine::startQueued() {
+    std::vector<std::unique_ptr<Pending>> batch;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        batch.swap(queued_);
+    }
+    for (auto& pending : batch) {
+        CURL* easy = pending->transfer->handle();
+        curl_easy_setopt(easy, CURLOPT_PRIVATE, pending.get());
+        CURLMcode rc = curl_multi_add_handle(multi_, easy);
+        if (rc != CURLM_OK) {
+            fail(*pending, std::make_exception_ptr(
+                TransportError(TransportError::Kind::Other, curl_multi_strerror(rc))));
+            continue;
+        }
+        active_.insert(pending.release());
+    }
+}
+
+void HttpEngine::completeFinished() {
+    int queuedMessages = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi_, &queuedMessages)) {
+        if (message->msg != CURLMSG_DONE) continue;
+
+        CURL* easy = message->easy_handle;
+        CURLcode result = message->data.result;
+        Pending* raw = nullptr;
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, &raw);
+        curl_multi_remove_handle(multi_, easy);
+        active_.erase(raw);
+        std::unique_ptr<Pending> pending(raw);
+
+        std::string body;
+        std::exception_ptr error;
+        try {
+            body = pending->transfer->finish(result);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        // Return the handle to the pool before running user code.
+        pending->transfer.reset();
+
+        inFlight_.fetch_sub(1, std::memory_order_relaxed);
+        try {
+            pending->done(error, std::move(body));
+        } catch (const std::exception& e) {
+            LOG_ERROR("HTTP engine callback threw: ", e.what());
+        }
+    }
+}
+
+void HttpEngine::run() {
+    std::vector<PollFd> fds;
+    int running = 0;
+
+    while (!stopping_.load()) {
+        startQueued();
+
+        fds.clear();
+#ifndef _WIN32
+        fds.push_back({wakePipe_[0], POLLIN, 0});
+#endif
+        for (const auto& entry : sockets_) {
+            PollFd fd{};
+            fd.fd = entry.first;
+            if (entry.second & CURL_POLL_IN) fd.events |= POLLIN;
+            if (entry.second & CURL_POLL_OUT) fd.events |= POLLOUT;
+            fds.push_back(fd);
+        }
+
+        int waitMs = maxPollWaitMs;
+        if (timerArmed_) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                timerDeadline_ - std::chrono::steady_clock::now()).count();
+            waitMs = static_cast<int>(std::max<long long>(0, std::min<long long>(remaining, waitMs)));
+        }
+
+        int ready = fds.empty() ? 0 : pollSockets(fds.data(), fds.size(), waitMs);
+        if (fds.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+
+        if (ready > 0) {
+            for (const PollFd& fd : fds) {
+                if (!fd.revents) continue;
+#ifndef _WIN32
+                if (fd.fd == wakePipe_[0]) {
+                    char drain[64];
+                    while (read(wakePipe_[0], drain, sizeof(drain)) > 0) {}
+                    continue;
+                }
+#endif
+                int flags = 0;
+                if (fd.revents & POLLIN) flags |= CURL_CSELECT_IN;
+                if (fd.revents & POLLOUT) flags |= CURL_CSELECT_OUT;
+                if (fd.revents & (POLLERR | POLLHUP)) flags |= CURL_CSELECT_ERR;
+                curl_multi_socket_action(multi_, fd.fd, flags, &running);
+            }
+        }
+
+        if (timerArmed_ && std::chrono::steady_clock::now() >= timerDeadline_) {
+            timerArmed_ = false;
+            curl_multi_socket_action(multi_, CURL_SOCKET_TIMEOUT, 0, &running);
+        }
+
+        completeFinished();
+    }
+
+    // Shutting down: nothing will drive the remaining transfers, so fail
+    // them rather than leave callers waiting forever.
+    startQueued();
+    auto shutdownError = std::make_exception_ptr(std::runtime_error("HTTP engine shutting down"));
+    for (Pending* raw : active_) {
+        std::unique_ptr<Pending> pending(raw);
+        curl_multi_remove_handle(multi_, pending->transfer->handle());
+        pending->transfer.reset();
+        fail(*pending, shutdownError);
+    }
+    active_.clear();
+}
@@ -0,0 +1,265 @@
+#include "http_transfer.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "upstream_error.hpp"
+#include "url_redaction.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <stdexcept>
+
+namespace {
+
+std::atomic<long long> slowCallThresholdMicros{2000 * 1000};
+
+// Where one transfer spent its time. libcurl reports cumulative offsets
+// from the start of the transfer; these are the per-phase differences.
+// DNS, connect and TLS are zero on a reused connection.
+struct Timings {
+    curl_off_t dns = 0;
+    curl_off_t connect = 0;
+    curl_off_t tls = 0;
+    curl_off_t firstByte = 0; // request sent -> first response byte (server think time)
+    curl_off_t transfer = 0;  // first byte -> done
+    curl_off_t total = 0;
+};
+
+Timings readTimings(CURL* curl) {
+    curl_off_t nameLookup = 0, connect = 0, appConnect = 0, startTransfer = 0, total = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &nameLookup);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &startTransfer);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+
+    // Offsets are 0 for phases that never happened (no TLS, failed connect).
+    auto since = [](curl_off_t at, curl_off_t from) { return at > from ? at - from : curl_off_t(0); };
+    curl_off_t handshakeDone = std::max({nameLookup, connect, appConnect});
+    Timings t;
+    t.dns = nameLookup;
+    t.connect = since(connect, nameLookup);
+    t.tls = since(appConnect, connect);
+    t.firstByte = since(startTransfer, handshakeDone);
+    t.transfer = since(total, std::max(startTransfer, handshakeDone));
+    t.total = total;
+    return t;
+}
+
+struct UpstreamMetrics {
+    const char* name;
+    Histogram& latency;
+    Histogram& dns;
+    Histogram& connect;
+    Histogram& tls;
+    Histogram& firstByte;
+    Histogram& transfer;
+    Counter& ok;
+    Counter& httpErrors;
+    Counter& transportErrors;
+    Counter& slowCalls;
+
+    void record(const Timings& t) const {
+        latency.observe(t.total / 1e6);
+        dns.observe(t.dns / 1e6);
+        connect.observe(t.connect / 1e6);
+        tls.observe(t.tls / 1e6);
+        firstByte.observe(t.firstByte / 1e6);
+        transfer.observe(t.transfer / 1e6);
+    }
+};
+
+UpstreamMetrics makeUpstreamMetrics(const char* upstream) {
+    auto& registry = MetricsRegistry::instance();
+    const char* requests = "travelplanner_upstream_requests_total";
+    const char* help = "Upstream HTTP calls by outcome";
+    const char* phases = "travelplanner_upstream_phase_seconds";
+    const char* phaseHelp = "Upstream HTTP call time by phase: dns, connect, tls, first_byte, transfer";
+    auto phase = [&](const char* name) -> Histogram& {
+        return registry.histogram(phases, phaseHelp, {{"upstream", upstream}, {"phase", name}});
+    };
+    return UpstreamMetrics{
+        upstream,
+        registry.histogram("travelplanner_upstream_request_duration_seconds",
+                           "Upstream HTTP call latency as measured by libcurl", {{"upstream", upstream}}),
+        phase("dns"),
+        phase("connect"),
+        phase("tls"),
+        phase("first_byte"),
+        phase("transfer"),
+        registry.counter(requests, help, {{"upstream", upstream}, {"result", "ok"}}),
+        registry.counter(requests, help, {{"upstream", upstream}, {"result", "http_error"}}),
+        registry.counter(requests, help, {{"upstream", upstream}, {"result", "transport_error"}}),
+        registry.counter("travelplanner_upstream_slow_calls_total",
+                         "Upstream HTTP calls over the slow-call threshold", {{"upstream", upstream}}),
+    };
+}
+
+// The call's span is reconstructed from libcurl's own timings, so it costs
+// nothing while the transfer runs and covers engine-driven calls too.
+void recordSpan(const UpstreamMetrics& metrics, const HttpRequest& request, const Timings& t,
+                CURLcode result, long httpCode) {
+    Tracer& tracer = Tracer::instance();
+    if (!tracer.enabled()) return;
+    SpanRecord span;
+    span.name = std::string("http ") + metrics.name;
+    span.parentId = request.trace.spanId;
+    span.context.traceId = request.trace ? request.trace.traceId : Tracer::newId();
+    span.context.spanId = Tracer::newId();
+    span.duration = std::chrono::microseconds(t.total);
+    span.start = std::chrono::system_clock::now() - span.duration;
+    span.error = result != CURLE_OK || httpCode >= 400;
+    span.attributes = {
+        {"method", request.method},
+        {"path", redactUrlForLog(request.url)},
+        {"status", result == CURLE_OK ? std::to_string(httpCode) : curl_easy_strerror(result)},
+        {"dns_us", std::to_string(t.dns)},
+        {"connect_us", std::to_string(t.connect)},
+        {"tls_us", std::to_string(t.tls)},
+        {"first_byte_us", std::to_string(t.firstByte)},
+        {"transfer_us", std::to_string(t.transfer)},
+    };
+    tracer.record(span);
+}
+
+// One structured line per slow call. Only host and path are logged: the
+// query string carries the Gemini and WeatherAPI keys.
+void logSlowCall(const UpstreamMetrics& metrics, const std::string& url, const Timings& t,
+                 CURLcode result, long httpCode) {
+    auto ms = [](curl_off_t micros) { return micros / 1000; };
+    LOG_WARN("slow upstream call service=", metrics.name, " path=", redactUrlForLog(url),
+             " status=", result == CURLE_OK ? std::to_string(httpCode) : std::string(curl_easy_strerror(result)),
+             " total_ms=", ms(t.total), " dns_ms=", ms(t.dns), " connect_ms=", ms(t.connect),
+             " tls_ms=", ms(t.tls), " first_byte_ms=", ms(t.firstByte), " transfer_ms=", ms(t.transfer));
+}
+
+TransportError::Kind transportErrorKind(CURLcode result) {
+    switch (result) {
+    case CURLE_OPERATION_TIMEDOUT:
+        return TransportError::Kind::Timeout;
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+        return TransportError::Kind::Connection;
+    default:
+        return TransportError::Kind::Other;
+    }
+}
+
+void exportPoolMetrics() {
+    auto& registry = MetricsRegistry::instance();
+    const char* connections = "travelplanner_upstream_connections_total";
+    const char* help = "Transfers by whether they opened a connection or reused a warm one";
+    registry.counterFn(connections, help, {{"connection", "fresh"}},
+                       [] { return static_cast<double>(CurlHandlePool::instance().stats().freshConnects); });
+    registry.counterFn(connections, help, {{"connection", "reused"}},
+                       [] { return static_cast<double>(CurlHandlePool::instance().stats().reusedConnects); });
+}
+
+// Series are looked up once; the per-call cost is a few relaxed atomics.
+const UpstreamMetrics& upstreamMetrics(const std::string& url) {
+    static const UpstreamMetrics gemini = makeUpstreamMetrics("gemini");
+    static const UpstreamMetrics amadeus = makeUpstreamMetrics("amadeus");
+    static const UpstreamMetrics weather = makeUpstreamMetrics("weather");
+    static const UpstreamMetrics other = makeUpstreamMetrics("other");
+    [[maybe_unused]] static const bool pool = (exportPoolMetrics(), true);
+
+    if (url.find("generativelanguage") != std::string::npos) return gemini;
+    if (url.find("amadeus") != std::string::npos) return amadeus;
+    if (url.find("weatherapi") != std::string::npos) return weather;
+    return other;
+}
+
+} // namespace
+
+HttpTransfer::HttpTransfer(HttpRequest request)
+    : request_(std::move(request)),
+      lease_(CurlHandlePool::instance().acquire()),
+      headers_(nullptr, &curl_slist_free_all) {
+    CURL* curl = lease_.get();
+
+    struct curl_slist* headers = nullptr;
+    if (request_.url.find("amadeus") != std::string::npos &&
+        request_.url.find("oauth2/token") != std::string::npos) {
+        headers = curl_slist_append(headers, "Content-Type: application/x-www-form-urlencoded");
+    } else {
+        headers = curl_slist_append(headers, "Content-Type: application/json");
+    }
+    if (!request_.token.empty()) {
+        headers = curl_slist_append(headers, ("Authorization: Bearer " + request_.token).c_str());
+    }
+    headers_.reset(headers);
+
+    curl_easy_setopt(curl, CURLOPT_URL, request_.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &HttpTransfer::writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &HttpTransfer::headerCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &retryAfter_);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_.get());
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+
+    if (request_.method == "POST") {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        if (!request_.data.empty()) {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request_.data.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(request_.data.length()));
+        }
+    }
+}
+
+size_t HttpTransfer::writeCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(static_cast<char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+// Keeps only the Retry-After value; libcurl hands over one header line
+// (with its CRLF) per call.
+size_t HttpTransfer::headerCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+    size_t length = size * nitems;
+    static constexpr char name[] = "retry-after:";
+    constexpr size_t nameLength = sizeof(name) - 1;
+    if (length > nameLength) {
+        bool match = true;
+        for (size_t i = 0; i < nameLength && match; ++i) {
+            match = std::tolower(static_cast<unsigned char>(buffer[i])) == name[i];
+        }
+        if (match) static_cast<std::string*>(userdata)->assign(buffer + nameLength, length - nameLength);
+    }
+    return length;
+}
+
+void HttpTransfer::setSlowCallThreshold(std::chrono::milliseconds threshold) {
+    slowCallThresholdMicros.store(threshold.count() * 1000, std::memory_order_relaxed);
+}
+
+std::string HttpTransfer::finish(CURLcode result) {
+    const UpstreamMetrics& metrics = upstreamMetrics(request_.url);
+    Timings timings = readTimings(handle());
+    metrics.record(timings);
+
+    long httpCode = 0;
+    curl_easy_getinfo(handle(), CURLINFO_RESPONSE_CODE, &httpCode);
+    recordSpan(metrics, request_, timings, result, httpCode);
+    if (request_.cost) request_.cost->addUpstreamCall(response_.size(), std::chrono::microseconds(timings.total));
+    if (timings.total >= slowCallThresholdMicros.load(std::memory_order_relaxed)) {
+        metrics.slowCalls.inc();
+        logSlowCall(metrics, request_.url, timings, result, httpCode);
+    }
+
+    if (result != CURLE_OK) {
+        metrics.transportErrors.inc();
+        throw TransportError(transportErrorKind(result), curl_easy_strerror(result));
+    }
+    CurlHandlePool::instance().recordTransfer(handle());
+
+    if (httpCode >= 400) {
+        metrics.httpErrors.inc();
+        throw HttpError(static_cast<int>(httpCode), std::move(response_),
+                        retryAfter_.empty() ? std::nullopt : parseRetryAfter(retryAfter_));
+    }
+    metrics.ok.inc();
+    return std::move(response_);
+}
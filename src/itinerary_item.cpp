@@ -2,9 +2,21 @@
 #include <iostream>
 using namespace std;
 
+ItineraryItem::ItineraryItem(allocator_type alloc)
+    : activity(alloc), date(alloc), time(alloc), category(alloc) {}
+
 //This function constructs a new ItineraryItem object with the given activity, date, time, and category
-ItineraryItem::ItineraryItem(string act, string d, string t, string cat)
-    : activity(act), date(d), time(t), category(cat) {}
+ItineraryItem::ItineraryItem(string_view act, string_view d, string_view t, string_view cat,
+                             allocator_type alloc)
+    : activity(act, alloc), date(d, alloc), time(t, alloc), category(cat, alloc) {}
+
+ItineraryItem::ItineraryItem(const ItineraryItem& other, allocator_type alloc)
+    : activity(other.activity, alloc), date(other.date, alloc), time(other.time, alloc),
+      category(other.category, alloc) {}
+
+ItineraryItem::ItineraryItem(ItineraryItem&& other, allocator_type alloc)
+    : activity(std::move(other.activity), alloc), date(std::move(other.date), alloc),
+      time(std::move(other.time), alloc), category(std::move(other.category), alloc) {}
 
 //This function displays the itinerary item details
 void ItineraryItem::displayDetails() const {
@@ -16,7 +28,7 @@ void ItineraryItem::displayDetails() const {
 }
 
 //These functions return the activity, date, time, and category
-string ItineraryItem::getActivity() const { return activity; }
-string ItineraryItem::getDate() const { return date; }
-string ItineraryItem::getTime() const { return time; }
-string ItineraryItem::getCategory() const { return category; }
\ No newline at end of file
+string_view ItineraryItem::getActivity() const { return activity; }
+string_view ItineraryItem::getDate() const { return date; }
+string_view ItineraryItem::getTime() const { return time; }
+string_view ItineraryItem::getCategory() const { return category; }
@@ -1,29 +1,365 @@
 #include "logger.hpp"
-#include <iostream>
+#include "mpsc_ring.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
 #include <ctime>
-#include <iomanip>
-#include <sstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 namespace {
-std::string timestamp() {
-    time_t now = time(nullptr);
+
+struct Record {
+    time_t time = 0;
+    const char* level = "";
+    bool toStderr = false;
+    std::string message;
+};
+
+constexpr size_t kRingCapacity = 8192;
+constexpr size_t kMaxBatch = 256;
+constexpr auto kIdleWait = std::chrono::milliseconds(10);
+
+// "YYYY-MM-DDTHH:MM:SS" into `out` (at least 20 bytes).
+void formatTimestamp(time_t when, char* out, size_t size) {
     tm local{};
 #ifdef _WIN32
-    localtime_s(&local, &now);
+    localtime_s(&local, &when);
 #else
-    localtime_r(&now, &local);
+    localtime_r(&when, &local);
 #endif
-    std::ostringstream oss;
-    oss << std::put_time(&local, "%Y-%m-%dT%H:%M:%S");
-    return oss.str();
+    strftime(out, size, "%Y-%m-%dT%H:%M:%S", &local);
 }
+
+struct Piece {
+    const char* data;
+    size_t size;
+};
+
+// Write every piece to stdout/stderr, riding out partial writes and EINTR.
+void writePieces(bool toStderr, std::vector<Piece>& pieces) {
+    if (pieces.empty()) return;
+#ifdef _WIN32
+    FILE* out = toStderr ? stderr : stdout;
+    for (const Piece& p : pieces) fwrite(p.data, 1, p.size, out);
+    fflush(out);
+#else
+    std::vector<iovec> iov;
+    iov.reserve(pieces.size());
+    for (const Piece& p : pieces) iov.push_back({const_cast<char*>(p.data), p.size});
+
+    int fd = toStderr ? STDERR_FILENO : STDOUT_FILENO;
+    size_t i = 0;
+    while (i < iov.size()) {
+        if (iov[i].iov_len == 0) {
+            ++i;
+            continue;
+        }
+        int count = static_cast<int>(std::min<size_t>(iov.size() - i, IOV_MAX));
+        ssize_t written = ::writev(fd, &iov[i], count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return; // closed or non-blocking pipe is full; nothing sensible to do
+        }
+        size_t n = static_cast<size_t>(written);
+        while (n > 0) {
+            if (n >= iov[i].iov_len) {
+                n -= iov[i].iov_len;
+                ++i;
+            } else {
+                iov[i].iov_base = static_cast<char*>(iov[i].iov_base) + n;
+                iov[i].iov_len -= n;
+                n = 0;
+            }
+        }
+    }
+#endif
+}
+
+// Formats records and writes them out on the calling thread. Keeps a
+// per-second timestamp cache and prefix scratch, so one instance must not
+// be shared between threads without a lock.
+class BatchWriter {
+public:
+    void write(std::vector<Record>& batch) {
+        prefixes_.clear();
+        std::vector<std::pair<size_t, size_t>> spans;
+        spans.reserve(batch.size());
+        for (const Record& r : batch) {
+            if (r.time != stampedTime_) {
+                formatTimestamp(r.time, stamp_, sizeof(stamp_));
+                stampedTime_ = r.time;
+            }
+            size_t start = prefixes_.size();
+            prefixes_ += '[';
+            prefixes_ += stamp_;
+            prefixes_ += "] [";
+            prefixes_ += r.level;
+            prefixes_ += "] ";
+            spans.emplace_back(start, prefixes_.size() - start);
+        }
+
+        std::vector<Piece> out, err;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            std::vector<Piece>& pieces = batch[i].toStderr ? err : out;
+            pieces.push_back({prefixes_.data() + spans[i].first, spans[i].second});
+            pieces.push_back({batch[i].message.data(), batch[i].message.size()});
+            pieces.push_back({"\n", 1});
+        }
+        writePieces(false, out);
+        writePieces(true, err);
+    }
+
+private:
+    time_t stampedTime_ = -1;
+    char stamp_[32] = {};
+    std::string prefixes_;
+};
+
+class AsyncSink {
+public:
+    AsyncSink() : ring_(kRingCapacity) {
+        if (const char* env = std::getenv("LOG_OVERFLOW")) {
+            std::string value = env;
+            if (value == "block") policy_ = static_cast<int>(Logger::OverflowPolicy::Block);
+            else if (value == "sample") policy_ = static_cast<int>(Logger::OverflowPolicy::Sample);
+        }
+        writer_ = std::thread([this] { run(); });
+    }
+
+    void setPolicy(Logger::OverflowPolicy policy, unsigned sampleEvery) {
+        policy_ = static_cast<int>(policy);
+        sampleEvery_ = std::max(1u, sampleEvery);
+    }
+
+    void enqueue(Record& record, bool mustKeep) {
+        if (!ring_.tryPush(record)) {
+            auto policy = static_cast<Logger::OverflowPolicy>(policy_.load(std::memory_order_relaxed));
+            bool keep = mustKeep || policy == Logger::OverflowPolicy::Block ||
+                        (policy == Logger::OverflowPolicy::Sample &&
+                         overflowed_.fetch_add(1, std::memory_order_relaxed) % sampleEvery_ == 0);
+            if (!keep) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            while (!ring_.tryPush(record)) {
+                wakeWriter();
+                std::this_thread::yield();
+            }
+        }
+        enqueued_.fetch_add(1, std::memory_order_release);
+        if (sleeping_.load(std::memory_order_acquire)) wakeWriter();
+    }
+
+    void flush() {
+        uint64_t target = enqueued_.load(std::memory_order_acquire);
+        wakeWriter();
+        std::unique_lock<std::mutex> lock(flushMutex_);
+        flushed_.wait(lock, [&] { return written_ >= target || stopped_; });
+    }
+
+    // Drain everything and stop the writer; called once at exit.
+    void shutdown() {
+        stop_.store(true, std::memory_order_release);
+        wakeWriter();
+        if (writer_.joinable()) writer_.join();
+    }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Runs on the writer thread, and on Logger's thread once the writer is gone.
+    void write(std::vector<Record>& batch) { out_.write(batch); }
+
+private:
+    void wakeWriter() {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wake_.notify_one();
+    }
+
+    void run() {
+        std::vector<Record> batch;
+        batch.reserve(kMaxBatch);
+        for (;;) {
+            Record record;
+            while (batch.size() < kMaxBatch && ring_.tryPop(record)) batch.push_back(std::move(record));
+
+            if (!batch.empty()) {
+                write(batch);
+                markWritten(batch.size());
+                batch.clear();
+                continue;
+            }
+
+            reportDrops();
+            if (stop_.load(std::memory_order_acquire)) break;
+
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            sleeping_.store(true, std::memory_order_release);
+            // Bounded wait: a producer that misses the sleeping flag costs at
+            // most one idle interval of latency, never a lost line.
+            wake_.wait_for(lock, kIdleWait);
+            sleeping_.store(false, std::memory_order_release);
+        }
+
+        std::lock_guard<std::mutex> lock(flushMutex_);
+        stopped_ = true;
+        flushed_.notify_all();
+    }
+
+    void markWritten(size_t count) {
+        {
+            std::lock_guard<std::mutex> lock(flushMutex_);
+            written_ += count;
+        }
+        flushed_.notify_all();
+    }
+
+    void reportDrops() {
+        uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped == reportedDrops_) return;
+        std::vector<Record> note(1);
+        note[0].time = time(nullptr);
+        note[0].level = "WARN";
+        note[0].toStderr = true;
+        note[0].message = "Logger dropped " + std::to_string(dropped - reportedDrops_) + " line(s): ring full";
+        reportedDrops_ = dropped;
+        write(note);
+    }
+
+    MpscRing<Record> ring_;
+    std::atomic<int> policy_{static_cast<int>(Logger::OverflowPolicy::Drop)};
+    std::atomic<unsigned> sampleEvery_{16};
+    std::atomic<uint64_t> overflowed_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> stop_{false};
+
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+
+    std::mutex flushMutex_;
+    std::condition_variable flushed_;
+    uint64_t written_ = 0;
+    bool stopped_ = false;
+
+    BatchWriter out_;
+    uint64_t reportedDrops_ = 0;
+
+    std::thread writer_;
+};
+
+std::atomic<bool> sinkClosed{false};
+std::atomic<bool> synchronous{false};
+std::mutex directMutex;
+
+// Bypasses the ring: after the exit flush, and in synchronous mode.
+void writeDirect(Record& record) {
+    static BatchWriter& direct = *new BatchWriter(); // leaked, like the sink
+    std::vector<Record> single(1);
+    single[0] = std::move(record);
+    std::lock_guard<std::mutex> lock(directMutex);
+    // Anything the caller printed with std::cout must reach the terminal
+    // before this line does.
+    std::cout.flush();
+    direct.write(single);
+}
+
+// Deliberately leaked so that static destructors running after the exit
+// flush can still log (synchronously) without touching a destroyed object.
+AsyncSink& sink() {
+    static AsyncSink* instance = [] {
+        auto* created = new AsyncSink();
+        std::atexit([] {
+            sink().shutdown();
+            sinkClosed.store(true, std::memory_order_release);
+        });
+        return created;
+    }();
+    return *instance;
+}
+
+const char* levelName(Logger::Level level) {
+    switch (level) {
+        case Logger::Level::Debug: return "DEBUG";
+        case Logger::Level::Info: return "INFO";
+        case Logger::Level::Warn: return "WARN";
+        default: return "ERROR";
+    }
+}
+
+bool parseLevel(const std::string& name, Logger::Level& out) {
+    if (name == "debug") out = Logger::Level::Debug;
+    else if (name == "info") out = Logger::Level::Info;
+    else if (name == "warn") out = Logger::Level::Warn;
+    else if (name == "error") out = Logger::Level::Error;
+    else if (name == "off") out = Logger::Level::Off;
+    else return false;
+    return true;
+}
+
+// Apply LOG_LEVEL once at startup.
+[[maybe_unused]] const bool levelFromEnv = [] {
+    Logger::Level level;
+    const char* env = std::getenv("LOG_LEVEL");
+    if (env && parseLevel(env, level)) Logger::setLevel(level);
+    return true;
+}();
+
+} // namespace
+
+void Logger::write(Level level, std::string message) {
+    Record record;
+    record.time = time(nullptr);
+    record.level = levelName(level);
+    record.toStderr = level >= Level::Warn;
+    record.message = std::move(message);
+
+    if (synchronous.load(std::memory_order_acquire) || sinkClosed.load(std::memory_order_acquire)) {
+        writeDirect(record);
+        return;
+    }
+    sink().enqueue(record, level == Level::Error);
+}
+
+void Logger::debug(const std::string& message) {
+    if (enabled(Level::Debug)) write(Level::Debug, message);
+}
+void Logger::info(const std::string& message) {
+    if (enabled(Level::Info)) write(Level::Info, message);
+}
+void Logger::warn(const std::string& message) {
+    if (enabled(Level::Warn)) write(Level::Warn, message);
+}
+void Logger::error(const std::string& message) {
+    if (enabled(Level::Error)) write(Level::Error, message);
+}
+
+void Logger::setOverflowPolicy(OverflowPolicy policy, unsigned sampleEvery) {
+    sink().setPolicy(policy, sampleEvery);
+}
+
+void Logger::setSynchronous(bool on) {
+    synchronous.store(on, std::memory_order_release);
+    // Lines already queued must not land after the direct ones.
+    if (on) flush();
 }
 
-void Logger::log(const std::string& level, const std::string& message, bool toStderr) {
-    std::ostream& out = toStderr ? std::cerr : std::cout;
-    out << "[" << timestamp() << "] [" << level << "] " << message << "\n";
+void Logger::flush() {
+    if (sinkClosed.load(std::memory_order_acquire)) return;
+    sink().flush();
 }
 
-void Logger::info(const std::string& message) { log("INFO", message, false); }
-void Logger::warn(const std::string& message) { log("WARN", message, true); }
-void Logger::error(const std::string& message) { log("ERROR", message, true); }
+uint64_t Logger::dropped() { return sink().dropped(); }
@@ -97,6 +97,9 @@ vector<FlightJourney> groupIntoJourneys(const vector<Flight>& flights) {
 }
 
 int main() {
+    // Log lines and prompts share the terminal; keep them in program order.
+    Logger::setSynchronous(true);
+
     try {
         if (curl_global_init(CURL_GLOBAL_ALL) != CURLE_OK) {
             throw runtime_error("Failed to initialize curl");
@@ -173,7 +176,7 @@ int main() {
 
         vector<Flight> outboundFlights;
         try {
-            outboundFlights = outboundFuture.get();
+            outboundFlights = outboundFuture.get().toFlights();
         } catch (const std::exception& e) {
             cout << "\n[Warning] Outbound flight search failed: " << e.what() << endl;
         }
@@ -214,7 +217,7 @@ int main() {
 
         vector<Flight> returnFlights;
         try {
-            returnFlights = returnFuture.get();
+            returnFlights = returnFuture.get().toFlights();
         } catch (const std::exception& e) {
             cout << "\n[Warning] Return flight search failed: " << e.what() << endl;
         }
@@ -253,7 +256,7 @@ int main() {
             cout << "\nNo return flights found or failed to fetch. Continuing to next step..." << endl;
         }
 
-        vector<Hotel> hotels;
+        std::pmr::vector<Hotel> hotels;
         try {
             hotels = hotelsFuture.get();
         } catch (const std::exception& e) {
@@ -282,7 +285,7 @@ int main() {
         }
 
         // Itinerary
-        vector<ItineraryItem> generatedItinerary;
+        std::pmr::vector<ItineraryItem> generatedItinerary;
         try {
             cout << "\nGenerating personalized itinerary..." << endl;
             if (selectedHotel) {
@@ -0,0 +1,178 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+void appendNumber(std::string& out, double value) {
+    if (std::isinf(value)) {
+        out += value > 0 ? "+Inf" : "-Inf";
+        return;
+    }
+    char buf[32];
+    if (value == std::floor(value) && std::fabs(value) < 1e15) {
+        std::snprintf(buf, sizeof(buf), "%.0f", value);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%.9g", value);
+    }
+    out += buf;
+}
+
+void appendEscaped(std::string& out, const std::string& value) {
+    for (char c : value) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '"') out += "\\\"";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+}
+
+// `{a="1",b="2"}`, with an optional extra label (histogram `le`).
+void appendLabels(std::string& out, const MetricLabels& labels, const char* extraName = nullptr,
+                  const std::string& extraValue = {}) {
+    if (labels.empty() && !extraName) return;
+    out += '{';
+    bool first = true;
+    for (const auto& [name, value] : labels) {
+        if (!first) out += ',';
+        first = false;
+        out += name;
+        out += "=\"";
+        appendEscaped(out, value);
+        out += '"';
+    }
+    if (extraName) {
+        if (!first) out += ',';
+        out += extraName;
+        out += "=\"";
+        out += extraValue;
+        out += '"';
+    }
+    out += '}';
+}
+
+void appendSample(std::string& out, const std::string& name, const MetricLabels& labels, double value) {
+    out += name;
+    appendLabels(out, labels);
+    out += ' ';
+    appendNumber(out, value);
+    out += '\n';
+}
+
+} // namespace
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)), buckets_(new std::atomic<uint64_t>[bounds_.size() + 1]) {
+    std::sort(bounds_.begin(), bounds_.end());
+    for (size_t i = 0; i <= bounds_.size(); ++i) buckets_[i].store(0, std::memory_order_relaxed);
+}
+
+void Histogram::observe(double value) {
+    size_t bucket = 0;
+    while (bucket < bounds_.size() && value > bounds_[bucket]) ++bucket;
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    double sum = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+    }
+}
+
+std::vector<uint64_t> Histogram::bucketCounts() const {
+    std::vector<uint64_t> counts(bounds_.size() + 1);
+    for (size_t i = 0; i < counts.size(); ++i) counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    return counts;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+std::vector<double> MetricsRegistry::latencyBuckets() {
+    return {0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30};
+}
+
+MetricsRegistry::Series& MetricsRegistry::series(const std::string& name, const std::string& help, Type type,
+                                                 const MetricLabels& labels) {
+    auto [it, inserted] = families_.try_emplace(name, Family{type, help, {}});
+    if (!inserted && it->second.type != type) {
+        throw std::logic_error("Metric " + name + " already registered with a different type");
+    }
+    return it->second.series[labels];
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = series(name, help, Type::Counter, labels);
+    if (!s.counter) s.counter = std::make_unique<Counter>();
+    return *s.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = series(name, help, Type::Gauge, labels);
+    if (!s.gauge) s.gauge = std::make_unique<Gauge>();
+    return *s.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const MetricLabels& labels, const std::vector<double>& bounds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = series(name, help, Type::Histogram, labels);
+    if (!s.histogram) s.histogram = std::make_unique<Histogram>(bounds);
+    return *s.histogram;
+}
+
+void MetricsRegistry::counterFn(const std::string& name, const std::string& help, const MetricLabels& labels,
+                                std::function<double()> read) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    series(name, help, Type::Counter, labels).read = std::move(read);
+}
+
+void MetricsRegistry::gaugeFn(const std::string& name, const std::string& help, const MetricLabels& labels,
+                              std::function<double()> read) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    series(name, help, Type::Gauge, labels).read = std::move(read);
+}
+
+std::string MetricsRegistry::renderPrometheus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    out.reserve(4096);
+    for (const auto& [name, family] : families_) {
+        static const char* typeNames[] = {"counter", "gauge", "histogram"};
+        out += "# HELP " + name + ' ' + family.help + '\n';
+        out += "# TYPE " + name + ' ' + typeNames[static_cast<int>(family.type)] + '\n';
+
+        for (const auto& [labels, s] : family.series) {
+            if (s.read) {
+                appendSample(out, name, labels, s.read());
+            } else if (s.counter) {
+                appendSample(out, name, labels, static_cast<double>(s.counter->value()));
+            } else if (s.gauge) {
+                appendSample(out, name, labels, static_cast<double>(s.gauge->value()));
+            } else if (s.histogram) {
+                const Histogram& h = *s.histogram;
+                std::vector<uint64_t> counts = h.bucketCounts();
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i < counts.size(); ++i) {
+                    cumulative += counts[i];
+                    std::string le;
+                    if (i < h.bounds().size()) appendNumber(le, h.bounds()[i]);
+                    else le = "+Inf";
+                    out += name + "_bucket";
+                    appendLabels(out, labels, "le", le);
+                    out += ' ';
+                    appendNumber(out, static_cast<double>(cumulative));
+                    out += '\n';
+                }
+                appendSample(out, name + "_sum", labels, h.sum());
+                // Derived from the buckets so _count always matches +Inf.
+                appendSample(out, name + "_count", labels, static_cast<double>(cumulative));
+            }
+        }
+    }
+    return out;
+}
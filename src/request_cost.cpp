@@ -0,0 +1,66 @@
+#include "request_cost.hpp"
+#include <cstdio>
+
+namespace {
+
+thread_local std::shared_ptr<RequestCost> currentCost;
+
+const char* const phaseNames[RequestCost::phaseCount] = {"cache", "iata", "provider", "parse", "serialize"};
+
+void appendDuration(std::string& out, std::chrono::nanoseconds elapsed) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), ";dur=%.2f", static_cast<double>(elapsed.count()) / 1e6);
+    out += buf;
+}
+
+} // namespace
+
+void RequestCost::add(Phase phase, std::chrono::nanoseconds elapsed) {
+    phaseNanos_[static_cast<size_t>(phase)].fetch_add(elapsed.count(), std::memory_order_relaxed);
+}
+
+void RequestCost::addUpstreamCall(size_t responseBytes, std::chrono::nanoseconds elapsed) {
+    upstreamCalls_.fetch_add(1, std::memory_order_relaxed);
+    upstreamBytes_.fetch_add(responseBytes, std::memory_order_relaxed);
+    upstreamNanos_.fetch_add(elapsed.count(), std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds RequestCost::phaseTime(Phase phase) const {
+    return std::chrono::nanoseconds(phaseNanos_[static_cast<size_t>(phase)].load(std::memory_order_relaxed));
+}
+
+std::string RequestCost::serverTimingHeader(std::chrono::nanoseconds total) const {
+    std::string header;
+    for (size_t i = 0; i < phaseCount; ++i) {
+        int64_t nanos = phaseNanos_[i].load(std::memory_order_relaxed);
+        if (nanos == 0) continue;
+        header += phaseNames[i];
+        appendDuration(header, std::chrono::nanoseconds(nanos));
+        header += ", ";
+    }
+    uint64_t calls = upstreamCalls();
+    if (calls > 0) {
+        header += "upstream";
+        appendDuration(header, std::chrono::nanoseconds(upstreamNanos_.load(std::memory_order_relaxed)));
+        header += ";desc=\"calls=" + std::to_string(calls) + " bytes=" + std::to_string(upstreamBytes()) + "\", ";
+    }
+    header += "total";
+    appendDuration(header, total);
+    return header;
+}
+
+std::shared_ptr<RequestCost> RequestCost::current() { return currentCost; }
+
+RequestCostScope::RequestCostScope(std::shared_ptr<RequestCost> cost) : previous_(std::move(currentCost)) {
+    currentCost = std::move(cost);
+}
+
+RequestCostScope::~RequestCostScope() { currentCost = std::move(previous_); }
+
+PhaseTimer::PhaseTimer(RequestCost::Phase phase)
+    : cost_(currentCost.get()), phase_(phase),
+      start_(cost_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+
+PhaseTimer::~PhaseTimer() {
+    if (cost_) cost_->add(phase_, std::chrono::steady_clock::now() - start_);
+}
@@ -0,0 +1,54 @@
+#include "retry_budget.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+constexpr int64_t kMilli = 1000; // balance units per token
+
+int64_t milliTokens(double tokens) { return static_cast<int64_t>(std::llround(tokens * kMilli)); }
+
+} // namespace
+
+RetryBudget::RetryBudget(const std::string& service) : RetryBudget(service, Config()) {}
+
+RetryBudget::RetryBudget(const std::string& service, const Config& config)
+    : deposit_(milliTokens(config.ratio)),
+      capacity_(milliTokens(config.capacity)),
+      balance_(capacity_),
+      exhausted_(MetricsRegistry::instance().counter("travelplanner_retry_budget_exhausted_total",
+                                                     "Retries skipped because the service's retry budget was spent",
+                                                     {{"service", service}})) {}
+
+RetryBudget& RetryBudget::forService(const std::string& service) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::unique_ptr<RetryBudget>> budgets;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& budget = budgets[service];
+    if (!budget) budget = std::make_unique<RetryBudget>(service);
+    return *budget;
+}
+
+void RetryBudget::recordRequest() {
+    int64_t balance = balance_.load(std::memory_order_relaxed);
+    while (balance < capacity_ &&
+           !balance_.compare_exchange_weak(balance, std::min(capacity_, balance + deposit_),
+                                           std::memory_order_relaxed)) {
+    }
+}
+
+bool RetryBudget::tryRetry() {
+    int64_t balance = balance_.load(std::memory_order_relaxed);
+    while (balance >= kMilli) {
+        if (balance_.compare_exchange_weak(balance, balance - kMilli, std::memory_order_relaxed)) return true;
+    }
+    exhausted_.inc();
+    return false;
+}
+
+double RetryBudget::tokens() const {
+    return static_cast<double>(balance_.load(std::memory_order_relaxed)) / kMilli;
+}
@@ -3,10 +3,23 @@
 #include <crow/middlewares/cors.h>
 #include "api_handler.hpp"
 #include "logger.hpp"
+#include "metrics.hpp"
+#include "tracing.hpp"
+#include "request_cost.hpp"
+#include "upstream_error.hpp"
+#include <chrono>
+#include <algorithm>
 #include <string>
+#include <cstddef>
 #include <cstdlib>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <memory_resource>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace std;
 using json = nlohmann::json;
@@ -16,25 +29,244 @@ namespace {
 // Flight responses carry the backing provider and whether the results are
 // real bookable inventory, so a client can never mistake an estimate for a
 // flight it can actually buy.
-json serializeFlights(const std::vector<Flight>& flights) {
+//
+// The serialize* helpers return the finished body so that building and
+// dumping the JSON are both charged to the request's serialize phase.
+std::string serializeFlights(const FlightTable& flights) {
+    PhaseTimer timer(RequestCost::Phase::Serialize);
     json arr = json::array();
-    for (const auto& f : flights) {
+    arr.get_ref<json::array_t&>().reserve(flights.size());
+    for (FlightTable::Row f : flights) {
         arr.push_back({
             {"airline", f.getAirline()},
             {"flightNumber", f.getFlightNumber()},
             {"departureAirport", f.getDepartureAirport()},
             {"arrivalAirport", f.getArrivalAirport()},
             {"price", f.getPrice()},
-            {"currency", f.getCurrency()},
+            {"currency", flights.currency()},
             {"availableSeats", f.getAvailableSeats()},
-            {"source", f.getSource()}
+            {"source", flights.source()}
         });
     }
     return json{
         {"provider", APIHandler::activeFlightProviderName()},
         {"bookable", APIHandler::flightResultsAreBookable()},
         {"flights", arr}
-    };
+    }.dump();
+}
+
+std::string serializeHotels(const std::pmr::vector<Hotel>& hotels) {
+    PhaseTimer timer(RequestCost::Phase::Serialize);
+    json arr = json::array();
+    for (const auto& h : hotels) {
+        arr.push_back({
+            {"name", h.getName()},
+            {"location", h.getLocation()},
+            {"pricePerNight", h.getPricePerNight()},
+            {"rating", h.getRating()},
+            {"address", h.getAddress()}
+        });
+    }
+    return arr.dump();
+}
+
+std::string serializeItinerary(const std::pmr::vector<ItineraryItem>& items) {
+    PhaseTimer timer(RequestCost::Phase::Serialize);
+    json arr = json::array();
+    for (const auto& item : items) {
+        arr.push_back({
+            {"activity", item.getActivity()},
+            {"date", item.getDate()},
+            {"time", item.getTime()},
+            {"category", item.getCategory()}
+        });
+    }
+    return arr.dump();
+}
+
+std::string serializeWeather(const json& forecast) {
+    PhaseTimer timer(RequestCost::Phase::Serialize);
+    return forecast.dump();
+}
+
+// Upstream calls (Gemini, Amadeus, WeatherAPI) take seconds and retries
+// back off for longer still. Run on Crow's workers, a few slow calls would
+// stall every route, so routes instead park their crow::response and the
+// upstream work completes on this shared io_context. Crow's threads go
+// straight back to accepting connections. Every route waits on the HTTP
+// engine's callbacks rather than on a thread, so this pool only runs CPU
+// work (parsing, serializing) and is sized to the cores by default.
+class UpstreamExecutor {
+public:
+    explicit UpstreamExecutor(unsigned threads) : work_(asio::make_work_guard(io_)) {
+        for (unsigned i = 0; i < threads; ++i) {
+            threads_.emplace_back([this] { io_.run(); });
+        }
+    }
+
+    ~UpstreamExecutor() {
+        work_.reset();
+        io_.stop();
+        for (auto& t : threads_) t.join();
+    }
+
+    asio::io_context& context() { return io_; }
+
+private:
+    asio::io_context io_;
+    asio::executor_work_guard<asio::io_context::executor_type> work_;
+    std::vector<std::thread> threads_;
+};
+
+UpstreamExecutor& upstream() {
+    static UpstreamExecutor executor([] {
+        unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+        if (const char* env = getenv("UPSTREAM_THREADS")) {
+            try { threads = static_cast<unsigned>(std::max(1, stoi(env))); } catch (...) {}
+        }
+        return threads;
+    }());
+    return executor;
+}
+
+// A route's name and its metric series, resolved from the registry once
+// per route (each handler keeps a static one) rather than per response.
+struct Route {
+    explicit Route(const char* name)
+        : name(name),
+          upstreamCalls(MetricsRegistry::instance().histogram("travelplanner_request_upstream_calls",
+                                                              "Upstream HTTP calls made per inbound request",
+                                                              {{"route", name}}, {0, 1, 2, 3, 5, 8, 13})) {}
+
+    const char* name;
+    // Flags routes that fan out into more upstream calls than expected.
+    Histogram& upstreamCalls;
+};
+
+void reply(crow::response& res, int code, const std::string& body) {
+    res.code = code;
+    res.end(body);
+}
+
+// Finishes `res` off the Crow worker. `work` runs on the upstream executor
+// and hands the response body to the `Finish` it is given (see
+// completeAsync below). Route parameters must be copied into `work`
+// first - the crow::request does not outlive the handler.
+//
+// The work runs under a root span named after the route; its trace ID is
+// returned as X-Trace-Id so a slow response can be found in TRACE_FILE.
+// It is also charged to a RequestCost reported as Server-Timing, so the
+// browser's devtools show where the time went and how many upstream calls
+// the request made.
+//
+// `work` receives the request's arena: a monotonic resource over a fixed
+// buffer, spilling to the heap only past that. Results built in it are
+// freed all at once when the request ends. Only the finished body string
+// outlives it. nlohmann::json does not take a runtime memory resource, so
+// its DOMs and the body itself still use the heap.
+constexpr size_t kRequestArenaBytes = 16 << 10;
+
+// Completes a request: with `error` set, a 500 (503 for a call shed
+// locally, see ServiceUnavailable); otherwise `body()` - the
+// serializer - runs under the request's own cost and trace, since the
+// calling thread may be finishing someone else's work (the leader of a
+// coalesced flight search, say).
+using Finish = std::function<void(std::exception_ptr error, const std::function<std::string()>& body)>;
+
+// Everything a request needs until its response is sent, which happens
+// on some other thread, possibly after timer-driven retries. Held by shared_ptr from each pending callback.
+class PendingRequest {
+public:
+    PendingRequest(crow::response& res, const Route& route)
+        : res_(res), route_(route), queuedAt_(std::chrono::steady_clock::now()) {}
+
+    std::pmr::memory_resource* arena() { return &arena_; }
+    const std::shared_ptr<RequestCost>& cost() const { return cost_; }
+    SpanContext trace() const { return root_.context; }
+
+    // Opens the root span once the work is picked up from the queue.
+    void begin() {
+        if (!Tracer::instance().enabled()) return;
+        root_.name = route_.name;
+        root_.context = SpanContext{Tracer::newId(), Tracer::newId()};
+        root_.start = std::chrono::system_clock::now();
+        startedAt_ = std::chrono::steady_clock::now();
+        auto queued = std::chrono::duration_cast<std::chrono::microseconds>(startedAt_ - queuedAt_);
+        root_.attributes.emplace_back("queue_us", to_string(queued.count()));
+        res_.set_header("X-Trace-Id", Tracer::toHex(root_.context.traceId));
+    }
+
+    void finish(std::exception_ptr error, const std::function<std::string()>& produce) {
+        RequestCostScope charge(cost_);
+        ScopedSpanContext scope(root_.context);
+        std::string body;
+        if (!error) {
+            try {
+                body = produce();
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        int code = 200;
+        if (error) {
+            code = 500;
+            try {
+                std::rethrow_exception(error);
+            } catch (const ServiceUnavailable& e) {
+                // Shed by a circuit breaker or bulkhead before any upstream
+                // call: tell the client to come back rather than fail.
+                code = 503;
+                body = e.what();
+                res_.set_header("Retry-After", "1");
+            } catch (const std::exception& e) {
+                body = e.what();
+            } catch (...) {
+                body = "Internal error";
+            }
+        }
+        if (root_.context) {
+            root_.error = error != nullptr;
+            root_.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - startedAt_);
+            Tracer::instance().record(root_);
+        }
+        route_.upstreamCalls.observe(static_cast<double>(cost_->upstreamCalls()));
+        res_.set_header("Server-Timing", cost_->serverTimingHeader(std::chrono::steady_clock::now() - queuedAt_));
+        res_.set_header("Timing-Allow-Origin", "*");
+        reply(res_, code, body);
+    }
+
+private:
+    crow::response& res_;
+    const Route& route_;
+    std::chrono::steady_clock::time_point queuedAt_;
+    std::chrono::steady_clock::time_point startedAt_{};
+    SpanRecord root_;
+    std::shared_ptr<RequestCost> cost_ = std::make_shared<RequestCost>();
+    alignas(std::max_align_t) std::byte buffer_[kRequestArenaBytes];
+    std::pmr::monotonic_buffer_resource arena_{buffer_, sizeof(buffer_)};
+};
+
+// `work(arena, finish)` starts the request and calls
+// `finish` exactly once, from whatever thread completes it. No thread is
+// held while upstream calls (or the backoff before a retry) are pending.
+template <typename Work>
+void completeAsync(crow::response& res, const Route& route, Work work) {
+    auto request = std::make_shared<PendingRequest>(res, route);
+    asio::post(upstream().context(), [request, work = std::move(work)]() mutable {
+        request->begin();
+        RequestCostScope charge(request->cost());
+        ScopedSpanContext scope(request->trace());
+        // `request` is captured so the arena outlives everything built in it.
+        Finish finish = [request](std::exception_ptr error, const std::function<std::string()>& body) {
+            request->finish(error, body);
+        };
+        try {
+            work(request->arena(), finish);
+        } catch (...) {
+            finish(std::current_exception(), {});
+        }
+    });
 }
 
 } // namespace
@@ -43,6 +275,10 @@ int main() {
     crow::App<crow::CORSHandler> app;
     APIHandler::initializeAPIKeys();
     Logger::info("TravelPlanner API server starting up");
+    upstream(); // start the upstream pool before any route can need it
+    APIHandler::setBackgroundExecutor([](std::function<void()> task) {
+        asio::post(upstream().context(), std::move(task));
+    });
 
     // Permissive CORS for local demo purposes only - do not use this
     // configuration as-is in a production deployment.
@@ -66,70 +302,74 @@ int main() {
         return res;
     });
 
+    // Prometheus scrape target: upstream latency, cache hit ratios, breaker state.
+    CROW_ROUTE(app, "/metrics")
+    ([]() {
+        crow::response res(MetricsRegistry::instance().renderPrometheus());
+        res.set_header("Content-Type", "text/plain; version=0.0.4");
+        return res;
+    });
+
     CROW_ROUTE(app, "/weather").methods("GET"_method)
-    ([](const crow::request& req) {
+    ([](const crow::request& req, crow::response& res) {
         auto city = req.url_params.get("city");
         auto days_str = req.url_params.get("days");
         if (!city || !days_str) {
-            return crow::response(400, "Missing city or days parameter");
+            return reply(res, 400, "Missing city or days parameter");
         }
         int days = std::stoi(days_str);
-        try {
-            json result = APIHandler::getWeatherJson(city, days);
-            return crow::response(result.dump());
-        } catch (const std::exception& e) {
-            return crow::response(500, e.what());
-        }
+        static const Route route("GET /weather");
+        completeAsync(res, route, [city = std::string(city), days](std::pmr::memory_resource*,
+                                                                   const Finish& finish) {
+            APIHandler::getWeatherJsonAsync(city, days, [finish](std::exception_ptr error, json forecast) {
+                finish(error, [&] { return serializeWeather(forecast); });
+            });
+        });
     });
 
     CROW_ROUTE(app, "/flights").methods("GET"_method)
-    ([](const crow::request& req) {
+    ([](const crow::request& req, crow::response& res) {
         auto from = req.url_params.get("from");
         auto to = req.url_params.get("to");
         auto date = req.url_params.get("date");
         auto passengers_str = req.url_params.get("passengers");
         if (!from || !to || !date || !passengers_str) {
-            return crow::response(400, "Missing required parameters");
+            return reply(res, 400, "Missing required parameters");
         }
         int passengers = std::stoi(passengers_str);
-        try {
-            auto flights = APIHandler::searchFlights(from, to, date, passengers);
-            return crow::response(serializeFlights(flights).dump());
-        } catch (const std::exception& e) {
-            return crow::response(500, e.what());
-        }
+        static const Route route("GET /flights");
+        completeAsync(res, route, [from = std::string(from), to = std::string(to), date = std::string(date),
+                                   passengers](std::pmr::memory_resource* arena, const Finish& finish) {
+            APIHandler::searchFlightsAsync(from, to, date, passengers, arena,
+                                           [finish](std::exception_ptr error, FlightTable flights) {
+                finish(error, [&] { return serializeFlights(flights); });
+            });
+        });
     });
 
     CROW_ROUTE(app, "/hotels").methods("GET"_method)
-    ([](const crow::request& req) {
+    ([](const crow::request& req, crow::response& res) {
         auto city = req.url_params.get("city");
         auto checkin = req.url_params.get("checkin");
         auto checkout = req.url_params.get("checkout");
         auto guests_str = req.url_params.get("guests");
         if (!city || !checkin || !checkout || !guests_str) {
-            return crow::response(400, "Missing required parameters");
+            return reply(res, 400, "Missing required parameters");
         }
         int guests = std::stoi(guests_str);
-        try {
-            auto hotels = APIHandler::searchHotels(city, checkin, checkout, guests);
-            json arr = json::array();
-            for (const auto& h : hotels) {
-                arr.push_back({
-                    {"name", h.getName()},
-                    {"location", h.getLocation()},
-                    {"pricePerNight", h.getPricePerNight()},
-                    {"rating", h.getRating()},
-                    {"address", h.getAddress()}
-                });
-            }
-            return crow::response(arr.dump());
-        } catch (const std::exception& e) {
-            return crow::response(500, e.what());
-        }
+        static const Route route("GET /hotels");
+        completeAsync(res, route, [city = std::string(city), checkin = std::string(checkin),
+                                   checkout = std::string(checkout),
+                                   guests](std::pmr::memory_resource* arena, const Finish& finish) {
+            APIHandler::searchHotelsAsync(city, checkin, checkout, guests, arena,
+                                          [finish](std::exception_ptr error, std::pmr::vector<Hotel> hotels) {
+                finish(error, [&] { return serializeHotels(hotels); });
+            });
+        });
     });
 
     CROW_ROUTE(app, "/itinerary").methods("GET"_method)
-    ([](const crow::request& req) {
+    ([](const crow::request& req, crow::response& res) {
         auto destination = req.url_params.get("destination");
         auto start = req.url_params.get("start");
         auto end = req.url_params.get("end");
@@ -137,32 +377,24 @@ int main() {
         auto budget_str = req.url_params.get("budget");
         auto hotel = req.url_params.get("hotel");
         if (!destination || !start || !end || !people_str || !budget_str || !hotel) {
-            return crow::response(400, "Missing required parameters");
-        }
-        int people = std::stoi(people_str);
-        double budget = std::stod(budget_str);
-        // For demo, create a dummy hotel (in real use, parse hotel JSON or fetch from DB)
-        Hotel selectedHotel(hotel, destination, 0, 0, start, end, "", APIHandler::CURRENCY_CODE);
-        try {
-            auto items = APIHandler::generateItinerary(destination, start, end, people, budget, selectedHotel);
-            json arr = json::array();
-            for (const auto& item : items) {
-                arr.push_back({
-                    {"activity", item.getActivity()},
-                    {"date", item.getDate()},
-                    {"time", item.getTime()},
-                    {"category", item.getCategory()}
-                });
-            }
-            return crow::response(arr.dump());
-        } catch (const std::exception& e) {
-
-            return crow::response(500, e.what());
+            return reply(res, 400, "Missing required parameters");
         }
+        static const Route route("GET /itinerary");
+        completeAsync(res, route,
+                      [destination = std::string(destination), start = std::string(start),
+                       end = std::string(end), hotel = std::string(hotel)](std::pmr::memory_resource* arena, const Finish& finish) {
+            // For demo, create a dummy hotel (in real use, parse hotel JSON or fetch from DB)
+            Hotel selectedHotel(hotel, destination, 0, 0, start, end, "", APIHandler::CURRENCY_CODE, arena);
+            APIHandler::generateItineraryAsync(destination, start, end, selectedHotel, arena,
+                                               [finish](std::exception_ptr error,
+                                                        std::pmr::vector<ItineraryItem> items) {
+                finish(error, [&] { return serializeItinerary(items); });
+            });
+        });
     });
     // Add POST endpoint for /flights (search flights with JSON body)
     CROW_ROUTE(app, "/flights").methods("POST"_method)
-    ([](const crow::request& req) {
+    ([](const crow::request& req, crow::response& res) {
         try {
             auto body = json::parse(req.body);
             auto from = body.value("from", "");
@@ -170,18 +402,24 @@ int main() {
             auto date = body.value("date", "");
             int passengers = body.value("passengers", 1);
             if (from.empty() || to.empty() || date.empty()) {
-                return crow::response(400, "Missing required parameters in JSON body");
+                return reply(res, 400, "Missing required parameters in JSON body");
             }
-            auto flights = APIHandler::searchFlights(from, to, date, passengers);
-            return crow::response(serializeFlights(flights).dump());
+            static const Route route("POST /flights");
+            completeAsync(res, route, [from, to, date, passengers](std::pmr::memory_resource* arena,
+                                                                   const Finish& finish) {
+                APIHandler::searchFlightsAsync(from, to, date, passengers, arena,
+                                               [finish](std::exception_ptr error, FlightTable flights) {
+                    finish(error, [&] { return serializeFlights(flights); });
+                });
+            });
         } catch (const std::exception& e) {
-            return crow::response(500, e.what());
+            reply(res, 500, e.what());
         }
     });
 
     // Add POST endpoint for /hotels (search hotels with JSON body)
     CROW_ROUTE(app, "/hotels").methods("POST"_method)
-    ([](const crow::request& req) {
+    ([](const crow::request& req, crow::response& res) {
         try {
             auto body = json::parse(req.body);
             auto city = body.value("city", "");
@@ -189,53 +427,45 @@ int main() {
             auto checkout = body.value("checkout", "");
             int guests = body.value("guests", 1);
             if (city.empty() || checkin.empty() || checkout.empty()) {
-                return crow::response(400, "Missing required parameters in JSON body");
+                return reply(res, 400, "Missing required parameters in JSON body");
             }
-            auto hotels = APIHandler::searchHotels(city, checkin, checkout, guests);
-            json arr = json::array();
-            for (const auto& h : hotels) {
-                arr.push_back({
-                    {"name", h.getName()},
-                    {"location", h.getLocation()},
-                    {"pricePerNight", h.getPricePerNight()},
-                    {"rating", h.getRating()},
-                    {"address", h.getAddress()}
+            static const Route route("POST /hotels");
+            completeAsync(res, route, [city, checkin, checkout, guests](std::pmr::memory_resource* arena,
+                                                                       const Finish& finish) {
+                APIHandler::searchHotelsAsync(city, checkin, checkout, guests, arena,
+                                              [finish](std::exception_ptr error, std::pmr::vector<Hotel> hotels) {
+                    finish(error, [&] { return serializeHotels(hotels); });
                 });
-            }
-            return crow::response(arr.dump());
+            });
         } catch (const std::exception& e) {
-            return crow::response(500, e.what());
+            reply(res, 500, e.what());
         }
     });
 
     // Add POST endpoint for /itinerary (generate itinerary with JSON body)
     CROW_ROUTE(app, "/itinerary").methods("POST"_method)
-    ([](const crow::request& req) {
+    ([](const crow::request& req, crow::response& res) {
         try {
             auto body = json::parse(req.body);
             auto destination = body.value("destination", "");
             auto start = body.value("start", "");
             auto end = body.value("end", "");
-            int people = body.value("people", 1);
-            double budget = body.value("budget", 0.0);
             auto hotelName = body.value("hotel", "");
             if (destination.empty() || start.empty() || end.empty() || hotelName.empty()) {
-                return crow::response(400, "Missing required parameters in JSON body");
+                return reply(res, 400, "Missing required parameters in JSON body");
             }
-            Hotel selectedHotel(hotelName, destination, 0, 0, start, end, "", APIHandler::CURRENCY_CODE);
-            auto items = APIHandler::generateItinerary(destination, start, end, people, budget, selectedHotel);
-            json arr = json::array();
-            for (const auto& item : items) {
-                arr.push_back({
-                    {"activity", item.getActivity()},
-                    {"date", item.getDate()},
-                    {"time", item.getTime()},
-                    {"category", item.getCategory()}
+            static const Route route("POST /itinerary");
+            completeAsync(res, route, [destination, start, end, hotelName](std::pmr::memory_resource* arena,
+                                                                          const Finish& finish) {
+                Hotel selectedHotel(hotelName, destination, 0, 0, start, end, "", APIHandler::CURRENCY_CODE, arena);
+                APIHandler::generateItineraryAsync(destination, start, end, selectedHotel, arena,
+                                                   [finish](std::exception_ptr error,
+                                                            std::pmr::vector<ItineraryItem> items) {
+                    finish(error, [&] { return serializeItinerary(items); });
                 });
-            }
-            return crow::response(arr.dump());
+            });
         } catch (const std::exception& e) {
-            return crow::response(500, e.what());
+            reply(res, 500, e.what());
         }
     });
 
@@ -243,7 +473,7 @@ int main() {
     if (const char* portEnv = getenv("PORT")) {
         try { port = stoi(portEnv); } catch (...) {}
     }
-    Logger::info("Listening on http://localhost:" + to_string(port));
+    LOG_INFO("Listening on http://localhost:", port);
     app.port(port).multithreaded().run();
     return 0;
 }
@@ -0,0 +1,64 @@
+#include "timer_queue.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <exception>
+
+TimerQueue& TimerQueue::instance() {
+    static TimerQueue timers;
+    return timers;
+}
+
+TimerQueue::TimerQueue() : thread_([this] { run(); }) {}
+
+TimerQueue::~TimerQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void TimerQueue::schedule(Clock::duration delay, std::function<void()> fn) {
+    bool earliest;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        heap_.push_back(Entry{Clock::now() + delay, nextSeq_++, std::move(fn)});
+        std::push_heap(heap_.begin(), heap_.end(), later);
+        earliest = heap_.front().seq == nextSeq_ - 1;
+    }
+    // Only a new earliest deadline changes how long the thread should sleep.
+    if (earliest) wake_.notify_one();
+}
+
+size_t TimerQueue::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return heap_.size();
+}
+
+void TimerQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (heap_.empty()) {
+            wake_.wait(lock);
+            continue;
+        }
+        if (Clock::now() < heap_.front().due) {
+            wake_.wait_until(lock, heap_.front().due);
+            continue;
+        }
+        std::pop_heap(heap_.begin(), heap_.end(), later);
+        std::function<void()> fn = std::move(heap_.back().fn);
+        heap_.pop_back();
+
+        lock.unlock();
+        try {
+            fn();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Timer callback threw: ", e.what());
+        } catch (...) {
+            LOG_ERROR("Timer callback threw a non-standard exception");
+        }
+        lock.lock();
+    }
+}
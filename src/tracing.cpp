@@ -0,0 +1,152 @@
+#include "tracing.hpp"
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <random>
+#include <thread>
+#include "json.hpp"
+
+namespace {
+
+thread_local SpanContext currentContext;
+
+} // namespace
+
+// Deliberately leaked: spans may end during static destruction, and exit()
+// flushes the export file anyway.
+Tracer& Tracer::instance() {
+    static Tracer* tracer = new Tracer();
+    return *tracer;
+}
+
+Tracer::Tracer() {
+    if (const char* path = std::getenv("TRACE_FILE")) {
+        if (*path) exportTo(path);
+    }
+}
+
+void Tracer::exportTo(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_) {
+        std::fclose(out_);
+        out_ = nullptr;
+    }
+    if (!path.empty()) out_ = std::fopen(path.c_str(), "a");
+    enabled_.store(out_ != nullptr, std::memory_order_relaxed);
+}
+
+SpanContext Tracer::current() { return currentContext; }
+
+uint64_t Tracer::newId() {
+    thread_local std::mt19937_64 rng(std::random_device{}() ^
+                                     std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    uint64_t id;
+    do {
+        id = rng();
+    } while (id == 0);
+    return id;
+}
+
+std::string Tracer::toHex(uint64_t id) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i, id >>= 4) hex[i] = digits[id & 0xf];
+    return hex;
+}
+
+void Tracer::record(const SpanRecord& span) {
+    if (!enabled()) return;
+    using namespace std::chrono;
+    nlohmann::json line = {
+        {"trace_id", toHex(span.context.traceId)},
+        {"span_id", toHex(span.context.spanId)},
+        {"parent_id", span.parentId ? nlohmann::json(toHex(span.parentId)) : nlohmann::json(nullptr)},
+        {"name", span.name},
+        {"start_us", duration_cast<microseconds>(span.start.time_since_epoch()).count()},
+        {"duration_us", span.duration.count()},
+        {"thread", std::hash<std::thread::id>{}(std::this_thread::get_id())},
+    };
+    if (span.error) line["error"] = true;
+    if (!span.attributes.empty()) {
+        nlohmann::json attributes = nlohmann::json::object();
+        for (const auto& [key, value] : span.attributes) attributes[key] = value;
+        line["attributes"] = std::move(attributes);
+    }
+    std::string text = line.dump();
+    text += '\n';
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_) std::fwrite(text.data(), 1, text.size(), out_);
+}
+
+void Tracer::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_) std::fflush(out_);
+}
+
+Span::Span(std::string name) : Span(std::move(name), currentContext) {}
+
+Span::Span(std::string name, SpanContext parent) {
+    if (!Tracer::instance().enabled()) return;
+    active_ = true;
+    uncaughtAtStart_ = std::uncaught_exceptions();
+    previous_ = currentContext;
+    startedAt_ = std::chrono::steady_clock::now();
+
+    record_.name = std::move(name);
+    record_.start = std::chrono::system_clock::now();
+    record_.parentId = parent.spanId;
+    record_.context.traceId = parent ? parent.traceId : Tracer::newId();
+    record_.context.spanId = Tracer::newId();
+    currentContext = record_.context;
+}
+
+Span::~Span() {
+    if (!active_) return;
+    currentContext = previous_;
+    // Unwinding out of the span's scope means the work it timed failed.
+    if (std::uncaught_exceptions() > uncaughtAtStart_) record_.error = true;
+    record_.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startedAt_);
+    Tracer::instance().record(record_);
+}
+
+void Span::set(std::string key, std::string value) {
+    if (active_) record_.attributes.emplace_back(std::move(key), std::move(value));
+}
+
+AsyncSpan::AsyncSpan(std::string name) {
+    SpanContext parent = currentContext;
+    if (!Tracer::instance().enabled()) {
+        record_.context = parent;
+        return;
+    }
+    active_ = true;
+    startedAt_ = std::chrono::steady_clock::now();
+
+    record_.name = std::move(name);
+    record_.start = std::chrono::system_clock::now();
+    record_.parentId = parent.spanId;
+    record_.context.traceId = parent ? parent.traceId : Tracer::newId();
+    record_.context.spanId = Tracer::newId();
+}
+
+AsyncSpan::~AsyncSpan() { end(true); }
+
+void AsyncSpan::set(std::string key, std::string value) {
+    if (active_) record_.attributes.emplace_back(std::move(key), std::move(value));
+}
+
+void AsyncSpan::end(bool error) {
+    if (!active_ || ended_.exchange(true, std::memory_order_acq_rel)) return;
+    record_.error = error;
+    record_.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startedAt_);
+    Tracer::instance().record(record_);
+}
+
+ScopedSpanContext::ScopedSpanContext(SpanContext context) : previous_(currentContext) {
+    currentContext = context;
+}
+
+ScopedSpanContext::~ScopedSpanContext() { currentContext = previous_; }
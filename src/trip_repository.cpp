@@ -2,6 +2,7 @@
 #include "logger.hpp"
 #include <sqlite3.h>
 #include <stdexcept>
+#include <string_view>
 
 namespace {
 // RAII wrapper so a prepared statement is always finalized, including on
@@ -32,7 +33,7 @@ TripRepository::TripRepository(const std::string& dbPath) {
         throw std::runtime_error("Failed to open database " + dbPath + ": " + err);
     }
     initSchema();
-    Logger::info("Trip repository opened at " + dbPath);
+    LOG_INFO("Trip repository opened at ", dbPath);
 }
 
 TripRepository::~TripRepository() {
@@ -124,21 +125,20 @@ long long TripRepository::saveTrip(long long userId, const Trip& trip) {
     for (const auto& item : trip.getItinerary()) {
         Stmt insertItem(db,
             "INSERT INTO itinerary_items (trip_id, activity, date, time, category) VALUES (?, ?, ?, ?, ?);");
-        std::string activity = item.getActivity();
-        std::string date = item.getDate();
-        std::string time = item.getTime();
-        std::string category = item.getCategory();
+        auto bindText = [&](int index, std::string_view text) {
+            sqlite3_bind_text(insertItem.get(), index, text.data(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+        };
         sqlite3_bind_int64(insertItem.get(), 1, tripId);
-        sqlite3_bind_text(insertItem.get(), 2, activity.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(insertItem.get(), 3, date.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(insertItem.get(), 4, time.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(insertItem.get(), 5, category.c_str(), -1, SQLITE_TRANSIENT);
+        bindText(2, item.getActivity());
+        bindText(3, item.getDate());
+        bindText(4, item.getTime());
+        bindText(5, item.getCategory());
         if (sqlite3_step(insertItem.get()) != SQLITE_DONE) {
             throw std::runtime_error(std::string("Failed to save itinerary item: ") + sqlite3_errmsg(db));
         }
     }
 
-    Logger::info("Saved trip to " + trip.getDestination() + " (id " + std::to_string(tripId) + ")");
+    LOG_INFO("Saved trip to ", trip.getDestination(), " (id ", tripId, ")");
     return tripId;
 }
 
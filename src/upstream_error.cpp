@@ -0,0 +1,81 @@
+#include "upstream_error.hpp"
+#include "fast_parse.hpp"
+#include <array>
+
+HttpError::HttpError(int status, std::string body, std::optional<std::chrono::milliseconds> retryAfter)
+    : UpstreamError("HTTP error " + std::to_string(status) + ": " + body),
+      status_(status),
+      body_(std::move(body)),
+      retryAfter_(retryAfter) {}
+
+bool HttpError::retryable() const {
+    switch (status_) {
+    case 408:
+    case 429:
+    case 502:
+    case 503:
+    case 504:
+        return true;
+    default:
+        return false;
+    }
+}
+
+TransportError::TransportError(Kind kind, const std::string& reason)
+    : UpstreamError("Curl failed: " + reason), kind_(kind) {}
+
+namespace {
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r' ||
+                             text.back() == '\n')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool parseDigits(std::string_view text, int& out) {
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+    }
+    return !text.empty() && FastParse::parseInt(text, out);
+}
+
+// "Sun, 06 Nov 1994 08:49:37 GMT" - the only date form senders may use
+// (RFC 9110 5.6.7); the obsolete ones aren't worth the code.
+std::optional<std::chrono::system_clock::time_point> parseImfFixdate(std::string_view text) {
+    static constexpr std::array<std::string_view, 12> months = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                                                "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    if (text.size() != 29 || text[3] != ',' || text[4] != ' ' || text[7] != ' ' || text[11] != ' ' ||
+        text[16] != ' ' || text[19] != ':' || text[22] != ':' || text.substr(25) != " GMT") {
+        return std::nullopt;
+    }
+    int day = 0, year = 0, hour = 0, minute = 0, second = 0;
+    if (!parseDigits(text.substr(5, 2), day) || !parseDigits(text.substr(12, 4), year) ||
+        !parseDigits(text.substr(17, 2), hour) || !parseDigits(text.substr(20, 2), minute) ||
+        !parseDigits(text.substr(23, 2), second)) {
+        return std::nullopt;
+    }
+    int month = 0;
+    while (month < 12 && months[month] != text.substr(8, 3)) ++month;
+    if (month == 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) return std::nullopt;
+
+    int64_t days = FastParse::daysFromCivil(year, month + 1, day);
+    return std::chrono::system_clock::time_point(std::chrono::seconds(days * 86400 + hour * 3600 +
+                                                                      minute * 60 + second));
+}
+
+} // namespace
+
+std::optional<std::chrono::milliseconds> parseRetryAfter(std::string_view value,
+                                                         std::chrono::system_clock::time_point now) {
+    value = trim(value);
+    int seconds = 0;
+    if (parseDigits(value, seconds)) return std::chrono::seconds(seconds);
+
+    auto at = parseImfFixdate(value);
+    if (!at) return std::nullopt;
+    if (*at <= now) return std::chrono::milliseconds(0);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(*at - now);
+}
@@ -0,0 +1,17 @@
+#include "url_redaction.hpp"
+
+std::string redactUrlForLog(const std::string& url) {
+    size_t start = url.find("://");
+    start = (start == std::string::npos) ? 0 : start + 3;
+
+    size_t end = url.find_first_of("?#", start);
+    if (end == std::string::npos) end = url.size();
+
+    // Userinfo only counts if the '@' comes before the path starts.
+    size_t pathStart = url.find('/', start);
+    size_t at = url.find('@', start);
+    if (at != std::string::npos && at < end && (pathStart == std::string::npos || at < pathStart)) {
+        start = at + 1;
+    }
+    return url.substr(start, end - start);
+}
@@ -0,0 +1,89 @@
+#include <catch2/catch_test_macros.hpp>
+#include "admission.hpp"
+#include "upstream_error.hpp"
+#include <chrono>
+#include <future>
+#include <thread>
+
+using namespace std::chrono_literals;
+using Mode = CircuitBreaker::Mode;
+
+namespace {
+
+// A one-slot bulkhead and a circuit opened by a single failure that is
+// ready to probe once `cooldown` has passed.
+struct Upstream {
+    TimerQueue timers;
+    Bulkhead bulkhead{timers};
+    CircuitBreaker breaker;
+
+    Upstream(const std::string& service, std::chrono::milliseconds cooldown) {
+        Bulkhead::Config slots;
+        slots.maxConcurrent = 1;
+        slots.maxQueueWait = 20ms;
+        bulkhead.configure(service, slots);
+
+        CircuitBreaker::Config circuit;
+        circuit.minimumCalls = 1;
+        circuit.cooldown = cooldown;
+        breaker.configure(service, circuit);
+        breaker.recordFailure(service, {}, 1ms);
+    }
+};
+
+} // namespace
+
+TEST_CASE("a full bulkhead doesn't use up a half-open circuit's probe", "[admission]") {
+    Upstream upstream("ad-probe", 10ms);
+    std::this_thread::sleep_for(20ms);
+    REQUIRE(upstream.breaker.mode("ad-probe") == Mode::Open);
+
+    auto busy = upstream.bulkhead.acquire("ad-probe");
+    CHECK_THROWS_AS(admit("ad-probe", upstream.bulkhead, upstream.breaker), ServiceUnavailable);
+    // Refused by the bulkhead before the breaker was asked.
+    CHECK(upstream.breaker.mode("ad-probe") == Mode::Open);
+
+    busy.release();
+    Admission probe = admit("ad-probe", upstream.bulkhead, upstream.breaker);
+    CHECK(upstream.breaker.mode("ad-probe") == Mode::HalfOpen);
+    upstream.breaker.recordSuccess("ad-probe", probe.ticket, 1ms);
+    CHECK(upstream.breaker.mode("ad-probe") == Mode::Closed);
+}
+
+TEST_CASE("a call the circuit refuses gives its slot back", "[admission]") {
+    Upstream upstream("ad-open", 10s);
+
+    CHECK_THROWS_AS(admit("ad-open", upstream.bulkhead, upstream.breaker), ServiceUnavailable);
+    CHECK(upstream.bulkhead.active("ad-open") == 0);
+
+    std::promise<bool> refused;
+    admitAsync("ad-open", [&](std::exception_ptr error, Admission admission) {
+        refused.set_value(error && !admission.permit);
+    }, upstream.bulkhead, upstream.breaker);
+    CHECK(refused.get_future().get());
+    CHECK(upstream.bulkhead.active("ad-open") == 0);
+}
+
+TEST_CASE("async admission queues for the slot before probing", "[admission]") {
+    Upstream upstream("ad-async", 10ms);
+    std::this_thread::sleep_for(20ms);
+
+    auto busy = upstream.bulkhead.acquire("ad-async");
+    std::promise<bool> timedOut;
+    admitAsync("ad-async", [&](std::exception_ptr error, Admission) { timedOut.set_value(error != nullptr); },
+               upstream.bulkhead, upstream.breaker);
+    auto outcome = timedOut.get_future();
+    REQUIRE(outcome.wait_for(2s) == std::future_status::ready);
+    CHECK(outcome.get());
+    CHECK(upstream.breaker.mode("ad-async") == Mode::Open);
+
+    busy.release();
+    std::promise<CircuitBreaker::Ticket> admitted;
+    admitAsync("ad-async", [&](std::exception_ptr error, Admission admission) {
+        admitted.set_value(error ? CircuitBreaker::Ticket{} : admission.ticket);
+    }, upstream.bulkhead, upstream.breaker);
+    CircuitBreaker::Ticket probe = admitted.get_future().get();
+    CHECK(upstream.breaker.mode("ad-async") == Mode::HalfOpen);
+    upstream.breaker.recordFailure("ad-async", probe, 1ms);
+    CHECK(upstream.breaker.mode("ad-async") == Mode::Open);
+}
@@ -0,0 +1,35 @@
+#include <catch2/catch_test_macros.hpp>
+#include "airport_table.hpp"
+
+TEST_CASE("resolves common cities to their main airport", "[airport_table]") {
+    CHECK(AirportTable::lookup("Delhi") == "DEL");
+    CHECK(AirportTable::lookup("Goa") == "GOI");
+    CHECK(AirportTable::lookup("New York") == "JFK");
+    CHECK(AirportTable::lookup("London") == "LHR");
+}
+
+TEST_CASE("knows alternative city names", "[airport_table]") {
+    CHECK(AirportTable::lookup("Bombay") == AirportTable::lookup("Mumbai"));
+    CHECK(AirportTable::lookup("Bengaluru") == "BLR");
+    CHECK(AirportTable::lookup("Bangalore") == "BLR");
+    CHECK(AirportTable::lookup("Saigon") == "SGN");
+    CHECK(AirportTable::lookup("Zürich") == "ZRH");
+}
+
+TEST_CASE("ignores case, spacing and a country qualifier", "[airport_table]") {
+    CHECK(AirportTable::lookup("  new   YORK ") == "JFK");
+    CHECK(AirportTable::lookup("Hyderabad, India") == "HYD");
+    CHECK(AirportTable::lookup("PARIS") == "CDG");
+}
+
+TEST_CASE("accepts a known airport code as-is", "[airport_table]") {
+    CHECK(AirportTable::lookup("bom") == "BOM");
+    CHECK(AirportTable::lookup("CDG") == "CDG");
+}
+
+TEST_CASE("unknown names fall through to the caller", "[airport_table]") {
+    CHECK_FALSE(AirportTable::lookup("Atlantis").has_value());
+    CHECK_FALSE(AirportTable::lookup("").has_value());
+    CHECK_FALSE(AirportTable::lookup("ZZZ").has_value());
+    CHECK(AirportTable::size() > 250);
+}
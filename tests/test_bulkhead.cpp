@@ -0,0 +1,187 @@
+#include <catch2/catch_test_macros.hpp>
+#include "bulkhead.hpp"
+#include "upstream_error.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+Bulkhead::Config limits(size_t maxConcurrent, std::chrono::milliseconds maxQueueWait) {
+    Bulkhead::Config config;
+    config.maxConcurrent = maxConcurrent;
+    config.maxQueueWait = maxQueueWait;
+    return config;
+}
+
+// What an acquireAsync callback was handed, once it runs.
+struct Grant {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool settled = false;
+    std::exception_ptr error;
+    Bulkhead::Permit permit;
+
+    Bulkhead::Callback callback() {
+        return [this](std::exception_ptr e, Bulkhead::Permit p) {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = e;
+            permit = std::move(p);
+            settled = true;
+            changed.notify_all();
+        };
+    }
+
+    bool wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, 2s, [&] { return settled; });
+    }
+
+    bool isSettled() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return settled;
+    }
+};
+
+} // namespace
+
+TEST_CASE("calls beyond the limit wait for a slot", "[bulkhead]") {
+    TimerQueue timers;
+    Bulkhead bulkhead(timers);
+    bulkhead.configure("bh-wait", limits(2, 1000ms));
+
+    auto first = bulkhead.acquire("bh-wait");
+    auto second = bulkhead.acquire("bh-wait");
+    CHECK(bulkhead.active("bh-wait") == 2);
+
+    Grant third;
+    bulkhead.acquireAsync("bh-wait", third.callback());
+    CHECK_FALSE(third.isSettled()); // queued, and the caller wasn't blocked
+    CHECK(bulkhead.queued("bh-wait") == 1);
+
+    first.release();
+    REQUIRE(third.wait());
+    CHECK_FALSE(third.error);
+    CHECK(third.permit);
+    CHECK(bulkhead.active("bh-wait") == 2); // the slot was handed over
+    CHECK(bulkhead.queued("bh-wait") == 0);
+}
+
+TEST_CASE("a full queue is refused after maxQueueWait", "[bulkhead]") {
+    TimerQueue timers;
+    Bulkhead bulkhead(timers);
+    bulkhead.configure("bh-timeout", limits(1, 30ms));
+    auto held = bulkhead.acquire("bh-timeout");
+
+    auto started = std::chrono::steady_clock::now();
+    CHECK_THROWS_AS(bulkhead.acquire("bh-timeout"), ServiceUnavailable);
+    CHECK(std::chrono::steady_clock::now() - started >= 30ms);
+    CHECK(bulkhead.queued("bh-timeout") == 0);
+
+    // A refused waiter never got the slot, so releasing frees it.
+    held.release();
+    CHECK(bulkhead.active("bh-timeout") == 0);
+}
+
+TEST_CASE("no queue wait means an immediate refusal", "[bulkhead]") {
+    TimerQueue timers;
+    Bulkhead bulkhead(timers);
+    bulkhead.configure("bh-fast", limits(1, 0ms));
+    auto held = bulkhead.acquire("bh-fast");
+
+    Grant refused;
+    bulkhead.acquireAsync("bh-fast", refused.callback());
+    REQUIRE(refused.isSettled());
+    CHECK_THROWS_AS(std::rethrow_exception(refused.error), ServiceUnavailable);
+    CHECK_FALSE(refused.permit);
+}
+
+TEST_CASE("waiters are served in arrival order", "[bulkhead]") {
+    TimerQueue timers;
+    Bulkhead bulkhead(timers);
+    bulkhead.configure("bh-fifo", limits(1, 1000ms));
+    auto held = bulkhead.acquire("bh-fifo");
+
+    std::vector<int> order;
+    std::vector<Bulkhead::Permit> permits;
+    for (int i = 0; i < 3; ++i) {
+        bulkhead.acquireAsync("bh-fifo", [&, i](std::exception_ptr error, Bulkhead::Permit permit) {
+            CHECK_FALSE(error);
+            order.push_back(i);
+            permits.push_back(std::move(permit));
+        });
+    }
+    // Each release hands the slot to the next waiter right away (and so
+    // appends to `permits`): release a copy, not the element itself.
+    held.release();
+    Bulkhead::Permit(permits.at(0)).release();
+    Bulkhead::Permit(permits.at(1)).release();
+    CHECK(order == std::vector<int>{0, 1, 2});
+}
+
+TEST_CASE("a permit's copies share one slot", "[bulkhead]") {
+    TimerQueue timers;
+    Bulkhead bulkhead(timers);
+    bulkhead.configure("bh-copy", limits(1, 0ms));
+
+    auto permit = bulkhead.acquire("bh-copy");
+    {
+        Bulkhead::Permit copy = permit;
+        CHECK(bulkhead.active("bh-copy") == 1);
+        copy.release(); // frees it for every copy
+        CHECK(bulkhead.active("bh-copy") == 0);
+        CHECK_FALSE(permit);
+    }
+    permit.release(); // no double release
+    CHECK(bulkhead.active("bh-copy") == 0);
+
+    { auto scoped = bulkhead.acquire("bh-copy"); }
+    CHECK(bulkhead.active("bh-copy") == 0);
+}
+
+TEST_CASE("one saturated service doesn't hold up another", "[bulkhead]") {
+    TimerQueue timers;
+    Bulkhead bulkhead(timers);
+    bulkhead.configure("bh-slow", limits(2, 20ms));
+    bulkhead.configure("bh-healthy", limits(2, 20ms));
+
+    auto a = bulkhead.acquire("bh-slow");
+    auto b = bulkhead.acquire("bh-slow");
+    CHECK_THROWS_AS(bulkhead.acquire("bh-slow"), ServiceUnavailable);
+    CHECK(bulkhead.acquire("bh-healthy"));
+}
+
+TEST_CASE("concurrent callers never exceed the limit", "[bulkhead]") {
+    TimerQueue timers;
+    Bulkhead bulkhead(timers);
+    bulkhead.configure("bh-stress", limits(3, 1000ms));
+
+    std::atomic<int> inside{0};
+    std::atomic<int> peak{0};
+    std::atomic<int> completed{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&] {
+            for (int i = 0; i < 50; ++i) {
+                auto permit = bulkhead.acquire("bh-stress");
+                int now = ++inside;
+                int seen = peak.load();
+                while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+                }
+                std::this_thread::yield();
+                --inside;
+                completed++;
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    CHECK(completed == 400);
+    CHECK(peak <= 3);
+    CHECK(bulkhead.active("bh-stress") == 0);
+}
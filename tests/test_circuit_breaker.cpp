@@ -0,0 +1,210 @@
+#include <catch2/catch_test_macros.hpp>
+#include "circuit_breaker.hpp"
+#include "upstream_error.hpp"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using Mode = CircuitBreaker::Mode;
+
+namespace {
+
+constexpr auto fast = 1ms;
+// Outcomes of calls admitted while the circuit was closed.
+const CircuitBreaker::Ticket closed{};
+
+bool allowed(CircuitBreaker& breaker, const std::string& service, CircuitBreaker::Ticket* ticket = nullptr) {
+    try {
+        CircuitBreaker::Ticket admitted = breaker.checkAllowed(service);
+        if (ticket) *ticket = admitted;
+        return true;
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+// Window of 10, at least 4 calls, half failing or 3/4 slow (>= 100ms).
+CircuitBreaker::Config smallWindow(std::chrono::milliseconds cooldown = 10s) {
+    CircuitBreaker::Config config;
+    config.windowSize = 10;
+    config.windowDuration = 60s;
+    config.minimumCalls = 4;
+    config.failureRateThreshold = 0.5;
+    config.slowCallRateThreshold = 0.75;
+    config.slowCallDuration = 100ms;
+    config.cooldown = cooldown;
+    return config;
+}
+
+} // namespace
+
+TEST_CASE("the circuit opens on the failure rate, not a failure streak", "[circuit_breaker]") {
+    CircuitBreaker breaker;
+    breaker.configure("cb-rate", smallWindow());
+
+    // Successes in between no longer reset anything.
+    for (int i = 0; i < 4; ++i) {
+        breaker.recordFailure("cb-rate", closed, fast);
+        breaker.recordSuccess("cb-rate", closed, fast);
+    }
+    CHECK(breaker.mode("cb-rate") == Mode::Open);
+    CHECK_THROWS_AS(breaker.checkAllowed("cb-rate"), ServiceUnavailable);
+    // A straggler admitted before the trip doesn't close it.
+    breaker.recordSuccess("cb-rate", closed, fast);
+    CHECK(breaker.mode("cb-rate") == Mode::Open);
+}
+
+TEST_CASE("too few calls, or a low failure rate, keep it closed", "[circuit_breaker]") {
+    CircuitBreaker breaker;
+    breaker.configure("cb-closed", smallWindow());
+
+    breaker.recordFailure("cb-closed", closed, fast);
+    breaker.recordFailure("cb-closed", closed, fast);
+    breaker.recordFailure("cb-closed", closed, fast); // 3 < minimumCalls
+    CHECK(breaker.mode("cb-closed") == Mode::Closed);
+
+    // The window slides: the three failures are pushed out by successes.
+    for (int i = 0; i < 10; ++i) breaker.recordSuccess("cb-closed", closed, fast);
+    for (int i = 0; i < 4; ++i) breaker.recordFailure("cb-closed", closed, fast); // 4/10
+    CHECK(breaker.mode("cb-closed") == Mode::Closed);
+    CHECK(allowed(breaker, "cb-closed"));
+}
+
+TEST_CASE("slow successes trip the slow-call rate", "[circuit_breaker]") {
+    CircuitBreaker breaker;
+    breaker.configure("cb-slow", smallWindow());
+
+    breaker.recordSuccess("cb-slow", closed, fast);
+    breaker.recordSuccess("cb-slow", closed, 250ms);
+    breaker.recordSuccess("cb-slow", closed, 250ms);
+    CHECK(breaker.mode("cb-slow") == Mode::Closed); // 3 < minimumCalls
+    breaker.recordSuccess("cb-slow", closed, 100ms); // 3/4 slow
+    CHECK(breaker.mode("cb-slow") == Mode::Open);
+}
+
+TEST_CASE("outcomes older than the window duration don't count", "[circuit_breaker]") {
+    CircuitBreaker breaker;
+    auto config = smallWindow();
+    config.windowDuration = 30ms;
+    breaker.configure("cb-aged", config);
+
+    for (int i = 0; i < 3; ++i) breaker.recordFailure("cb-aged", closed, fast);
+    std::this_thread::sleep_for(50ms);
+    breaker.recordFailure("cb-aged", closed, fast); // only 1 call still in the window
+    CHECK(breaker.mode("cb-aged") == Mode::Closed);
+}
+
+TEST_CASE("half-open admits one probe whose result decides", "[circuit_breaker]") {
+    CircuitBreaker breaker;
+    breaker.configure("cb-probe", smallWindow(20ms));
+    for (int i = 0; i < 4; ++i) breaker.recordFailure("cb-probe", closed, fast);
+    REQUIRE(breaker.mode("cb-probe") == Mode::Open);
+    std::this_thread::sleep_for(30ms);
+
+    CircuitBreaker::Ticket probe;
+    CHECK(allowed(breaker, "cb-probe", &probe));
+    CHECK(breaker.mode("cb-probe") == Mode::HalfOpen);
+    CHECK_FALSE(allowed(breaker, "cb-probe"));
+
+    SECTION("a failed probe re-opens for another cooldown") {
+        breaker.recordFailure("cb-probe", probe, fast);
+        CHECK(breaker.mode("cb-probe") == Mode::Open);
+        CHECK_FALSE(allowed(breaker, "cb-probe"));
+    }
+    SECTION("a slow probe re-opens too") {
+        breaker.recordSuccess("cb-probe", probe, 250ms);
+        CHECK(breaker.mode("cb-probe") == Mode::Open);
+    }
+    SECTION("a successful probe closes with a fresh window") {
+        breaker.recordSuccess("cb-probe", probe, fast);
+        CHECK(breaker.mode("cb-probe") == Mode::Closed);
+        CHECK(allowed(breaker, "cb-probe"));
+        for (int i = 0; i < 3; ++i) breaker.recordFailure("cb-probe", closed, fast);
+        CHECK(breaker.mode("cb-probe") == Mode::Closed);
+    }
+    SECTION("a late outcome from before the trip is not taken for the probe's") {
+        breaker.recordSuccess("cb-probe", closed, fast);
+        CHECK(breaker.mode("cb-probe") == Mode::HalfOpen);
+        breaker.recordFailure("cb-probe", closed, fast);
+        CHECK(breaker.mode("cb-probe") == Mode::HalfOpen);
+        breaker.recordSuccess("cb-probe", probe, fast);
+        CHECK(breaker.mode("cb-probe") == Mode::Closed);
+    }
+    SECTION("a probe that never reports is replaced after a cooldown") {
+        std::this_thread::sleep_for(30ms);
+        CircuitBreaker::Ticket replacement;
+        CHECK(allowed(breaker, "cb-probe", &replacement));
+        CHECK_FALSE(allowed(breaker, "cb-probe"));
+        // The first probe finally reports; only its replacement decides.
+        breaker.recordSuccess("cb-probe", probe, fast);
+        CHECK(breaker.mode("cb-probe") == Mode::HalfOpen);
+        breaker.recordSuccess("cb-probe", replacement, fast);
+        CHECK(breaker.mode("cb-probe") == Mode::Closed);
+    }
+}
+
+TEST_CASE("concurrent callers get exactly one probe token", "[circuit_breaker]") {
+    CircuitBreaker breaker;
+    auto config = smallWindow(10ms);
+    config.minimumCalls = 1;
+    breaker.configure("cb-race", config);
+
+    for (int round = 0; round < 20; ++round) {
+        breaker.recordFailure("cb-race", closed, fast);
+        REQUIRE(breaker.mode("cb-race") == Mode::Open);
+        std::this_thread::sleep_for(15ms);
+
+        std::atomic<bool> go{false};
+        std::atomic<int> admitted{0};
+        CircuitBreaker::Ticket probe;
+        std::vector<std::thread> callers;
+        for (int t = 0; t < 8; ++t) {
+            callers.emplace_back([&] {
+                while (!go.load()) std::this_thread::yield();
+                CircuitBreaker::Ticket ticket;
+                if (allowed(breaker, "cb-race", &ticket) && admitted++ == 0) probe = ticket;
+            });
+        }
+        go = true;
+        for (auto& t : callers) t.join();
+
+        CHECK(admitted == 1);
+        breaker.recordFailure("cb-race", probe, fast); // the probe fails; next round
+    }
+}
+
+TEST_CASE("the breaker stays consistent under concurrent use", "[circuit_breaker]") {
+    CircuitBreaker breaker;
+    auto config = smallWindow(1ms);
+    breaker.configure("cb-stress-0", config);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            for (int i = 0; i < 20000; ++i) {
+                // New services appear while others are in use.
+                std::string service = "cb-stress-" + std::to_string(rng() % 6);
+                CircuitBreaker::Ticket ticket;
+                if (allowed(breaker, service, &ticket)) {
+                    auto elapsed = rng() % 5 == 0 ? 200ms : fast;
+                    if (rng() % 3 == 0) breaker.recordFailure(service, ticket, elapsed);
+                    else breaker.recordSuccess(service, ticket, elapsed);
+                }
+                if (i % 1000 == 0) breaker.configure(service, config);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    for (int s = 0; s < 6; ++s) {
+        std::string service = "cb-stress-" + std::to_string(s);
+        Mode mode = breaker.mode(service);
+        CHECK((mode == Mode::Closed || mode == Mode::Open || mode == Mode::HalfOpen));
+    }
+}
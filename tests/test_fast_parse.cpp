@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+#include "fast_parse.hpp"
+#include <clocale>
+#include <ctime>
+
+TEST_CASE("integers must fill the whole input", "[fast_parse]") {
+    int value = 7;
+    CHECK(FastParse::parseInt("42", value));
+    CHECK(value == 42);
+    CHECK(FastParse::parseInt("-3", value));
+    CHECK(value == -3);
+    value = 7;
+    CHECK_FALSE(FastParse::parseInt("", value));
+    CHECK_FALSE(FastParse::parseInt("12a", value));
+    CHECK_FALSE(FastParse::parseInt(" 12", value));
+    CHECK_FALSE(FastParse::parseInt("99999999999", value));
+    CHECK(value == 7);
+}
+
+TEST_CASE("doubles ignore the global locale", "[fast_parse]") {
+    double value = 0;
+    CHECK(FastParse::parseDouble("3085.50", value));
+    CHECK(value == 3085.50);
+    // A comma-decimal locale changes strtod/stod, not from_chars.
+    if (std::setlocale(LC_NUMERIC, "de_DE.UTF-8")) {
+        CHECK(FastParse::parseDouble("4200.25", value));
+        CHECK(value == 4200.25);
+        std::setlocale(LC_NUMERIC, "C");
+    }
+    CHECK_FALSE(FastParse::parseDouble("12.5 INR", value));
+    CHECK_FALSE(FastParse::parseDouble("", value));
+}
+
+TEST_CASE("dates are scanned into a tm", "[fast_parse]") {
+    std::tm t = {};
+    REQUIRE(FastParse::parseDate("2026-09-10", t));
+    CHECK(t.tm_year == 126);
+    CHECK(t.tm_mon == 8);
+    CHECK(t.tm_mday == 10);
+    CHECK(t.tm_hour == 0);
+
+    CHECK_FALSE(FastParse::parseDate("2026-9-10", t));
+    CHECK_FALSE(FastParse::parseDate("2026-13-01", t));
+    CHECK_FALSE(FastParse::parseDate("2026-09-10T06:00", t));
+    CHECK_FALSE(FastParse::parseDate("2026/09/10", t));
+}
+
+TEST_CASE("date-times accept Amadeus and HH:MM forms", "[fast_parse]") {
+    std::tm t = {};
+    REQUIRE(FastParse::parseDateTime("2026-09-10T06:25:30", t));
+    CHECK(t.tm_mday == 10);
+    CHECK(t.tm_hour == 6);
+    CHECK(t.tm_min == 25);
+    CHECK(t.tm_sec == 30);
+
+    REQUIRE(FastParse::parseDateTime("2026-09-10T23:59", t));
+    CHECK(t.tm_hour == 23);
+    CHECK(t.tm_sec == 0);
+
+    CHECK_FALSE(FastParse::parseDateTime("2026-09-10 06:25:30", t));
+    CHECK_FALSE(FastParse::parseDateTime("2026-09-10T24:00", t));
+    CHECK_FALSE(FastParse::parseDateTime("2026-09-10T06:25:3", t));
+    CHECK(t.tm_hour == 23); // untouched on failure
+
+    int hour = -1, minute = -1;
+    CHECK(FastParse::parseTime("07:05", hour, minute));
+    CHECK(hour == 7);
+    CHECK(minute == 5);
+    CHECK_FALSE(FastParse::parseTime("7:05", hour, minute));
+}
+
+TEST_CASE("day numbers count across months, leap days and DST changes", "[fast_parse]") {
+    CHECK(FastParse::daysFromCivil(1970, 1, 1) == 0);
+    CHECK(FastParse::daysFromCivil(2000, 3, 1) - FastParse::daysFromCivil(2000, 2, 28) == 2);
+    CHECK(FastParse::daysFromCivil(2026, 11, 2) - FastParse::daysFromCivil(2026, 10, 25) == 8);
+    CHECK(FastParse::daysFromCivil(2027, 1, 1) - FastParse::daysFromCivil(2026, 1, 1) == 365);
+}
@@ -1,5 +1,6 @@
 #include <catch2/catch_test_macros.hpp>
 #include <stdexcept>
+#include <string>
 #include "flight_parser.hpp"
 
 TEST_CASE("parses a well-formed Amadeus flight-offers response", "[flight_parsing]") {
@@ -90,3 +91,108 @@ TEST_CASE("skips a malformed offer without failing the whole batch", "[flight_pa
     REQUIRE(flights.size() == 1);
     CHECK(flights[0].getFlightNumber() == "300");
 }
+
+TEST_CASE("ignores dictionaries, pricing details and return itineraries", "[flight_parsing]") {
+    std::string response = R"({
+        "meta": {"count": 1, "links": {"self": "https://example.test"}},
+        "data": [
+            {
+                "type": "flight-offer",
+                "price": {"currency": "INR", "total": "4200.50", "fees": [{"amount": "0.00", "type": "SUPPLIER"}]},
+                "numberOfBookableSeats": 4,
+                "itineraries": [
+                    {"duration": "PT5H", "segments": [
+                        {"carrierCode": "UK", "number": "811", "aircraft": {"code": "320"},
+                         "departure": {"iataCode": "DEL", "terminal": "3", "at": "2026-09-10T06:00:00"},
+                         "arrival": {"iataCode": "BOM", "at": "2026-09-10T08:10:00"}},
+                        {"carrierCode": "UK", "number": "857",
+                         "departure": {"iataCode": "BOM", "at": "2026-09-10T09:30:00"},
+                         "arrival": {"iataCode": "GOI", "at": "2026-09-10T10:45:00"}}
+                    ]},
+                    {"segments": [
+                        {"carrierCode": "UK", "number": "999",
+                         "departure": {"iataCode": "GOI", "at": "2026-09-15T06:00:00"},
+                         "arrival": {"iataCode": "DEL", "at": "2026-09-15T08:30:00"}}
+                    ]}
+                ],
+                "travelerPricings": [{"travelerId": "1", "fareDetailsBySegment": [{"segmentId": "1", "cabin": "ECONOMY"}]}]
+            }
+        ],
+        "dictionaries": {"locations": {"DEL": {"cityCode": "DEL", "countryCode": "IN"}}, "carriers": {"UK": "VISTARA"}}
+    })";
+
+    auto flights = FlightParser::parseAmadeusFlightOffers(response);
+
+    REQUIRE(flights.size() == 2);
+    CHECK(flights[0].getFlightNumber() == "811");
+    CHECK(flights[1].getFlightNumber() == "857");
+    CHECK(flights[1].getArrivalAirport() == "GOI");
+    CHECK(flights[1].getPrice() == 4200.50);
+    CHECK(flights[1].getAvailableSeats() == 4);
+}
+
+TEST_CASE("skips offers whose fields have the wrong type", "[flight_parsing]") {
+    std::string response = R"({
+        "data": [
+            {
+                "price": {"total": 1000},
+                "itineraries": [{"segments": [{
+                    "carrierCode": "6E", "number": "100",
+                    "departure": {"iataCode": "DEL", "at": "2026-09-10T06:00:00"},
+                    "arrival": {"iataCode": "BLR", "at": "2026-09-10T09:00:00"}
+                }]}]
+            },
+            {
+                "price": {"total": "2000.00"},
+                "itineraries": [{"segments": [{
+                    "carrierCode": "AI", "number": 200,
+                    "departure": {"iataCode": "DEL", "at": "2026-09-10T07:00:00"},
+                    "arrival": {"iataCode": "BLR", "at": "2026-09-10T10:00:00"}
+                }]}]
+            },
+            {
+                "price": {"total": "3000.00"},
+                "itineraries": [{"segments": [{
+                    "carrierCode": "UK", "number": "300",
+                    "departure": {"iataCode": "DEL", "at": "2026-09-10T08:00:00"},
+                    "arrival": {"iataCode": "BLR", "at": "2026-09-10T11:00:00"}
+                }]}]
+            }
+        ]
+    })";
+
+    auto flights = FlightParser::parseAmadeusFlightOffers(response);
+    REQUIRE(flights.size() == 1);
+    CHECK(flights[0].getFlightNumber() == "300");
+}
+
+TEST_CASE("rejects a truncated payload", "[flight_parsing]") {
+    REQUIRE_THROWS_AS(FlightParser::parseAmadeusFlightOffers(R"({"data": [{"price": {"total": "1)"),
+                      std::runtime_error);
+}
+
+TEST_CASE("keeps only the cheapest maxOffers offers", "[flight_parsing]") {
+    std::string offers;
+    for (int price : {7000, 2000, 9000, 2000, 5000}) {
+        if (!offers.empty()) offers += ',';
+        offers += R"({"price": {"total": ")" + std::to_string(price) + R"(.00"},
+            "itineraries": [{"segments": [{
+                "carrierCode": "AI", "number": ")" + std::to_string(offers.size()) + R"(",
+                "departure": {"iataCode": "DEL", "at": "2026-09-10T06:00:00"},
+                "arrival": {"iataCode": "BLR", "at": "2026-09-10T09:00:00"}
+            }]}]})";
+    }
+    std::string response = R"({"data": [)" + offers + "]}";
+
+    auto cheapest = FlightParser::parseAmadeusFlightOffers(response, "INR", 3);
+    REQUIRE(cheapest.size() == 3);
+    CHECK(cheapest[0].getPrice() == 2000.00);
+    CHECK(cheapest[1].getPrice() == 2000.00);
+    CHECK(cheapest[2].getPrice() == 5000.00);
+    // Equal fares keep the order Amadeus returned them in.
+    CHECK(std::stoi(std::string(cheapest[0].getFlightNumber())) <
+          std::stoi(std::string(cheapest[1].getFlightNumber())));
+
+    CHECK(FlightParser::parseAmadeusFlightOffers(response, "INR", 50).size() == 5);
+    CHECK(FlightParser::parseAmadeusFlightOffers(response, "INR", 0).empty());
+}
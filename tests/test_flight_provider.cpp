@@ -1,7 +1,15 @@
 #include <catch2/catch_test_macros.hpp>
 #include "flight_provider.hpp"
 #include "flight_parser.hpp"
+#include "upstream_error.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 namespace {
 
@@ -127,3 +135,296 @@ TEST_CASE("estimated flight parsing rejects non-array payloads", "[flight_provid
     CHECK_THROWS_AS(FlightParser::parseEstimatedFlights("{}", "2026-09-10"), std::runtime_error);
     CHECK_THROWS_AS(FlightParser::parseEstimatedFlights("not json", "2026-09-10"), std::runtime_error);
 }
+
+namespace {
+
+const char* kOneOffer = R"({"data": [{
+    "price": {"total": "3085.00"},
+    "itineraries": [{"segments": [{
+        "carrierCode": "AI", "number": "2803",
+        "departure": {"iataCode": "DEL", "at": "2026-09-10T06:25:00"},
+        "arrival": {"iataCode": "BLR", "at": "2026-09-10T09:25:00"}
+    }]}]
+}]})";
+
+// Amadeus config whose fake network answers the token endpoint and the
+// flight-offers endpoint separately, counting token round-trips.
+FlightProviderConfig amadeusConfig(std::atomic<int>& tokenCalls,
+                                   std::chrono::milliseconds tokenDelay = std::chrono::milliseconds(0)) {
+    FlightProviderConfig config = configWith("", "amadeus-id");
+    config.amadeusTokenUrl = "https://example.invalid/oauth2/token";
+    config.amadeusFlightUrl = "https://example.invalid/flight-offers";
+    config.httpRequest = [&tokenCalls, tokenDelay](const std::string& url, const std::string&,
+                                                   const std::string&, const std::string&) -> std::string {
+        if (url.find("oauth2/token") != std::string::npos) {
+            std::this_thread::sleep_for(tokenDelay);
+            int n = ++tokenCalls;
+            return R"({"access_token": "token-)" + std::to_string(n) + R"(", "expires_in": 1799})";
+        }
+        return kOneOffer;
+    };
+    return config;
+}
+
+// Observes overlap directly instead of timing it: each party arrives and
+// waits (bounded) for the others, so calls made one after another never
+// all meet.
+class Rendezvous {
+public:
+    explicit Rendezvous(int parties) : parties_(parties) {}
+
+    bool arriveAndWait(std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++arrived_;
+        changed_.notify_all();
+        return changed_.wait_for(lock, timeout, [&] { return arrived_ >= parties_; });
+    }
+
+private:
+    const int parties_;
+    int arrived_ = 0;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+};
+
+bool waitFor(const std::function<bool()>& condition) {
+    for (int i = 0; i < 200 && !condition(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return condition();
+}
+
+} // namespace
+
+TEST_CASE("amadeus reuses its OAuth token across searches", "[flight_provider]") {
+    std::atomic<int> tokenCalls{0};
+    auto provider = makeFlightProvider("amadeus", amadeusConfig(tokenCalls));
+
+    REQUIRE(provider->search("Delhi", "Bangalore", "2026-09-10", 1).size() == 1);
+    REQUIRE(provider->search("Delhi", "Bangalore", "2026-09-11", 1).size() == 1);
+    REQUIRE(provider->search("Mumbai", "Goa", "2026-09-10", 2).size() == 1);
+    CHECK(tokenCalls == 1);
+}
+
+TEST_CASE("concurrent cold searches share one token fetch", "[flight_provider]") {
+    std::atomic<int> tokenCalls{0};
+    auto provider = makeFlightProvider("amadeus",
+                                       amadeusConfig(tokenCalls, std::chrono::milliseconds(100)));
+
+    std::vector<std::thread> searches;
+    std::atomic<int> succeeded{0};
+    for (int i = 0; i < 6; ++i) {
+        searches.emplace_back([&] {
+            if (!provider->search("Delhi", "Bangalore", "2026-09-10", 1).empty()) succeeded++;
+        });
+    }
+    for (auto& t : searches) t.join();
+    CHECK(succeeded == 6);
+    CHECK(tokenCalls == 1);
+}
+
+TEST_CASE("a token near expiry is refreshed in the background", "[flight_provider]") {
+    std::atomic<int> tokenCalls{0};
+    std::atomic<bool> refreshed{false};
+    Rendezvous refreshGate(2); // the refresh can't finish until the test lets it
+    FlightProviderConfig config = amadeusConfig(tokenCalls);
+    config.httpRequest = [&](const std::string& url, const std::string&, const std::string&,
+                             const std::string&) -> std::string {
+        if (url.find("oauth2/token") == std::string::npos) return kOneOffer;
+        int n = ++tokenCalls;
+        if (n > 1) {
+            refreshGate.arriveAndWait();
+            refreshed = true;
+        }
+        return R"({"access_token": "token-)" + std::to_string(n) + R"(", "expires_in": 1799})";
+    };
+    // Refresh window covers the whole lifetime: every search after the
+    // first should kick off a refresh but keep using the cached token.
+    config.amadeusTokenRefreshAhead = std::chrono::hours(1);
+    auto provider = makeFlightProvider("amadeus", config);
+
+    provider->search("Delhi", "Bangalore", "2026-09-10", 1);
+    REQUIRE(tokenCalls == 1);
+
+    // Returns while the refresh it started is still parked at the gate.
+    CHECK(provider->search("Delhi", "Bangalore", "2026-09-10", 1).size() == 1);
+    CHECK_FALSE(refreshed);
+
+    refreshGate.arriveAndWait();
+    CHECK(waitFor([&] { return tokenCalls == 2 && refreshed; }));
+}
+
+TEST_CASE("amadeus resolves token and airports concurrently", "[flight_provider]") {
+    // The token fetch and both airport lookups only all meet if they overlap.
+    Rendezvous meet(3);
+    std::atomic<int> met{0};
+    std::atomic<int> tokenCalls{0};
+    FlightProviderConfig config = amadeusConfig(tokenCalls);
+    config.resolveIATA = [&](const std::string& city) -> std::string {
+        if (meet.arriveAndWait()) met++;
+        return city == "Delhi" ? "DEL" : "BLR";
+    };
+    std::string sentBody;
+    auto baseRequest = config.httpRequest;
+    config.httpRequest = [&, baseRequest](const std::string& url, const std::string& method,
+                                          const std::string& data, const std::string& token) {
+        if (url.find("oauth2/token") != std::string::npos && meet.arriveAndWait()) met++;
+        if (url.find("flight-offers") != std::string::npos) sentBody = data;
+        return baseRequest(url, method, data, token);
+    };
+    auto provider = makeFlightProvider("amadeus", config);
+
+    auto flights = provider->search("Delhi", "Bangalore", "2026-09-10", 1);
+
+    REQUIRE(flights.size() == 1);
+    CHECK(met == 3);
+    CHECK(sentBody.find(R"("originLocationCode":"DEL")") != std::string::npos);
+    CHECK(sentBody.find(R"("destinationLocationCode":"BLR")") != std::string::npos);
+}
+
+namespace {
+
+// An async HTTP hook that parks every request until the test answers it,
+// so a test can see exactly what is in flight and when.
+class ParkedRequests {
+public:
+    struct Request {
+        std::string url;
+        std::string data;
+        std::string token;
+        FlightProviderConfig::Callback done;
+    };
+
+    void install(FlightProviderConfig& config) {
+        config.httpRequestAsync = [this](const std::string& url, const std::string&, const std::string& data,
+                                         const std::string& token, FlightProviderConfig::Callback done) {
+            requests_.push_back({url, data, token, std::move(done)});
+        };
+        config.httpRequest = [](const std::string&, const std::string&, const std::string&,
+                                const std::string&) -> std::string {
+            throw std::logic_error("blocking client used");
+        };
+    }
+
+    size_t size() const { return requests_.size(); }
+    const Request& front() const { return requests_.front(); }
+
+    void answer(const std::string& body) { take().done(nullptr, body); }
+    void fail(std::exception_ptr error) { take().done(error, ""); }
+
+private:
+    Request take() {
+        Request request = std::move(requests_.front());
+        requests_.erase(requests_.begin());
+        return request;
+    }
+
+    std::vector<Request> requests_;
+};
+
+std::string tokenResponse(const std::string& token) {
+    return R"({"access_token": ")" + token + R"(", "expires_in": 1799})";
+}
+
+} // namespace
+
+TEST_CASE("amadeus searchAsync waits on the async hook, not a thread", "[flight_provider]") {
+    std::atomic<int> tokenCalls{0};
+    FlightProviderConfig config = amadeusConfig(tokenCalls);
+    ParkedRequests network;
+    network.install(config);
+    auto provider = makeFlightProvider("amadeus", config);
+
+    bool called = false;
+    FlightTable result;
+    provider->searchAsync("Delhi", "Bangalore", "2026-09-10", 1, [&](std::exception_ptr error, FlightTable flights) {
+        called = true;
+        CHECK_FALSE(error);
+        result = std::move(flights);
+    });
+
+    // Airports resolved inline; only the token request is out.
+    REQUIRE(network.size() == 1);
+    CHECK(network.front().url.find("oauth2/token") != std::string::npos);
+    network.answer(tokenResponse("token-1"));
+
+    REQUIRE(network.size() == 1);
+    CHECK(network.front().url.find("flight-offers") != std::string::npos);
+    CHECK(network.front().token == "token-1");
+    CHECK_FALSE(called);
+    network.answer(kOneOffer);
+
+    CHECK(called);
+    CHECK(result.size() == 1);
+}
+
+TEST_CASE("amadeus searchAsync re-authenticates once on a 401", "[flight_provider]") {
+    std::atomic<int> tokenCalls{0};
+    FlightProviderConfig config = amadeusConfig(tokenCalls);
+    ParkedRequests network;
+    network.install(config);
+    auto provider = makeFlightProvider("amadeus", config);
+
+    std::exception_ptr failure;
+    size_t found = 0;
+    auto search = [&] {
+        provider->searchAsync("Delhi", "Bangalore", "2026-09-10", 1, [&](std::exception_ptr error, FlightTable flights) {
+            failure = error;
+            found = flights.size();
+        });
+    };
+
+    SECTION("a fresh token rescues the search") {
+        search();
+        network.answer(tokenResponse("token-1"));
+        network.fail(std::make_exception_ptr(HttpError(401, "")));
+        REQUIRE(network.size() == 1);
+        CHECK(network.front().url.find("oauth2/token") != std::string::npos);
+        network.answer(tokenResponse("token-2"));
+        REQUIRE(network.size() == 1);
+        CHECK(network.front().token == "token-2");
+        network.answer(kOneOffer);
+        CHECK_FALSE(failure);
+        CHECK(found == 1);
+    }
+
+    SECTION("a second 401 fails the search") {
+        search();
+        network.answer(tokenResponse("token-1"));
+        network.fail(std::make_exception_ptr(HttpError(401, "")));
+        network.answer(tokenResponse("token-2"));
+        network.fail(std::make_exception_ptr(HttpError(401, "")));
+        CHECK(network.size() == 0);
+        CHECK_THROWS_AS(std::rethrow_exception(failure), HttpError);
+    }
+}
+
+TEST_CASE("gemini searchAsync parses the estimate from the async hook", "[flight_provider]") {
+    FlightProviderConfig config = configWith("gemini-key", "");
+    ParkedRequests network;
+    network.install(config);
+    auto provider = makeFlightProvider("gemini", config);
+
+    size_t found = 0;
+    provider->searchAsync("Delhi", "Bangalore", "2026-09-10", 1, [&](std::exception_ptr error, FlightTable flights) {
+        CHECK_FALSE(error);
+        found = flights.size();
+    });
+
+    REQUIRE(network.size() == 1);
+    CHECK(network.front().url.find("key=gemini-key") != std::string::npos);
+    network.answer(R"({"candidates": [{"content": {"parts": [{"text":
+        "[{\"airline\":\"6E\",\"flight_number\":\"6E-2011\",\"departure_airport\":\"DEL\",\"arrival_airport\":\"BLR\",\"departure_time\":\"06:30\",\"arrival_time\":\"09:15\",\"price\":7400.0}]"
+    }]}}]})");
+    CHECK(found == 1);
+}
+
+TEST_CASE("searchAsync falls back to search without an async hook", "[flight_provider]") {
+    auto provider = makeFlightProvider("mock", configWith("", ""));
+    size_t found = 0;
+    provider->searchAsync("Delhi", "Bangalore", "2026-09-10", 1, [&](std::exception_ptr error, FlightTable flights) {
+        CHECK_FALSE(error);
+        found = flights.size();
+    });
+    CHECK(found == provider->search("Delhi", "Bangalore", "2026-09-10", 1).size());
+}
@@ -0,0 +1,110 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flight_table.hpp"
+#include <ctime>
+#include <string>
+
+namespace {
+
+std::tm at(int year, int month, int day, int hour, int minute) {
+    std::tm t = {};
+    t.tm_year = year - 1900;
+    t.tm_mon = month - 1;
+    t.tm_mday = day;
+    t.tm_hour = hour;
+    t.tm_min = minute;
+    return t;
+}
+
+void addLeg(FlightTable& table, const char* airline, const char* number, const char* from,
+            const char* to, double price, int seats = 4) {
+    table.add(airline, number, from, to, FlightTable::toEpoch(at(2026, 9, 10, 6, 25)),
+              FlightTable::toEpoch(at(2026, 9, 10, 9, 5)), FlightTable::toMinorUnits(price), seats);
+}
+
+} // namespace
+
+TEST_CASE("rows read back what was added", "[flight_table]") {
+    FlightTable table("INR", "amadeus");
+    addLeg(table, "AI", "2803", "DEL", "BLR", 3085.50, 9);
+    addLeg(table, "6E", "512", "BLR", "GOI", 1999.99);
+
+    REQUIRE(table.size() == 2);
+    FlightTable::Row first = table[0];
+    CHECK(first.getAirline() == "AI");
+    CHECK(first.getFlightNumber() == "2803");
+    CHECK(first.getDepartureAirport() == "DEL");
+    CHECK(first.getArrivalAirport() == "BLR");
+    CHECK(first.priceMinor() == 308550);
+    CHECK(first.getPrice() == 3085.50);
+    CHECK(first.getAvailableSeats() == 9);
+    CHECK(first.getCurrency() == "INR");
+    CHECK(first.isBookable());
+    CHECK(table[1].getFlightNumber() == "512");
+    CHECK(table[1].getDepartureAirport() == "BLR");
+
+    std::tm departure = first.getDepartureTime();
+    CHECK(departure.tm_year == 126);
+    CHECK(departure.tm_mon == 8);
+    CHECK(departure.tm_mday == 10);
+    CHECK(departure.tm_hour == 6);
+    CHECK(departure.tm_min == 25);
+    CHECK(departure.tm_wday == 4); // a Thursday
+}
+
+TEST_CASE("epoch conversion round-trips across years and leap days", "[flight_table]") {
+    for (std::tm t : {at(1970, 1, 1, 0, 0), at(2028, 2, 29, 23, 59), at(2026, 12, 31, 12, 30), at(1969, 12, 31, 18, 0)}) {
+        std::tm back = FlightTable::toTm(FlightTable::toEpoch(t));
+        CHECK(back.tm_year == t.tm_year);
+        CHECK(back.tm_mon == t.tm_mon);
+        CHECK(back.tm_mday == t.tm_mday);
+        CHECK(back.tm_hour == t.tm_hour);
+        CHECK(back.tm_min == t.tm_min);
+    }
+}
+
+TEST_CASE("sorting by price is stable and keeps flight numbers with their rows", "[flight_table]") {
+    FlightTable table;
+    addLeg(table, "UK", "811", "DEL", "BOM", 4200);
+    addLeg(table, "AI", "2803", "DEL", "BLR", 3000);
+    addLeg(table, "UK", "857", "BOM", "GOI", 4200);
+    addLeg(table, "6E", "1", "DEL", "GOI", 9000);
+    table.sortByPrice();
+
+    REQUIRE(table.size() == 4);
+    CHECK(table[0].getFlightNumber() == "2803");
+    CHECK(table[1].getFlightNumber() == "811");
+    CHECK(table[2].getFlightNumber() == "857");
+    CHECK(table[3].getFlightNumber() == "1");
+    CHECK(table[2].getArrivalAirport() == "GOI");
+}
+
+TEST_CASE("filtering and truncation drop whole rows", "[flight_table]") {
+    FlightTable table("USD", "mock");
+    addLeg(table, "AI", "100", "DEL", "BLR", 100, 1);
+    addLeg(table, "AI", "200", "DEL", "BLR", 200, 5);
+    addLeg(table, "6E", "300", "DEL", "BLR", 300, 6);
+    table.retainIf([](FlightTable::Row row) { return row.getAvailableSeats() >= 2; });
+
+    REQUIRE(table.size() == 2);
+    CHECK(table[0].getFlightNumber() == "200");
+    CHECK(table[1].getAirline() == "6E");
+    CHECK_FALSE(table.isBookable());
+
+    table.truncate(1);
+    REQUIRE(table.size() == 1);
+    addLeg(table, "UK", "400", "DEL", "BLR", 400);
+    CHECK(table[1].getFlightNumber() == "400");
+}
+
+TEST_CASE("materialized Flights match their rows", "[flight_table]") {
+    FlightTable table("INR", "estimate");
+    addLeg(table, "AI", "2803", "DEL", "BLR", 3085);
+    std::vector<Flight> flights = table.toFlights();
+
+    REQUIRE(flights.size() == 1);
+    CHECK(flights[0].getFlightNumber() == "2803");
+    CHECK(flights[0].getArrivalAirport() == "BLR");
+    CHECK(flights[0].getPrice() == 3085.0);
+    CHECK(flights[0].getSource() == "estimate");
+    CHECK(flights[0].getArrivalTime().tm_hour == 9);
+}
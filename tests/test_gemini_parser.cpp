@@ -0,0 +1,115 @@
+#include <catch2/catch_test_macros.hpp>
+#include "gemini_parser.hpp"
+#include "json.hpp"
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A generateContent reply wrapping `text` the way Gemini does.
+std::string envelope(const std::string& text) {
+    return nlohmann::json{
+        {"candidates", {{
+            {"content", {{"parts", {{{"text", text}}}}, {"role", "model"}}},
+            {"finishReason", "STOP"},
+            {"safetyRatings", {{{"category", "HARM_CATEGORY_HARASSMENT"}, {"probability", "NEGLIGIBLE"}}}}
+        }}},
+        {"usageMetadata", {{"promptTokenCount", 42}, {"totalTokenCount", 420}}},
+        {"modelVersion", "gemini-test"}
+    }.dump();
+}
+
+// Counts what reaches the heap behind an arena.
+struct CountingResource : std::pmr::memory_resource {
+    size_t allocations = 0;
+
+    void* do_allocate(size_t bytes, size_t align) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+const char* kItinerary = R"({"itinerary": [
+    {"date": "2026-09-10", "place": "Baga Beach", "famous_for": "Nightlife and water sports along the shore.",
+     "how_to_go": "Taxi from Panaji, about 30 minutes"},
+    {"date": "2026-09-11", "place": "Old Goa", "famous_for": "Baroque churches, a UNESCO World Heritage Site.",
+     "how_to_go": ""}
+]})";
+
+} // namespace
+
+TEST_CASE("the candidate text is taken from the first part", "[gemini_parser]") {
+    CHECK(GeminiParser::candidateText(envelope("[1, 2]")) == "[1, 2]");
+
+    // Only candidates[0].content.parts[0].text counts.
+    std::string decoys = R"({"text": "no", "candidates": [
+        {"text": "no", "content": {"role": "model", "parts": [{"inlineData": {"text": "no"}, "text": "yes"}, {"text": "no"}]}},
+        {"content": {"parts": [{"text": "no"}]}}
+    ]})";
+    CHECK(GeminiParser::candidateText(decoys) == "yes");
+}
+
+TEST_CASE("a reply without candidate text is rejected", "[gemini_parser]") {
+    CHECK_THROWS_AS(GeminiParser::candidateText(R"({"candidates": []})"), std::runtime_error);
+    CHECK_THROWS_AS(GeminiParser::candidateText(R"({"promptFeedback": {"blockReason": "SAFETY"}})"),
+                    std::runtime_error);
+    CHECK_THROWS_AS(GeminiParser::candidateText(R"({"candidates": [{"content": {"parts": [{"text": 7}]}}]})"),
+                    std::runtime_error);
+    CHECK_THROWS_AS(GeminiParser::candidateText(R"({"candidates": [{"content": )"), std::runtime_error);
+}
+
+TEST_CASE("hotels carry the query's city, dates and currency", "[gemini_parser]") {
+    std::string text = R"([
+        {"hotel_name": "Taj Exotica", "star_rating": 5, "total_stay_cost": 42000.5, "address": "Benaulim"},
+        {"hotel_name": "Zostel", "star_rating": 3.5, "total_stay_cost": 3000, "address": "Anjuna"}
+    ])";
+    auto hotels = GeminiParser::parseHotels(GeminiParser::candidateText(envelope(text)), "Goa", "2026-09-10",
+                                            "2026-09-12", "INR");
+
+    REQUIRE(hotels.size() == 2);
+    CHECK(hotels[0].getName() == "Taj Exotica");
+    CHECK(hotels[0].getLocation() == "Goa");
+    CHECK(hotels[0].getPricePerNight() == 42000.5);
+    CHECK(hotels[1].getRating() == 3.5);
+    CHECK(hotels[1].getAddress() == "Anjuna");
+    CHECK(hotels[1].getCheckOutDate() == "2026-09-12");
+
+    CHECK_THROWS(GeminiParser::parseHotels(R"([{"hotel_name": "No price"}])", "Goa", "", "", "INR"));
+}
+
+TEST_CASE("itinerary days expand into items between check-in and check-out", "[gemini_parser]") {
+    auto items = GeminiParser::parseItinerary(kItinerary, "Taj Exotica", "2026-09-10", "2026-09-12");
+
+    REQUIRE(items.size() == 7);
+    CHECK(items[0].getActivity() == "Check-in at Taj Exotica");
+    CHECK(items[0].getDate() == "2026-09-10");
+    CHECK(items[1].getActivity() == "Visit Baga Beach");
+    CHECK(items[2].getCategory() == "Information");
+    CHECK(items[3].getActivity() == "Transportation: Taxi from Panaji, about 30 minutes");
+    CHECK(items[4].getActivity() == "Visit Old Goa"); // empty how_to_go is skipped
+    CHECK(items[5].getCategory() == "Information");
+    CHECK(items[6].getActivity() == "Check-out from Taj Exotica");
+    CHECK(items[6].getTime() == "11:00");
+}
+
+TEST_CASE("results are built in the caller's arena", "[gemini_parser]") {
+    CountingResource upstream;
+    std::pmr::monotonic_buffer_resource arena(16 << 10, &upstream);
+
+    auto items = GeminiParser::parseItinerary(kItinerary, "Taj Exotica", "2026-09-10", "2026-09-12", &arena);
+    REQUIRE(items.size() == 7);
+    CHECK(items.get_allocator().resource() == &arena);
+    CHECK(items[3].get_allocator().resource() == &arena);
+    CHECK(upstream.allocations == 1); // the arena's one initial block
+
+    // Copies that must outlive the request leave the arena.
+    std::vector<ItineraryItem> kept(items.begin(), items.end());
+    CHECK(kept[3].get_allocator().resource() == std::pmr::get_default_resource());
+    CHECK(kept[3].getActivity() == items[3].getActivity());
+}
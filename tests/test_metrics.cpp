@@ -0,0 +1,73 @@
+#include <catch2/catch_test_macros.hpp>
+#include "metrics.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("series are registered once per name and label set", "[metrics]") {
+    MetricsRegistry registry;
+    Counter& a = registry.counter("calls_total", "Calls", {{"upstream", "gemini"}});
+    Counter& b = registry.counter("calls_total", "Calls", {{"upstream", "gemini"}});
+    Counter& c = registry.counter("calls_total", "Calls", {{"upstream", "amadeus"}});
+    CHECK(&a == &b);
+    CHECK(&a != &c);
+    CHECK_THROWS(registry.gauge("calls_total", "Calls"));
+}
+
+TEST_CASE("concurrent increments are not lost", "[metrics]") {
+    MetricsRegistry registry;
+    Counter& counter = registry.counter("hits_total", "Hits");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) counter.inc();
+        });
+    }
+    for (auto& t : threads) t.join();
+    CHECK(counter.value() == 80000);
+}
+
+TEST_CASE("histograms bucket observations by upper bound", "[metrics]") {
+    Histogram h({0.1, 1.0});
+    h.observe(0.05);
+    h.observe(0.1);
+    h.observe(0.5);
+    h.observe(5.0);
+
+    auto counts = h.bucketCounts();
+    REQUIRE(counts.size() == 3);
+    CHECK(counts[0] == 2); // <= 0.1, inclusive like Prometheus `le`
+    CHECK(counts[1] == 1);
+    CHECK(counts[2] == 1); // +Inf
+    CHECK(h.count() == 4);
+    CHECK(h.sum() > 5.64);
+    CHECK(h.sum() < 5.66);
+}
+
+TEST_CASE("renders the Prometheus text format", "[metrics]") {
+    MetricsRegistry registry;
+    registry.counter("requests_total", "Requests", {{"upstream", "weather"}}).inc(3);
+    registry.gauge("breaker_open", "Open circuits").set(1);
+    registry.gaugeFn("cache_entries", "Entries", {{"cache", "iata"}}, [] { return 42.0; });
+    Histogram& latency = registry.histogram("latency_seconds", "Latency", {}, {0.1, 1.0});
+    latency.observe(0.05);
+    latency.observe(2.0);
+
+    std::string text = registry.renderPrometheus();
+    CHECK(text.find("# TYPE requests_total counter\n") != std::string::npos);
+    CHECK(text.find("requests_total{upstream=\"weather\"} 3\n") != std::string::npos);
+    CHECK(text.find("breaker_open 1\n") != std::string::npos);
+    CHECK(text.find("cache_entries{cache=\"iata\"} 42\n") != std::string::npos);
+    CHECK(text.find("# TYPE latency_seconds histogram\n") != std::string::npos);
+    CHECK(text.find("latency_seconds_bucket{le=\"0.1\"} 1\n") != std::string::npos);
+    CHECK(text.find("latency_seconds_bucket{le=\"1\"} 1\n") != std::string::npos);
+    CHECK(text.find("latency_seconds_bucket{le=\"+Inf\"} 2\n") != std::string::npos);
+    CHECK(text.find("latency_seconds_count 2\n") != std::string::npos);
+}
+
+TEST_CASE("label values are escaped", "[metrics]") {
+    MetricsRegistry registry;
+    registry.counter("retries_total", "Retries", {{"operation", "say \"hi\"\\n"}}).inc();
+    std::string text = registry.renderPrometheus();
+    CHECK(text.find("retries_total{operation=\"say \\\"hi\\\"\\\\n\"} 1\n") != std::string::npos);
+}
@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+#include "mpsc_ring.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("preserves FIFO order for a single producer", "[mpsc_ring]") {
+    MpscRing<std::string> ring(4);
+    for (std::string s : {"a", "b", "c"}) REQUIRE(ring.tryPush(s));
+
+    std::string out;
+    REQUIRE(ring.tryPop(out));
+    CHECK(out == "a");
+    REQUIRE(ring.tryPop(out));
+    CHECK(out == "b");
+    REQUIRE(ring.tryPop(out));
+    CHECK(out == "c");
+    CHECK_FALSE(ring.tryPop(out));
+}
+
+TEST_CASE("rejects pushes when full and leaves the value intact", "[mpsc_ring]") {
+    MpscRing<std::string> ring(2);
+    std::string a = "a", b = "b", c = "overflow";
+    REQUIRE(ring.tryPush(a));
+    REQUIRE(ring.tryPush(b));
+    CHECK_FALSE(ring.tryPush(c));
+    CHECK(c == "overflow");
+
+    std::string out;
+    REQUIRE(ring.tryPop(out));
+    CHECK(ring.tryPush(c));
+}
+
+TEST_CASE("capacity rounds up to a power of two", "[mpsc_ring]") {
+    CHECK(MpscRing<int>(1000).capacity() == 1024);
+    CHECK(MpscRing<int>(8).capacity() == 8);
+}
+
+TEST_CASE("delivers every item exactly once from many producers", "[mpsc_ring]") {
+    constexpr int producers = 4;
+    constexpr int perProducer = 20000;
+    MpscRing<int> ring(256);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p] {
+            for (int i = 0; i < perProducer; ++i) {
+                int value = p * perProducer + i;
+                while (!ring.tryPush(value)) std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<int> seen(producers * perProducer, 0);
+    std::vector<int> lastPerProducer(producers, -1);
+    bool ordered = true;
+    int received = 0;
+    while (received < producers * perProducer) {
+        int value;
+        if (!ring.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        seen[value]++;
+        int producer = value / perProducer;
+        if (value <= lastPerProducer[producer]) ordered = false;
+        lastPerProducer[producer] = value;
+        ++received;
+    }
+    for (auto& t : threads) t.join();
+
+    CHECK(ordered);
+    bool exactlyOnce = true;
+    for (int count : seen) exactlyOnce = exactlyOnce && count == 1;
+    CHECK(exactlyOnce);
+}
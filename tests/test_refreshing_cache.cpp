@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+#include "refreshing_cache.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct FakeClock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<FakeClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() { return time_point(duration(nowMs.load())); }
+    static void advance(duration d) { nowMs += d.count(); }
+
+    static inline std::atomic<rep> nowMs{0};
+};
+
+using Cache = RefreshingCache<std::string, std::string, std::hash<std::string>, FakeClock>;
+
+} // namespace
+
+TEST_CASE("fresh entries are served without a refresh", "[refreshing_cache]") {
+    Cache cache(1 << 20, std::chrono::minutes(5), std::chrono::minutes(30));
+    cache.put("delhi|goa", "flights-v1");
+
+    auto lookup = cache.get("delhi|goa");
+    REQUIRE(lookup.value.has_value());
+    CHECK(*lookup.value == "flights-v1");
+    CHECK_FALSE(lookup.stale);
+    CHECK_FALSE(lookup.shouldRefresh);
+}
+
+TEST_CASE("stale entries are served and exactly one caller refreshes", "[refreshing_cache]") {
+    Cache cache(1 << 20, std::chrono::minutes(5), std::chrono::minutes(30));
+    cache.put("delhi|goa", "flights-v1");
+    FakeClock::advance(std::chrono::minutes(6));
+
+    auto first = cache.get("delhi|goa");
+    auto second = cache.get("delhi|goa");
+    REQUIRE(first.value.has_value());
+    REQUIRE(second.value.has_value());
+    CHECK(first.stale);
+    CHECK(first.shouldRefresh);
+    CHECK(second.stale);
+    CHECK_FALSE(second.shouldRefresh);
+
+    cache.put("delhi|goa", "flights-v2");
+    auto refreshed = cache.get("delhi|goa");
+    CHECK(*refreshed.value == "flights-v2");
+    CHECK_FALSE(refreshed.stale);
+}
+
+TEST_CASE("a failed refresh lets the next caller try again", "[refreshing_cache]") {
+    Cache cache(1 << 20, std::chrono::minutes(5), std::chrono::minutes(30));
+    cache.put("delhi|goa", "flights-v1");
+    FakeClock::advance(std::chrono::minutes(6));
+
+    REQUIRE(cache.get("delhi|goa").shouldRefresh);
+    cache.refreshFailed("delhi|goa");
+    auto retry = cache.get("delhi|goa");
+    CHECK(retry.shouldRefresh);
+    CHECK(*retry.value == "flights-v1");
+}
+
+TEST_CASE("entries past the stale window are gone", "[refreshing_cache]") {
+    Cache cache(1 << 20, std::chrono::minutes(5), std::chrono::minutes(30));
+    cache.put("delhi|goa", "flights-v1");
+    FakeClock::advance(std::chrono::minutes(36));
+
+    auto lookup = cache.get("delhi|goa");
+    CHECK_FALSE(lookup.value.has_value());
+    CHECK_FALSE(lookup.shouldRefresh);
+}
+
+TEST_CASE("only one of many concurrent stale readers refreshes", "[refreshing_cache]") {
+    Cache cache(1 << 20, std::chrono::minutes(5), std::chrono::minutes(30));
+    cache.put("delhi|goa", "flights-v1");
+    FakeClock::advance(std::chrono::minutes(6));
+
+    std::atomic<int> refreshers{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < 100; ++j) {
+                if (cache.get("delhi|goa").shouldRefresh) refreshers++;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    CHECK(refreshers == 1);
+}
@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+#include "request_cost.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace std::chrono;
+
+TEST_CASE("phase timers charge the current request", "[request_cost]") {
+    auto cost = std::make_shared<RequestCost>();
+    {
+        RequestCostScope charge(cost);
+        PhaseTimer timer(RequestCost::Phase::Provider);
+        std::this_thread::sleep_for(milliseconds(20));
+    }
+    CHECK(cost->phaseTime(RequestCost::Phase::Provider) >= milliseconds(20));
+    CHECK(cost->phaseTime(RequestCost::Phase::Cache) == nanoseconds(0));
+    CHECK_FALSE(RequestCost::current());
+}
+
+TEST_CASE("phase timers outside a request are no-ops", "[request_cost]") {
+    PhaseTimer timer(RequestCost::Phase::Parse);
+    CHECK_FALSE(RequestCost::current());
+}
+
+TEST_CASE("work on other threads is charged once the context is adopted", "[request_cost]") {
+    auto cost = std::make_shared<RequestCost>();
+    RequestCostScope charge(cost);
+    std::shared_ptr<RequestCost> captured = RequestCost::current();
+    std::thread([captured] {
+        RequestCostScope adopt(captured);
+        PhaseTimer timer(RequestCost::Phase::Iata);
+        RequestCost::current()->addUpstreamCall(1200, milliseconds(5));
+    }).join();
+    std::thread([] { PhaseTimer timer(RequestCost::Phase::Iata); }).join();
+
+    CHECK(cost->phaseTime(RequestCost::Phase::Iata) > nanoseconds(0));
+    CHECK(cost->upstreamCalls() == 1);
+    CHECK(cost->upstreamBytes() == 1200);
+}
+
+TEST_CASE("Server-Timing lists only the phases that ran", "[request_cost]") {
+    RequestCost cost;
+    cost.add(RequestCost::Phase::Cache, microseconds(20));
+    cost.add(RequestCost::Phase::Serialize, microseconds(1500));
+    cost.addUpstreamCall(100, milliseconds(300));
+    cost.addUpstreamCall(23, milliseconds(200));
+
+    CHECK(cost.serverTimingHeader(milliseconds(600)) ==
+          "cache;dur=0.02, serialize;dur=1.50, upstream;dur=500.00;desc=\"calls=2 bytes=123\", total;dur=600.00");
+}
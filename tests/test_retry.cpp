@@ -1,6 +1,29 @@
 #include <catch2/catch_test_macros.hpp>
 #include "retry.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory_resource>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Same rules as the default policy, with millisecond waits.
+RetryPolicy quickPolicy(int maxRetries) {
+    RetryPolicy policy;
+    policy.maxRetries = maxRetries;
+    policy.baseDelay = 5ms;
+    policy.maxDelay = 50ms;
+    return policy;
+}
+
+} // namespace
 
 TEST_CASE("returns result immediately on success", "[retry]") {
     int calls = 0;
@@ -16,33 +39,282 @@ TEST_CASE("retries on HTTP 503 and eventually succeeds", "[retry]") {
     int calls = 0;
     int result = retryWithBackoff<int>("test", [&]() -> int {
         calls++;
-        if (calls < 3) throw std::runtime_error("HTTP error 503: overloaded");
+        if (calls < 3) throw HttpError(503, "overloaded");
         return 7;
-    }, /*maxRetries=*/3);
+    }, quickPolicy(3));
     CHECK(result == 7);
     CHECK(calls == 3);
 }
 
-TEST_CASE("does not retry non-503 errors", "[retry]") {
-    int calls = 0;
-    REQUIRE_THROWS_AS(
-        retryWithBackoff<int>("test", [&]() -> int {
+TEST_CASE("rate limits, gateway errors and dropped connections are retried", "[retry]") {
+    auto failsOnce = [](std::exception_ptr error) {
+        int calls = 0;
+        int result = retryWithBackoff<int>("test", [&]() -> int {
+            if (calls++ == 0) std::rethrow_exception(error);
+            return 1;
+        }, quickPolicy(2));
+        return result == 1 ? calls : -1;
+    };
+    CHECK(failsOnce(std::make_exception_ptr(HttpError(429, "slow down"))) == 2);
+    CHECK(failsOnce(std::make_exception_ptr(HttpError(502, "bad gateway"))) == 2);
+    CHECK(failsOnce(std::make_exception_ptr(HttpError(504, "gateway timeout"))) == 2);
+    CHECK(failsOnce(std::make_exception_ptr(
+        TransportError(TransportError::Kind::Timeout, "Timeout was reached"))) == 2);
+    CHECK(failsOnce(std::make_exception_ptr(
+        TransportError(TransportError::Kind::Connection, "Couldn't connect to server"))) == 2);
+}
+
+TEST_CASE("does not retry client errors or untyped failures", "[retry]") {
+    auto callsFor = [](std::exception_ptr error) {
+        int calls = 0;
+        CHECK_THROWS_AS(retryWithBackoff<int>("test", [&]() -> int {
             calls++;
-            throw std::runtime_error("HTTP error 400: bad request");
-        }),
-        std::runtime_error
-    );
+            std::rethrow_exception(error);
+        }, quickPolicy(3)), std::runtime_error);
+        return calls;
+    };
+    CHECK(callsFor(std::make_exception_ptr(HttpError(400, "bad request"))) == 1);
+    CHECK(callsFor(std::make_exception_ptr(HttpError(401, "unauthorized"))) == 1);
+    CHECK(callsFor(std::make_exception_ptr(
+        TransportError(TransportError::Kind::Other, "SSL peer certificate was not OK"))) == 1);
+    // Matching on text is gone: only the type says "retry".
+    CHECK(callsFor(std::make_exception_ptr(std::runtime_error("HTTP error 503: overloaded"))) == 1);
+}
+
+TEST_CASE("a call shed locally is not retried and stays a ServiceUnavailable", "[retry]") {
+    int calls = 0;
+    REQUIRE_THROWS_AS(retryWithBackoff<int>("test", [&]() -> int {
+        calls++;
+        throw ServiceUnavailable("Bulkhead full for gemini: 12 calls in flight");
+    }, quickPolicy(3)), ServiceUnavailable);
     CHECK(calls == 1);
 }
 
 TEST_CASE("gives up after maxRetries and throws", "[retry]") {
     int calls = 0;
-    REQUIRE_THROWS_AS(
+    REQUIRE_THROWS_WITH(
         retryWithBackoff<int>("test", [&]() -> int {
             calls++;
-            throw std::runtime_error("HTTP error 503: overloaded");
-        }, /*maxRetries=*/2),
-        std::runtime_error
+            throw HttpError(503, "overloaded");
+        }, quickPolicy(2)),
+        "test: HTTP error 503: overloaded"
     );
     CHECK(calls == 2);
 }
+
+TEST_CASE("backoff is exponential with full jitter", "[retry]") {
+    RetryPolicy policy;
+    policy.baseDelay = 100ms;
+    policy.maxDelay = 1000ms;
+    CHECK(retry_detail::backoffCeiling(policy, 0) == 100ms);
+    CHECK(retry_detail::backoffCeiling(policy, 1) == 200ms);
+    CHECK(retry_detail::backoffCeiling(policy, 3) == 800ms);
+    CHECK(retry_detail::backoffCeiling(policy, 4) == 1000ms);
+    CHECK(retry_detail::backoffCeiling(policy, 40) == 1000ms);
+
+    // Uniform over [0, ceiling]: always in range, and actually spread out.
+    std::chrono::milliseconds lowest = 1000ms, highest = 0ms;
+    for (int i = 0; i < 200; ++i) {
+        auto delay = retry_detail::backoff(policy, 2);
+        CHECK(delay >= 0ms);
+        CHECK(delay <= 400ms);
+        lowest = std::min(lowest, delay);
+        highest = std::max(highest, delay);
+    }
+    CHECK(lowest < 100ms);
+    CHECK(highest > 300ms);
+}
+
+TEST_CASE("Retry-After replaces the jittered wait", "[retry]") {
+    RetryPolicy policy = quickPolicy(2);
+    policy.baseDelay = 1ms;
+    policy.maxDelay = 200ms;
+
+    SECTION("a wait within maxDelay is honoured") {
+        int calls = 0;
+        auto started = std::chrono::steady_clock::now();
+        retryWithBackoff<int>("test", [&]() -> int {
+            if (calls++ == 0) throw HttpError(429, "slow down", 60ms);
+            return 1;
+        }, policy);
+        CHECK(calls == 2);
+        CHECK(std::chrono::steady_clock::now() - started >= 60ms);
+    }
+    SECTION("a longer one ends the retries") {
+        int calls = 0;
+        CHECK_THROWS_AS(retryWithBackoff<int>("test", [&]() -> int {
+            calls++;
+            throw HttpError(503, "down for maintenance", std::chrono::milliseconds(3600 * 1000));
+        }, policy), std::runtime_error);
+        CHECK(calls == 1);
+    }
+}
+
+TEST_CASE("retries and exhaustion are counted in the policy's metrics", "[retry]") {
+    RetryMetrics metrics("retry-metrics-test");
+    RetryPolicy policy = quickPolicy(3);
+    policy.metrics = &metrics;
+    uint64_t retries = metrics.retries.value();
+    uint64_t exhausted = metrics.exhausted.value();
+
+    CHECK_THROWS_AS(retryWithBackoff<int>("test", []() -> int { throw HttpError(503, "overloaded"); }, policy),
+                    std::runtime_error);
+    CHECK(metrics.retries.value() - retries == 2);
+    CHECK(metrics.exhausted.value() - exhausted == 1);
+}
+
+TEST_CASE("an exhausted retry budget stops retries", "[retry]") {
+    RetryBudget budget("retry-test", RetryBudget::Config{0.1, 2});
+    RetryPolicy policy = quickPolicy(3);
+    policy.budget = &budget;
+
+    int calls = 0;
+    auto alwaysOverloaded = [&]() -> int {
+        calls++;
+        throw HttpError(503, "overloaded");
+    };
+    CHECK_THROWS_AS(retryWithBackoff<int>("test", alwaysOverloaded, policy), std::runtime_error);
+    CHECK(calls == 3); // both retries paid for by the initial balance
+
+    calls = 0;
+    CHECK_THROWS_AS(retryWithBackoff<int>("test", alwaysOverloaded, policy), std::runtime_error);
+    CHECK(calls == 1); // only 0.1 of a token deposited since: no retry
+}
+
+namespace {
+
+// Blocks the test until retryAsync's completion has run.
+struct Outcome {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool finished = false;
+    std::exception_ptr error;
+    int value = 0;
+
+    AsyncCompletion<int> completion() {
+        return [this](std::exception_ptr e, int v) {
+            // Notify under the lock: the test may destroy us once it sees
+            // `finished`.
+            std::lock_guard<std::mutex> lock(mutex);
+            error = e;
+            value = v;
+            finished = true;
+            changed.notify_all();
+        };
+    }
+
+    bool wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, std::chrono::seconds(2), [&] { return finished; });
+    }
+};
+
+} // namespace
+
+TEST_CASE("retryAsync completes on the first success", "[retry]") {
+    TimerQueue timers;
+    Outcome outcome;
+    std::atomic<int> calls{0};
+    retryAsync<int>("test", [&](AsyncCompletion<int> done) {
+        calls++;
+        done(nullptr, 42);
+    }, outcome.completion(), quickPolicy(3), timers);
+
+    REQUIRE(outcome.wait());
+    CHECK_FALSE(outcome.error);
+    CHECK(outcome.value == 42);
+    CHECK(calls == 1);
+}
+
+TEST_CASE("retryAsync retries a 503 on the timer queue", "[retry]") {
+    TimerQueue timers;
+    Outcome outcome;
+    std::atomic<int> calls{0};
+    auto caller = std::this_thread::get_id();
+    std::atomic<bool> retriedOnCaller{false};
+    retryAsync<int>("test", [&](AsyncCompletion<int> done) {
+        if (++calls > 1 && std::this_thread::get_id() == caller) retriedOnCaller = true;
+        if (calls < 3) {
+            done(std::make_exception_ptr(HttpError(503, "overloaded")), 0);
+            return;
+        }
+        done(nullptr, 7);
+    }, outcome.completion(), quickPolicy(3), timers);
+
+    // The backoff is a timer entry: the caller is already free.
+    REQUIRE(outcome.wait());
+    CHECK_FALSE(outcome.error);
+    CHECK(outcome.value == 7);
+    CHECK(calls == 3);
+    CHECK_FALSE(retriedOnCaller);
+}
+
+TEST_CASE("retryAsync does not retry client errors or throws", "[retry]") {
+    TimerQueue timers;
+    Outcome outcome;
+    std::atomic<int> calls{0};
+    retryAsync<int>("test", [&](AsyncCompletion<int>) -> void {
+        calls++;
+        throw HttpError(400, "bad request");
+    }, outcome.completion(), quickPolicy(3), timers);
+
+    REQUIRE(outcome.wait());
+    REQUIRE(outcome.error);
+    CHECK_THROWS_WITH(std::rethrow_exception(outcome.error), "test: HTTP error 400: bad request");
+    CHECK(calls == 1);
+}
+
+TEST_CASE("retryAsync gives up after maxRetries with the prefixed error", "[retry]") {
+    TimerQueue timers;
+    Outcome outcome;
+    std::atomic<int> calls{0};
+    retryAsync<int>("test", [&](AsyncCompletion<int> done) {
+        calls++;
+        done(std::make_exception_ptr(HttpError(503, "overloaded")), 0);
+    }, outcome.completion(), quickPolicy(2), timers);
+
+    REQUIRE(outcome.wait());
+    REQUIRE(outcome.error);
+    CHECK_THROWS_AS(std::rethrow_exception(outcome.error), std::runtime_error);
+    CHECK(calls == 2);
+}
+
+TEST_CASE("an async result keeps the memory resource it was built with", "[retry]") {
+    TimerQueue timers;
+    std::pmr::monotonic_buffer_resource arena;
+    std::promise<std::pmr::memory_resource*> delivered;
+    std::atomic<int> calls{0};
+    using Items = std::pmr::vector<int>;
+
+    // The first try fails, so the value also travels through a retry on
+    // the timer thread before reaching `done`.
+    retryAsync<Items>("test", [&](AsyncCompletion<Items> done) {
+        if (++calls == 1) return done(std::make_exception_ptr(HttpError(503, "overloaded")), Items{});
+        completeFrom(done, [&] {
+            Items items(&arena);
+            items.assign({1, 2, 3});
+            return items;
+        });
+    }, [&](std::exception_ptr error, Items items) {
+        delivered.set_value(error ? nullptr : items.get_allocator().resource());
+    }, quickPolicy(3), timers);
+
+    auto resource = delivered.get_future();
+    REQUIRE(resource.wait_for(2s) == std::future_status::ready);
+    CHECK(resource.get() == &arena);
+}
+
+TEST_CASE("completeFrom reports what produce throws, not what done throws", "[retry]") {
+    int failures = 0;
+    AsyncCompletion<int> done = [&](std::exception_ptr error, int) {
+        if (error) {
+            ++failures;
+            return;
+        }
+        throw std::logic_error("from done");
+    };
+    completeFrom(done, []() -> int { throw HttpError(500, "boom"); });
+    CHECK(failures == 1);
+    CHECK_THROWS_AS(completeFrom(done, [] { return 1; }), std::logic_error);
+    CHECK(failures == 1);
+}
@@ -0,0 +1,55 @@
+#include <catch2/catch_test_macros.hpp>
+#include "retry_budget.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("the budget starts full and drains one token per retry", "[retry_budget]") {
+    RetryBudget budget("budget-drain", RetryBudget::Config{0.1, 3});
+    CHECK(budget.tokens() == 3);
+    CHECK(budget.tryRetry());
+    CHECK(budget.tryRetry());
+    CHECK(budget.tryRetry());
+    CHECK_FALSE(budget.tryRetry());
+    CHECK(budget.tokens() == 0);
+}
+
+TEST_CASE("retries are held to a tenth of the traffic", "[retry_budget]") {
+    RetryBudget budget("budget-ratio", RetryBudget::Config{0.1, 1});
+    REQUIRE(budget.tryRetry()); // spend the initial balance
+
+    // A full outage: every call fails and wants a retry.
+    int retries = 0;
+    for (int i = 0; i < 1000; ++i) {
+        budget.recordRequest();
+        if (budget.tryRetry()) retries++;
+    }
+    CHECK(retries == 100);
+}
+
+TEST_CASE("deposits stop at capacity", "[retry_budget]") {
+    RetryBudget budget("budget-cap", RetryBudget::Config{0.5, 2});
+    for (int i = 0; i < 100; ++i) budget.recordRequest();
+    CHECK(budget.tokens() == 2);
+}
+
+TEST_CASE("concurrent retries never overspend", "[retry_budget]") {
+    RetryBudget budget("budget-race", RetryBudget::Config{0.1, 50});
+    std::atomic<int> granted{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 100; ++i) {
+                if (budget.tryRetry()) granted++;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    CHECK(granted == 50);
+    CHECK(budget.tokens() == 0);
+}
+
+TEST_CASE("forService hands out one budget per service", "[retry_budget]") {
+    CHECK(&RetryBudget::forService("budget-a") == &RetryBudget::forService("budget-a"));
+    CHECK(&RetryBudget::forService("budget-a") != &RetryBudget::forService("budget-b"));
+}
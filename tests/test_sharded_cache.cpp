@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sharded_cache.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Manually advanced clock so TTL behaviour is tested without sleeping.
+struct FakeClock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<FakeClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() { return time_point(duration(nowMs.load())); }
+    static void advance(duration d) { nowMs += d.count(); }
+
+    static inline std::atomic<rep> nowMs{0};
+};
+
+// Every entry costs exactly one "byte", so budgets read as entry counts.
+size_t unitSize(const std::string&, const std::string&) { return 1; }
+
+} // namespace
+
+TEST_CASE("returns cached values and counts hits and misses", "[sharded_cache]") {
+    ShardedCache<std::string, std::string> cache(1 << 20);
+
+    CHECK_FALSE(cache.get("DEL").has_value());
+    cache.put("Delhi", "DEL");
+    auto hit = cache.get("Delhi");
+    REQUIRE(hit.has_value());
+    CHECK(*hit == "DEL");
+
+    auto stats = cache.stats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+    CHECK(stats.entries == 1);
+}
+
+TEST_CASE("overwriting a key replaces its value", "[sharded_cache]") {
+    ShardedCache<std::string, std::string> cache(1 << 20);
+    cache.put("Delhi", "XXX");
+    cache.put("Delhi", "DEL");
+    CHECK(*cache.get("Delhi") == "DEL");
+    CHECK(cache.stats().entries == 1);
+}
+
+TEST_CASE("evicts least recently used entries beyond the byte budget", "[sharded_cache]") {
+    ShardedCache<std::string, std::string> cache(3, decltype(cache)::noExpiry, 1, unitSize);
+
+    cache.put("a", "1");
+    cache.put("b", "2");
+    cache.put("c", "3");
+    REQUIRE(cache.get("a").has_value()); // "b" is now the coldest entry
+    cache.put("d", "4");
+
+    CHECK_FALSE(cache.get("b").has_value());
+    CHECK(cache.get("a").has_value());
+    CHECK(cache.get("c").has_value());
+    CHECK(cache.get("d").has_value());
+    CHECK(cache.stats().evictions == 1);
+    CHECK(cache.stats().bytes == 3);
+}
+
+TEST_CASE("entries expire after their TTL", "[sharded_cache]") {
+    using Cache = ShardedCache<std::string, std::string, std::hash<std::string>, FakeClock>;
+    Cache cache(1 << 20, std::chrono::minutes(30));
+
+    cache.put("Goa|3", "sunny");
+    cache.put("Pune|3", "rain", std::chrono::minutes(1));
+
+    FakeClock::advance(std::chrono::minutes(2));
+    CHECK(cache.get("Goa|3").has_value());
+    CHECK_FALSE(cache.get("Pune|3").has_value());
+
+    FakeClock::advance(std::chrono::minutes(30));
+    CHECK_FALSE(cache.get("Goa|3").has_value());
+
+    auto stats = cache.stats();
+    CHECK(stats.expirations == 2);
+    CHECK(stats.entries == 0);
+}
+
+TEST_CASE("clear and erase drop entries", "[sharded_cache]") {
+    ShardedCache<std::string, std::string> cache(1 << 20);
+    cache.put("a", "1");
+    cache.put("b", "2");
+    CHECK(cache.erase("a"));
+    CHECK_FALSE(cache.erase("a"));
+    cache.clear();
+    CHECK(cache.stats().entries == 0);
+    CHECK(cache.stats().bytes == 0);
+}
+
+TEST_CASE("concurrent readers and writers stay within budget", "[sharded_cache]") {
+    ShardedCache<int, int> cache(64 * 100, decltype(cache)::noExpiry, 8,
+                                 [](const int&, const int&) -> size_t { return 64; });
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, t] {
+            for (int i = 0; i < 5000; ++i) {
+                int key = (i * 7 + t) % 500;
+                if (!cache.get(key)) cache.put(key, key * 2);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    auto stats = cache.stats();
+    CHECK(stats.bytes <= 64 * 100);
+    CHECK(stats.hits + stats.misses == 4 * 5000);
+    for (int key = 0; key < 500; ++key) {
+        if (auto value = cache.get(key)) CHECK(*value == key * 2);
+    }
+}
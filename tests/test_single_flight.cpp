@@ -0,0 +1,162 @@
+#include <catch2/catch_test_macros.hpp>
+#include "single_flight.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("concurrent callers for one key share a single call", "[single_flight]") {
+    SingleFlight<std::string, int> flights;
+    std::atomic<int> upstreamCalls{0};
+
+    std::vector<std::thread> callers;
+    std::vector<int> results(8, 0);
+    for (int i = 0; i < 8; ++i) {
+        callers.emplace_back([&, i] {
+            results[i] = flights.run("delhi|goa", [&] {
+                upstreamCalls++;
+                // Held open until every other caller has joined.
+                while (flights.coalesced() < 7) std::this_thread::yield();
+                return 42;
+            });
+        });
+    }
+    for (auto& t : callers) t.join();
+
+    CHECK(upstreamCalls == 1);
+    CHECK(flights.coalesced() == 7);
+    for (int r : results) CHECK(r == 42);
+}
+
+TEST_CASE("different keys do not coalesce", "[single_flight]") {
+    SingleFlight<std::string, std::string> flights;
+    CHECK(flights.run("a", [] { return std::string("A"); }) == "A");
+    CHECK(flights.run("b", [] { return std::string("B"); }) == "B");
+    CHECK(flights.coalesced() == 0);
+}
+
+TEST_CASE("a completed call is not cached", "[single_flight]") {
+    SingleFlight<std::string, int> flights;
+    int calls = 0;
+    flights.run("k", [&] { return ++calls; });
+    flights.run("k", [&] { return ++calls; });
+    CHECK(calls == 2);
+}
+
+TEST_CASE("waiters receive the leader's exception", "[single_flight]") {
+    SingleFlight<std::string, int> flights;
+    std::atomic<int> failures{0};
+
+    std::vector<std::thread> callers;
+    for (int i = 0; i < 4; ++i) {
+        callers.emplace_back([&] {
+            try {
+                flights.run("k", [&]() -> int {
+                    while (flights.coalesced() < 3) std::this_thread::yield();
+                    throw std::runtime_error("HTTP error 503: overloaded");
+                });
+            } catch (const std::runtime_error&) {
+                failures++;
+            }
+        });
+    }
+    for (auto& t : callers) t.join();
+    CHECK(failures == 4);
+
+    // The failure is not remembered either.
+    CHECK(flights.run("k", [] { return 1; }) == 1);
+}
+
+TEST_CASE("async callers join a call without blocking", "[single_flight]") {
+    SingleFlight<std::string, int> flights;
+    int starts = 0;
+    SingleFlight<std::string, int>::Callback finishLeader;
+    std::vector<int> results;
+    auto record = [&](std::exception_ptr error, int value) {
+        CHECK_FALSE(error);
+        results.push_back(value);
+    };
+
+    // The leader's work is held open; every runAsync returns immediately.
+    for (int i = 0; i < 3; ++i) {
+        flights.runAsync("k", [&](SingleFlight<std::string, int>::Callback finish) {
+            starts++;
+            finishLeader = std::move(finish);
+        }, record);
+    }
+    CHECK(starts == 1);
+    CHECK(results.empty());
+    CHECK(flights.coalesced() == 2);
+
+    finishLeader(nullptr, 9);
+    CHECK(results == std::vector<int>{9, 9, 9});
+
+    // Settled calls are forgotten, so the next caller starts afresh.
+    flights.runAsync("k", [&](SingleFlight<std::string, int>::Callback finish) {
+        starts++;
+        finish(nullptr, 1);
+    }, record);
+    CHECK(starts == 2);
+}
+
+TEST_CASE("a blocking caller joins an async call", "[single_flight]") {
+    SingleFlight<std::string, int> flights;
+    SingleFlight<std::string, int>::Callback finishLeader;
+    flights.runAsync("k", [&](SingleFlight<std::string, int>::Callback finish) {
+        finishLeader = std::move(finish);
+    }, [](std::exception_ptr, int) {});
+
+    std::thread waiter([&] {
+        CHECK_THROWS_AS(flights.run("k", []() -> int { return 0; }), std::runtime_error);
+    });
+    while (flights.coalesced() == 0) std::this_thread::yield();
+    finishLeader(std::make_exception_ptr(std::runtime_error("HTTP error 503: overloaded")), 0);
+    waiter.join();
+}
+
+TEST_CASE("an async call settles once, whatever its callbacks do", "[single_flight]") {
+    using Flights = SingleFlight<std::string, int>;
+    Flights flights;
+    std::vector<int> results;
+
+    SECTION("done throwing propagates without settling again") {
+        auto throwingDone = [&](std::exception_ptr, int value) {
+            results.push_back(value);
+            throw std::logic_error("from done");
+        };
+        CHECK_THROWS_AS(flights.runAsync("k", [](Flights::Callback finish) { finish(nullptr, 1); }, throwingDone),
+                        std::logic_error);
+        CHECK(results == std::vector<int>{1});
+    }
+    SECTION("start throwing after it reported propagates") {
+        CHECK_THROWS_AS(flights.runAsync("k", [](Flights::Callback finish) {
+            finish(nullptr, 1);
+            throw std::runtime_error("after reporting");
+        }, [&](std::exception_ptr, int value) { results.push_back(value); }), std::runtime_error);
+        CHECK(results == std::vector<int>{1});
+    }
+    SECTION("a second report doesn't touch a newer call for the key") {
+        Flights::Callback first;
+        flights.runAsync("k", [&](Flights::Callback finish) {
+            first = finish;
+            finish(nullptr, 1);
+        }, [&](std::exception_ptr, int value) { results.push_back(value); });
+
+        Flights::Callback second;
+        flights.runAsync("k", [&](Flights::Callback finish) { second = std::move(finish); },
+                         [&](std::exception_ptr, int value) { results.push_back(value); });
+        first(nullptr, 99);
+        // Still in flight: this one joins instead of starting a call.
+        flights.runAsync("k", [](Flights::Callback) { FAIL("started a second call"); },
+                         [&](std::exception_ptr, int value) { results.push_back(value); });
+        CHECK(flights.coalesced() == 1);
+        second(nullptr, 2);
+        CHECK(results == std::vector<int>{1, 2, 2});
+    }
+
+    // Whatever happened, the key is free again.
+    flights.runAsync("k", [](Flights::Callback finish) { finish(nullptr, 7); },
+                     [&](std::exception_ptr, int value) { results.push_back(value); });
+    CHECK(results.back() == 7);
+}
@@ -0,0 +1,89 @@
+#include <catch2/catch_test_macros.hpp>
+#include "timer_queue.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Collects what the timer thread ran, and lets the test wait for it.
+struct Recorder {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<int> order;
+
+    void add(int value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(value);
+        changed.notify_all();
+    }
+
+    bool waitFor(size_t count, std::chrono::milliseconds timeout = 2s) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, timeout, [&] { return order.size() >= count; });
+    }
+};
+
+} // namespace
+
+TEST_CASE("callbacks run in deadline order, not scheduling order", "[timer_queue]") {
+    TimerQueue timers;
+    Recorder recorder;
+    timers.schedule(60ms, [&] { recorder.add(3); });
+    timers.schedule(20ms, [&] { recorder.add(1); });
+    timers.schedule(40ms, [&] { recorder.add(2); });
+    timers.schedule(20ms, [&] { recorder.add(11); }); // same deadline: FIFO
+
+    REQUIRE(recorder.waitFor(4));
+    CHECK(recorder.order == std::vector<int>{1, 11, 2, 3});
+    CHECK(timers.pending() == 0);
+}
+
+TEST_CASE("a callback does not run before its delay", "[timer_queue]") {
+    TimerQueue timers;
+    Recorder recorder;
+    auto scheduled = TimerQueue::Clock::now();
+    TimerQueue::Clock::time_point ran;
+    timers.schedule(50ms, [&] {
+        ran = TimerQueue::Clock::now();
+        recorder.add(0);
+    });
+    CHECK(timers.pending() == 1);
+
+    REQUIRE(recorder.waitFor(1));
+    CHECK(ran - scheduled >= 50ms);
+}
+
+TEST_CASE("many waits share the one timer thread", "[timer_queue]") {
+    TimerQueue timers;
+    Recorder recorder;
+    // A hundred pending "backoffs" cost heap entries, not threads: all of
+    // them are queued before the first one is due.
+    for (int i = 0; i < 100; ++i) timers.schedule(30ms, [&, i] { recorder.add(i); });
+    CHECK(timers.pending() == 100);
+
+    REQUIRE(recorder.waitFor(100));
+    CHECK(timers.pending() == 0);
+}
+
+TEST_CASE("a throwing callback doesn't stop the queue", "[timer_queue]") {
+    TimerQueue timers;
+    Recorder recorder;
+    timers.schedule(1ms, [] { throw std::runtime_error("boom"); });
+    timers.schedule(5ms, [&] { recorder.add(1); });
+    REQUIRE(recorder.waitFor(1));
+}
+
+TEST_CASE("pending callbacks are dropped at destruction", "[timer_queue]") {
+    bool ran = false;
+    {
+        TimerQueue timers;
+        timers.schedule(10s, [&] { ran = true; });
+    }
+    CHECK_FALSE(ran);
+}
@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+#include "tracing.hpp"
+#include "json.hpp"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Routes the tracer to a scratch file for one test and reads it back.
+struct TraceCapture {
+    std::string path = "test_tracing_spans.jsonl";
+
+    TraceCapture() {
+        std::remove(path.c_str());
+        Tracer::instance().exportTo(path);
+    }
+    ~TraceCapture() {
+        Tracer::instance().exportTo("");
+        std::remove(path.c_str());
+    }
+
+    std::map<std::string, nlohmann::json> spansByName() {
+        Tracer::instance().flush();
+        std::map<std::string, nlohmann::json> spans;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            auto span = nlohmann::json::parse(line);
+            spans[span["name"].get<std::string>()] = span;
+        }
+        return spans;
+    }
+};
+
+} // namespace
+
+TEST_CASE("nested spans share a trace and link to their parent", "[tracing]") {
+    TraceCapture capture;
+    {
+        Span route("GET /flights");
+        route.set("city", "goa");
+        Span child("APIHandler::searchFlights");
+        CHECK(Tracer::current().spanId == child.context().spanId);
+    }
+    CHECK_FALSE(Tracer::current());
+
+    auto spans = capture.spansByName();
+    REQUIRE(spans.size() == 2);
+    auto& route = spans["GET /flights"];
+    auto& child = spans["APIHandler::searchFlights"];
+    CHECK(route["parent_id"].is_null());
+    CHECK(child["trace_id"] == route["trace_id"]);
+    CHECK(child["parent_id"] == route["span_id"]);
+    CHECK(route["attributes"]["city"] == "goa");
+}
+
+TEST_CASE("a captured context carries the trace to another thread", "[tracing]") {
+    TraceCapture capture;
+    {
+        Span parent("AmadeusFlightProvider::search");
+        SpanContext trace = parent.context();
+        std::thread([trace] {
+            ScopedSpanContext adopt(trace);
+            Span lookup("APIHandler::getIATACode");
+        }).join();
+    }
+
+    auto spans = capture.spansByName();
+    CHECK(spans["APIHandler::getIATACode"]["parent_id"] == spans["AmadeusFlightProvider::search"]["span_id"]);
+    CHECK(spans["APIHandler::getIATACode"]["trace_id"] == spans["AmadeusFlightProvider::search"]["trace_id"]);
+}
+
+TEST_CASE("a span left by an exception is marked as an error", "[tracing]") {
+    TraceCapture capture;
+    try {
+        Span failing("APIHandler::searchHotels");
+        throw std::runtime_error("HTTP error 503: overloaded");
+    } catch (const std::runtime_error&) {
+    }
+    auto spans = capture.spansByName();
+    CHECK(spans["APIHandler::searchHotels"]["error"] == true);
+}
+
+TEST_CASE("an async span lasts until the callback ends it", "[tracing]") {
+    TraceCapture capture;
+    {
+        Span route("POST /hotels");
+        auto search = std::make_shared<AsyncSpan>("APIHandler::searchHotels");
+        // Not the thread's current span: siblings started here aren't its children.
+        CHECK(Tracer::current().spanId == route.context().spanId);
+        std::thread([search] {
+            {
+                ScopedSpanContext adopt(search->context());
+                Span call("http.request");
+            }
+            search->end();
+        }).join();
+    }
+    {
+        std::make_shared<AsyncSpan>("APIHandler::generateItinerary"); // dropped unended
+    }
+
+    auto spans = capture.spansByName();
+    auto& route = spans["POST /hotels"];
+    auto& search = spans["APIHandler::searchHotels"];
+    auto& call = spans["http.request"];
+    CHECK(search["parent_id"] == route["span_id"]);
+    CHECK(call["parent_id"] == search["span_id"]);
+    CHECK(search["duration_us"].get<int64_t>() >= call["duration_us"].get<int64_t>());
+    CHECK_FALSE(search.contains("error"));
+    CHECK(spans["APIHandler::generateItinerary"]["error"] == true);
+}
+
+TEST_CASE("spans are inert while tracing is off", "[tracing]") {
+    Tracer::instance().exportTo("");
+    Span span("GET /weather");
+    CHECK_FALSE(span.context());
+    CHECK_FALSE(Tracer::current());
+}
@@ -0,0 +1,46 @@
+#include <catch2/catch_test_macros.hpp>
+#include "upstream_error.hpp"
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("HTTP errors keep their message shape and classify by status", "[upstream_error]") {
+    HttpError overloaded(503, "try later", 2000ms);
+    CHECK(std::string(overloaded.what()) == "HTTP error 503: try later");
+    CHECK(overloaded.status() == 503);
+    CHECK(overloaded.body() == "try later");
+    CHECK(overloaded.retryAfter() == 2000ms);
+
+    for (int status : {408, 429, 502, 503, 504}) CHECK(HttpError(status, "").retryable());
+    for (int status : {400, 401, 403, 404, 500, 501}) CHECK_FALSE(HttpError(status, "").retryable());
+    CHECK_FALSE(HttpError(404, "").retryAfter());
+}
+
+TEST_CASE("transport errors are retryable unless local", "[upstream_error]") {
+    TransportError timeout(TransportError::Kind::Timeout, "Timeout was reached");
+    CHECK(std::string(timeout.what()) == "Curl failed: Timeout was reached");
+    CHECK(timeout.retryable());
+    CHECK(TransportError(TransportError::Kind::Connection, "").retryable());
+    CHECK_FALSE(TransportError(TransportError::Kind::Other, "").retryable());
+
+    // Both are runtime_errors to code that doesn't care about the kind.
+    CHECK_THROWS_AS(throw timeout, std::runtime_error);
+}
+
+TEST_CASE("Retry-After accepts seconds and IMF-fixdate", "[upstream_error]") {
+    // 2015-10-21 07:28:00 UTC
+    auto now = std::chrono::system_clock::time_point(std::chrono::seconds(1445412480));
+
+    CHECK(parseRetryAfter("120", now) == 120s);
+    CHECK(parseRetryAfter(" 0\r\n", now) == 0s);
+    CHECK(parseRetryAfter("Wed, 21 Oct 2015 07:28:30 GMT", now) == 30s);
+    CHECK(parseRetryAfter("Thu, 22 Oct 2015 07:28:00 GMT\r\n", now) == 24h);
+    CHECK(parseRetryAfter("Wed, 21 Oct 2015 07:00:00 GMT", now) == 0s); // already past
+
+    CHECK_FALSE(parseRetryAfter("", now));
+    CHECK_FALSE(parseRetryAfter("-5", now));
+    CHECK_FALSE(parseRetryAfter("1.5", now));
+    CHECK_FALSE(parseRetryAfter("soon", now));
+    CHECK_FALSE(parseRetryAfter("Wed, 21 Foo 2015 07:28:30 GMT", now));
+    CHECK_FALSE(parseRetryAfter("Wednesday, 21-Oct-15 07:28:30 GMT", now)); // obsolete RFC 850 form
+}